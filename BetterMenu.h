@@ -33,23 +33,22 @@ struct menu_text_t {
     uint8_t storage;
 };
 
-static inline menu_text_t menu_text(char const *text) {
-    menu_text_t t;
-    t.ptr = text;
-    t.storage = MENU_TEXT_RAM;
-    return t;
+static inline constexpr menu_text_t menu_text(char const *text) {
+    return menu_text_t{ text, MENU_TEXT_RAM };
 }
 
-static inline menu_text_t menu_text(menu_text_t text) {
+static inline constexpr menu_text_t menu_text(menu_text_t text) {
     return text;
 }
 
+/* Text kept in a PROGMEM array; unlike F() this is a constant expression. */
+static inline constexpr menu_text_t menu_flash_text(char const *text) {
+    return menu_text_t{ text, MENU_TEXT_FLASH };
+}
+
 #ifdef ARDUINO
-static inline menu_text_t menu_text(__FlashStringHelper const *text) {
-    menu_text_t t;
-    t.ptr = text;
-    t.storage = MENU_TEXT_FLASH;
-    return t;
+static inline constexpr menu_text_t menu_text(__FlashStringHelper const *text) {
+    return menu_text_t{ static_cast<void const *>(text), MENU_TEXT_FLASH };
 }
 #endif
 
@@ -73,6 +72,86 @@ static inline char menu_text_char_at(menu_text_t text, uint8_t idx) {
 #define MENU_MAX_LINE 64
 #endif
 
+/* 1 moves render()'s line and value buffers from the stack into the runtime. */
+#ifndef MENU_RENDER_ARENA
+#define MENU_RENDER_ARENA 0
+#endif
+
+/* Feature switches. Each one set to 0 compiles a subsystem out of the engine; the matching
+   setters, factories and decorators disappear with it, so a sketch that still uses one fails
+   to build instead of silently losing behavior. MENU_PROFILE_MINIMAL turns every switch off
+   unless the sketch defines it. */
+#if defined(MENU_PROFILE_MINIMAL) && MENU_PROFILE_MINIMAL
+#define MENU_FEATURE_DEFAULT 0
+#else
+#define MENU_FEATURE_DEFAULT 1
+#endif
+
+/* input_fptr_t callbacks and the prompt text passed to them. */
+#ifndef MENU_FEATURE_LEGACY_INPUT
+#define MENU_FEATURE_LEGACY_INPUT MENU_FEATURE_DEFAULT
+#endif
+
+/* The context-free clear/write_line/flush pointers in display_t. */
+#ifndef MENU_FEATURE_LEGACY_DISPLAY
+#define MENU_FEATURE_LEGACY_DISPLAY MENU_FEATURE_DEFAULT
+#endif
+
+/* set_show_breadcrumbs(). */
+#ifndef MENU_FEATURE_BREADCRUMBS
+#define MENU_FEATURE_BREADCRUMBS MENU_FEATURE_DEFAULT
+#endif
+
+/* Row numbers requested with make()'s use_nums argument. */
+#ifndef MENU_FEATURE_NUMBERING
+#define MENU_FEATURE_NUMBERING MENU_FEATURE_DEFAULT
+#endif
+
+/* ITEM_HIDDEN, ITEM_DISABLED and the hidden/disabled ops slots. */
+#ifndef MENU_FEATURE_VISIBILITY
+#define MENU_FEATURE_VISIBILITY MENU_FEATURE_DEFAULT
+#endif
+
+/* ITEM_FORMAT and the format_value ops slot. */
+#ifndef MENU_FEATURE_FORMAT
+#define MENU_FEATURE_FORMAT MENU_FEATURE_DEFAULT
+#endif
+
+/* Choice_Row and Choice_Delta handling in service(), for touch screens and encoders. */
+#ifndef MENU_FEATURE_POINTER_EVENTS
+#define MENU_FEATURE_POINTER_EVENTS MENU_FEATURE_DEFAULT
+#endif
+
+/* 1 places the generated menu ops tables in flash on AVR; see Flash-resident Trees. */
+#ifndef MENU_PROGMEM_OPS
+#define MENU_PROGMEM_OPS 0
+#endif
+
+/* 1 keeps only (selected, top) per open level and re-derives menus from the root on pop. */
+#ifndef MENU_COMPACT_STACK
+#define MENU_COMPACT_STACK 0
+#endif
+
+/* 1 rejects, at compile time, a tree with more menu levels than the runtime's cursor stack. */
+#ifndef MENU_DEPTH_CHECK
+#define MENU_DEPTH_CHECK 1
+#endif
+
+/* Menus with at least this many items answer every ops slot through one shared item walker;
+   smaller ones get a walker per slot. See Item Dispatch. */
+#ifndef MENU_SHARED_DISPATCH_ITEMS
+#define MENU_SHARED_DISPATCH_ITEMS 32
+#endif
+
+/* Entries an open ITEM_LIST shows per page, and the buffer its label callback writes into. */
+#ifndef MENU_LIST_PAGE
+#define MENU_LIST_PAGE 32
+#endif
+
+#ifndef MENU_LIST_LABEL
+#define MENU_LIST_LABEL 24
+#endif
+
 #if MENU_MAX_STACK < 1
 #error "MENU_MAX_STACK must be at least 1"
 #endif
@@ -89,6 +168,14 @@ static inline char menu_text_char_at(menu_text_t text, uint8_t idx) {
 #error "MENU_MAX_LINE must be 255 or less"
 #endif
 
+#if MENU_LIST_PAGE < 1 || MENU_LIST_PAGE > 253
+#error "MENU_LIST_PAGE must be between 1 and 253"
+#endif
+
+#if MENU_LIST_LABEL < 2 || MENU_LIST_LABEL > 255
+#error "MENU_LIST_LABEL must be between 2 and 255"
+#endif
+
 #define BETTER_MENU_VERSION_MAJOR 0
 #define BETTER_MENU_VERSION_MINOR 5
 #define BETTER_MENU_VERSION_PATCH 5
@@ -260,7 +347,8 @@ enum menu_render_flags_t {
     MENU_RENDER_HAS_CHILD      = 1 << 3,
     MENU_RENDER_BACK_AVAILABLE = 1 << 4,
     MENU_RENDER_SCROLL_UP      = 1 << 5,
-    MENU_RENDER_SCROLL_DOWN    = 1 << 6
+    MENU_RENDER_SCROLL_DOWN    = 1 << 6,
+    MENU_RENDER_MODIFIED       = 1 << 7
 };
 
 struct menu_render_line_t {
@@ -288,22 +376,27 @@ struct display_ops_t {
 struct display_t {
     uint8_t                     width;   /* 0 => MENU_MAX_LINE buffer limit */
     uint8_t                     height;  /* 0 => all rendered items */
+#if MENU_FEATURE_LEGACY_DISPLAY
     display_clear_fptr_t        clear;
     display_write_line_fptr_t   write_line;
     display_flush_fptr_t        flush;
+#endif
     void                       *ctx;
     display_ops_t const        *ops;
 
     display_t() :
         width(0),
         height(0),
+#if MENU_FEATURE_LEGACY_DISPLAY
         clear(0),
         write_line(0),
         flush(0),
+#endif
         ctx(0),
         ops(0) {
     }
 
+#if MENU_FEATURE_LEGACY_DISPLAY
     display_t(uint8_t w, uint8_t h,
               display_clear_fptr_t clear_cb,
               display_write_line_fptr_t write_line_cb,
@@ -316,17 +409,21 @@ struct display_t {
         ctx(0),
         ops(0) {
     }
+#endif
 
     display_t(uint8_t w, uint8_t h, void *context, display_ops_t const *operations) :
         width(w),
         height(h),
+#if MENU_FEATURE_LEGACY_DISPLAY
         clear(0),
         write_line(0),
         flush(0),
+#endif
         ctx(context),
         ops(operations) {
     }
 
+#if MENU_FEATURE_LEGACY_DISPLAY
     display_t(uint8_t w, uint8_t h,
               display_clear_fptr_t clear_cb,
               display_write_line_fptr_t write_line_cb,
@@ -341,19 +438,41 @@ struct display_t {
         ctx(context),
         ops(operations) {
     }
+#endif
 };
 
+#if MENU_FEATURE_LEGACY_DISPLAY
 static inline display_t make_callback_display(uint8_t width, uint8_t height,
                                                display_clear_fptr_t clear,
                                                display_write_line_fptr_t write_line,
                                                display_flush_fptr_t flush) {
     return display_t(width, height, clear, write_line, flush);
 }
+#endif
 
 static inline display_t make_display(uint8_t width, uint8_t height, void *ctx, display_ops_t const *ops) {
     return display_t(width, height, ctx, ops);
 }
 
+/* Base for a display type given to basic_menu_runtime_t directly instead of through display_t.
+   The runtime calls these members by name, so a derived type hides the ones it implements and
+   the rest compile to nothing. render_line() defaults to the derived type's write_line(). */
+template<typename Derived>
+struct menu_display_base {
+    uint8_t width;   /* 0 => MENU_MAX_LINE buffer limit */
+    uint8_t height;  /* 0 => all rendered items */
+
+    menu_display_base() : width(0), height(0) { }
+    menu_display_base(uint8_t w, uint8_t h) : width(w), height(h) { }
+
+    inline void clear(void) { }
+    inline void write_line(uint8_t, char const *) { }
+    inline void flush(void) { }
+    inline void render_line(menu_render_line_t const &line) {
+        static_cast<Derived *>(this)->write_line(line.row, line.text);
+    }
+};
+
 /* --------------------- Built-in Print/Serial adapter --------------------- */
 #ifdef ARDUINO
 struct print_display_ctx_t {
@@ -423,6 +542,30 @@ struct select_choice_t { menu_text_t label; int value; };
 /* Generic integer-like value; set == 0 makes it read-only. */
 struct item_value_t { menu_text_t label; menu_get_int_ctx_fptr_t get; menu_set_int_ctx_fptr_t set; void *ctx; int minv; int maxv; int step; };
 
+typedef uint16_t (*menu_list_count_ctx_fptr_t)(void *ctx);
+typedef void     (*menu_list_label_ctx_fptr_t)(void *ctx, uint16_t index, char *out, uint8_t cap);
+typedef void     (*menu_list_select_ctx_fptr_t)(void *ctx, uint16_t index);
+
+enum { MENU_LIST_NONE = 0xFFFF };
+
+/* Caller-owned state behind an ITEM_LIST. Entries are fetched through the callbacks one
+   visible row at a time, so a list of thousands costs this struct and nothing more. */
+struct menu_list_t {
+    menu_list_count_ctx_fptr_t  count;
+    menu_list_label_ctx_fptr_t  label_at;
+    menu_list_select_ctx_fptr_t select;   /* may be 0; chosen is updated either way */
+    void       *ctx;
+    menu_text_t title;                    /* the ITEM_LIST label, set when the list opens */
+    uint16_t    first;                    /* entry shown in the first row of the page */
+    uint16_t    chosen;                   /* last entry selected, or MENU_LIST_NONE */
+    char        label[MENU_LIST_LABEL];   /* the row label written most recently */
+    menu_list_t(menu_list_count_ctx_fptr_t n, menu_list_label_ctx_fptr_t l, menu_list_select_ctx_fptr_t s, void *c)
+        : count(n), label_at(l), select(s), ctx(c), title(menu_text("")), first(0), chosen(MENU_LIST_NONE) { label[0] = '\0'; }
+};
+
+/* LIST item: opens a page of entries served by a menu_list_t */
+struct item_list_t { menu_text_t label; menu_list_t *list; };
+
 struct menu_condition_t {
     menu_predicate_ctx_fptr_t fn;
     void *ctx;
@@ -433,7 +576,7 @@ struct item_meta_t {
     Item item;
     menu_condition_t hidden;
     menu_condition_t disabled;
-    item_meta_t(Item const &i, menu_condition_t h, menu_condition_t d) : item(i), hidden(h), disabled(d) { }
+    constexpr item_meta_t(Item const &i, menu_condition_t h, menu_condition_t d) : item(i), hidden(h), disabled(d) { }
 };
 
 template<typename Item>
@@ -441,7 +584,7 @@ struct item_format_t {
     Item item;
     menu_format_ctx_fptr_t fn;
     void *ctx;
-    item_format_t(Item const &i, menu_format_ctx_fptr_t f, void *c) : item(i), fn(f), ctx(c) { }
+    constexpr item_format_t(Item const &i, menu_format_ctx_fptr_t f, void *c) : item(i), fn(f), ctx(c) { }
 };
 
 template<typename Item>
@@ -449,7 +592,15 @@ struct item_change_t {
     Item item;
     menu_on_change_ctx_fptr_t fn;
     void *ctx;
-    item_change_t(Item const &i, menu_on_change_ctx_fptr_t f, void *c) : item(i), fn(f), ctx(c) { }
+    constexpr item_change_t(Item const &i, menu_on_change_ctx_fptr_t f, void *c) : item(i), fn(f), ctx(c) { }
+};
+
+/* Declared factory default. INT/VALUE items use the integer, BOOL/SELECT items use the choice position. */
+template<typename Item>
+struct item_default_t {
+    Item item;
+    int value;
+    constexpr item_default_t(Item const &i, int v) : item(i), value(v) { }
 };
 
 struct menu_persistence_t {
@@ -461,6 +612,14 @@ struct menu_persistence_t {
         load(load_cb), save(save_cb), ctx(context) { }
 };
 
+/* Caller-owned defaults table indexed by item id (see Tree Walking). */
+struct menu_defaults_t {
+    int     *values;
+    uint16_t count;
+    menu_defaults_t() : values(0), count(0) { }
+    menu_defaults_t(int *table, uint16_t entries) : values(table), count(entries) { }
+};
+
 /* Forward: inline menu type below */
 template<typename... Items> struct menu_t;
 template<typename... Choices> struct item_select_t;
@@ -472,23 +631,42 @@ struct item_menu_t { menu_text_t label; ChildMenu child; };
 /* ========================== Minimal tuple-less pack ====================== */
 
 struct pack_nil { };
-template<typename Head, typename Tail> struct pack_node { Head head; Tail tail; pack_node():head(),tail(){} pack_node(Head const &h, Tail const &t):head(h),tail(t){} };
+template<typename Head, typename Tail> struct pack_node { Head head; Tail tail; constexpr pack_node():head(),tail(){} constexpr pack_node(Head const &h, Tail const &t):head(h),tail(t){} };
 
 template<typename... Items> struct pack;
-template<> struct pack<> { typedef pack_nil type; static inline type make(){ return type(); } };
+template<> struct pack<> { typedef pack_nil type; static inline constexpr type make(){ return type(); } };
 template<typename First, typename... Rest>
 struct pack<First, Rest...> {
     typedef pack_node<First, typename pack<Rest...>::type> type;
-    static inline type make(First const &f, Rest const &... r) { return type(f, pack<Rest...>::make(r...)); }
+    static inline constexpr type make(First const &f, Rest const &... r) { return type(f, pack<Rest...>::make(r...)); }
 };
 
-/* SELECT item: cycles through fixed choices stored inline by value */
+/* How a select's values are laid out, worked out when it is declared. Contiguous values
+   (first, first + 1, ...) map to a position by subtraction; strictly ascending ones by binary
+   search. Any other order falls back to a scan. */
+enum { MENU_CHOICES_ASCENDING = 1 << 0, MENU_CHOICES_CONTIGUOUS = 1 << 1 };
+
+static inline constexpr uint8_t menu_choice_lookup(int, uint8_t lookup) { return lookup; }
+template<typename... Rest>
+static inline constexpr uint8_t menu_choice_lookup(int prev, uint8_t lookup, select_choice_t const &c, Rest const &... rest) {
+    return menu_choice_lookup(c.value, static_cast<uint8_t>(lookup &
+        ((c.value > prev ? MENU_CHOICES_ASCENDING : 0) | (c.value > prev && c.value - 1 == prev ? MENU_CHOICES_CONTIGUOUS : 0))), rest...);
+}
+static inline constexpr uint8_t menu_choice_lookup() { return 0; }
+template<typename... Rest>
+static inline constexpr uint8_t menu_choice_lookup(select_choice_t const &first, Rest const &... rest) {
+    return menu_choice_lookup(first.value, static_cast<uint8_t>(MENU_CHOICES_ASCENDING | MENU_CHOICES_CONTIGUOUS), rest...);
+}
+
+/* SELECT item: cycles through fixed choices stored inline by value, in one flat array */
 template<typename... Choices>
 struct item_select_t {
     menu_text_t label;
     int *ptr;
-    typename pack<Choices...>::type choices;
-    item_select_t(menu_text_t l, int *p, Choices const &... cs) : label(l), ptr(p), choices(pack<Choices...>::make(cs...)) { }
+    uint8_t lookup;
+    select_choice_t choices[sizeof...(Choices) ? sizeof...(Choices) : 1];
+    constexpr item_select_t() : label(), ptr(0), lookup(0), choices() { }
+    constexpr item_select_t(menu_text_t l, int *p, Choices const &... cs) : label(l), ptr(p), lookup(menu_choice_lookup(cs...)), choices{ cs... } { }
     static_assert(sizeof...(Choices) <= 255, "BetterMenu supports at most 255 choices per select item");
     static inline uint8_t count() { return static_cast<uint8_t>(sizeof...(Choices)); }
 };
@@ -499,166 +677,178 @@ template<typename... Items>
 struct menu_t {
     menu_text_t title;
     typename pack<Items...>::type items;
-    menu_t(menu_text_t t, Items const &... its) : title(t), items(pack<Items...>::make(its...)) { }
+    constexpr menu_t(menu_text_t t, Items const &... its) : title(t), items(pack<Items...>::make(its...)) { }
     static_assert(sizeof...(Items) <= 255, "BetterMenu supports at most 255 items per menu");
+    typedef typename pack<Items...>::type items_t;
+    static constexpr uint8_t items_count = static_cast<uint8_t>(sizeof...(Items));
     static inline uint8_t count() { return static_cast<uint8_t>(sizeof...(Items)); }
 };
 
 /* Factory + sugar */
-template<typename... Items> static inline menu_t<Items...> menu_make(menu_text_t title, Items const &... items) { return menu_t<Items...>(title, items...); }
-template<typename... Items> static inline menu_t<Items...> menu_make(char const *title, Items const &... items) { return menu_t<Items...>(menu_text(title), items...); }
+template<typename... Items> static inline constexpr menu_t<Items...> menu_make(menu_text_t title, Items const &... items) { return menu_t<Items...>(title, items...); }
+template<typename... Items> static inline constexpr menu_t<Items...> menu_make(char const *title, Items const &... items) { return menu_t<Items...>(menu_text(title), items...); }
 #ifdef ARDUINO
-template<typename... Items> static inline menu_t<Items...> menu_make(__FlashStringHelper const *title, Items const &... items) { return menu_t<Items...>(menu_text(title), items...); }
+template<typename... Items> static inline constexpr menu_t<Items...> menu_make(__FlashStringHelper const *title, Items const &... items) { return menu_t<Items...>(menu_text(title), items...); }
 #endif
 
-static inline item_int_t make_item_int(menu_text_t label, int *ptr, int minv, int maxv, int step) {
-    item_int_t item = { label, ptr, minv, maxv, step };
-    return item;
+static inline constexpr item_int_t make_item_int(menu_text_t label, int *ptr, int minv, int maxv, int step) {
+    return item_int_t{ label, ptr, minv, maxv, step };
 }
-static inline item_int_t make_item_int(menu_text_t label, int *ptr, int minv, int maxv) {
+static inline constexpr item_int_t make_item_int(menu_text_t label, int *ptr, int minv, int maxv) {
     return make_item_int(label, ptr, minv, maxv, 1);
 }
-static inline item_int_t make_item_int(char const *label, int *ptr, int minv, int maxv) {
+static inline constexpr item_int_t make_item_int(char const *label, int *ptr, int minv, int maxv) {
     return make_item_int(menu_text(label), ptr, minv, maxv);
 }
-static inline item_int_t make_item_int(char const *label, int *ptr, int minv, int maxv, int step) {
+static inline constexpr item_int_t make_item_int(char const *label, int *ptr, int minv, int maxv, int step) {
     return make_item_int(menu_text(label), ptr, minv, maxv, step);
 }
 #ifdef ARDUINO
-static inline item_int_t make_item_int(__FlashStringHelper const *label, int *ptr, int minv, int maxv) {
+static inline constexpr item_int_t make_item_int(__FlashStringHelper const *label, int *ptr, int minv, int maxv) {
     return make_item_int(menu_text(label), ptr, minv, maxv);
 }
-static inline item_int_t make_item_int(__FlashStringHelper const *label, int *ptr, int minv, int maxv, int step) {
+static inline constexpr item_int_t make_item_int(__FlashStringHelper const *label, int *ptr, int minv, int maxv, int step) {
     return make_item_int(menu_text(label), ptr, minv, maxv, step);
 }
 #endif
 
-static inline item_bool_t make_item_bool(menu_text_t label, bool *ptr, menu_text_t false_label, menu_text_t true_label) {
-    item_bool_t item = { label, ptr, false_label, true_label };
-    return item;
+#ifdef ARDUINO
+static const char menu_bool_off_label[] PROGMEM = "Off";
+static const char menu_bool_on_label[] PROGMEM = "On";
+#endif
+
+static inline constexpr item_bool_t make_item_bool(menu_text_t label, bool *ptr, menu_text_t false_label, menu_text_t true_label) {
+    return item_bool_t{ label, ptr, false_label, true_label };
 }
 template<typename Label>
-static inline item_bool_t make_item_bool(Label label, bool *ptr) {
+static inline constexpr item_bool_t make_item_bool(Label label, bool *ptr) {
 #ifdef ARDUINO
-    return make_item_bool(menu_text(label), ptr, menu_text(F("Off")), menu_text(F("On")));
+    return make_item_bool(menu_text(label), ptr, menu_flash_text(menu_bool_off_label), menu_flash_text(menu_bool_on_label));
 #else
     return make_item_bool(menu_text(label), ptr, menu_text("Off"), menu_text("On"));
 #endif
 }
 template<typename Label, typename FalseLabel, typename TrueLabel>
-static inline item_bool_t make_item_bool(Label label, bool *ptr, FalseLabel false_label, TrueLabel true_label) {
+static inline constexpr item_bool_t make_item_bool(Label label, bool *ptr, FalseLabel false_label, TrueLabel true_label) {
     return make_item_bool(menu_text(label), ptr, menu_text(false_label), menu_text(true_label));
 }
 
-static inline item_func_t make_item_func(menu_text_t label, void (*fn)()) {
-    item_func_t item = { label, fn };
-    return item;
+static inline constexpr item_func_t make_item_func(menu_text_t label, void (*fn)()) {
+    return item_func_t{ label, fn };
 }
-static inline item_func_t make_item_func(char const *label, void (*fn)()) {
+static inline constexpr item_func_t make_item_func(char const *label, void (*fn)()) {
     return make_item_func(menu_text(label), fn);
 }
 #ifdef ARDUINO
-static inline item_func_t make_item_func(__FlashStringHelper const *label, void (*fn)()) {
+static inline constexpr item_func_t make_item_func(__FlashStringHelper const *label, void (*fn)()) {
     return make_item_func(menu_text(label), fn);
 }
 #endif
 
-static inline item_func_ctx_t make_item_func_ctx(menu_text_t label, menu_func_ctx_fptr_t fn, void *ctx) {
-    item_func_ctx_t item = { label, fn, ctx };
-    return item;
+static inline constexpr item_func_ctx_t make_item_func_ctx(menu_text_t label, menu_func_ctx_fptr_t fn, void *ctx) {
+    return item_func_ctx_t{ label, fn, ctx };
 }
-static inline item_func_ctx_t make_item_func_ctx(char const *label, menu_func_ctx_fptr_t fn, void *ctx) {
+static inline constexpr item_func_ctx_t make_item_func_ctx(char const *label, menu_func_ctx_fptr_t fn, void *ctx) {
     return make_item_func_ctx(menu_text(label), fn, ctx);
 }
 #ifdef ARDUINO
-static inline item_func_ctx_t make_item_func_ctx(__FlashStringHelper const *label, menu_func_ctx_fptr_t fn, void *ctx) {
+static inline constexpr item_func_ctx_t make_item_func_ctx(__FlashStringHelper const *label, menu_func_ctx_fptr_t fn, void *ctx) {
     return make_item_func_ctx(menu_text(label), fn, ctx);
 }
 #endif
 
 template<typename ChildMenu>
-static inline item_menu_t<ChildMenu> make_item_menu(menu_text_t label, ChildMenu const &child) {
-    item_menu_t<ChildMenu> item = { label, child };
-    return item;
+static inline constexpr item_menu_t<ChildMenu> make_item_menu(menu_text_t label, ChildMenu const &child) {
+    return item_menu_t<ChildMenu>{ label, child };
 }
 template<typename ChildMenu>
-static inline item_menu_t<ChildMenu> make_item_menu(char const *label, ChildMenu const &child) {
+static inline constexpr item_menu_t<ChildMenu> make_item_menu(char const *label, ChildMenu const &child) {
     return make_item_menu(menu_text(label), child);
 }
 #ifdef ARDUINO
 template<typename ChildMenu>
-static inline item_menu_t<ChildMenu> make_item_menu(__FlashStringHelper const *label, ChildMenu const &child) {
+static inline constexpr item_menu_t<ChildMenu> make_item_menu(__FlashStringHelper const *label, ChildMenu const &child) {
     return make_item_menu(menu_text(label), child);
 }
 #endif
 
-static inline select_choice_t menu_choice(menu_text_t label, int value) {
-    select_choice_t choice = { label, value };
-    return choice;
+static inline constexpr select_choice_t menu_choice(menu_text_t label, int value) {
+    return select_choice_t{ label, value };
 }
 template<typename Label>
-static inline select_choice_t menu_choice(Label label, int value) {
+static inline constexpr select_choice_t menu_choice(Label label, int value) {
     return menu_choice(menu_text(label), value);
 }
 
 template<typename... Choices>
-static inline item_select_t<Choices...> make_item_select(menu_text_t label, int *ptr, Choices const &... choices) {
+static inline constexpr item_select_t<Choices...> make_item_select(menu_text_t label, int *ptr, Choices const &... choices) {
     return item_select_t<Choices...>(label, ptr, choices...);
 }
 template<typename Label, typename... Choices>
-static inline item_select_t<Choices...> make_item_select(Label label, int *ptr, Choices const &... choices) {
+static inline constexpr item_select_t<Choices...> make_item_select(Label label, int *ptr, Choices const &... choices) {
     return make_item_select(menu_text(label), ptr, choices...);
 }
 
-static inline item_value_t make_item_value(menu_text_t label, menu_get_int_ctx_fptr_t get, void *ctx) {
-    item_value_t item = { label, get, 0, ctx, 0, 0, 1 };
-    return item;
+static inline constexpr item_value_t make_item_value(menu_text_t label, menu_get_int_ctx_fptr_t get, void *ctx) {
+    return item_value_t{ label, get, 0, ctx, 0, 0, 1 };
 }
 template<typename Label>
-static inline item_value_t make_item_value(Label label, menu_get_int_ctx_fptr_t get, void *ctx) {
+static inline constexpr item_value_t make_item_value(Label label, menu_get_int_ctx_fptr_t get, void *ctx) {
     return make_item_value(menu_text(label), get, ctx);
 }
 
-static inline item_value_t make_item_value(menu_text_t label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv, int step) {
-    item_value_t item = { label, get, set, ctx, minv, maxv, step };
-    return item;
+static inline constexpr item_value_t make_item_value(menu_text_t label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv, int step) {
+    return item_value_t{ label, get, set, ctx, minv, maxv, step };
 }
-static inline item_value_t make_item_value(menu_text_t label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv) {
+static inline constexpr item_value_t make_item_value(menu_text_t label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv) {
     return make_item_value(label, get, set, ctx, minv, maxv, 1);
 }
 template<typename Label>
-static inline item_value_t make_item_value(Label label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv, int step) {
+static inline constexpr item_value_t make_item_value(Label label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv, int step) {
     return make_item_value(menu_text(label), get, set, ctx, minv, maxv, step);
 }
 template<typename Label>
-static inline item_value_t make_item_value(Label label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv) {
+static inline constexpr item_value_t make_item_value(Label label, menu_get_int_ctx_fptr_t get, menu_set_int_ctx_fptr_t set, void *ctx, int minv, int maxv) {
     return make_item_value(menu_text(label), get, set, ctx, minv, maxv, 1);
 }
 
+static inline constexpr item_list_t make_item_list(menu_text_t label, menu_list_t *list) {
+    return item_list_t{ label, list };
+}
+template<typename Label>
+static inline constexpr item_list_t make_item_list(Label label, menu_list_t *list) {
+    return make_item_list(menu_text(label), list);
+}
+
+#if MENU_FEATURE_VISIBILITY
 template<typename Item>
-static inline item_meta_t<Item> menu_item_hidden(Item const &item, menu_predicate_ctx_fptr_t fn, void *ctx) {
-    menu_condition_t hidden = { fn, ctx };
-    menu_condition_t disabled = { 0, 0 };
-    return item_meta_t<Item>(item, hidden, disabled);
+static inline constexpr item_meta_t<Item> menu_item_hidden(Item const &item, menu_predicate_ctx_fptr_t fn, void *ctx) {
+    return item_meta_t<Item>(item, menu_condition_t{ fn, ctx }, menu_condition_t{ 0, 0 });
 }
 
 template<typename Item>
-static inline item_meta_t<Item> menu_item_disabled(Item const &item, menu_predicate_ctx_fptr_t fn, void *ctx) {
-    menu_condition_t hidden = { 0, 0 };
-    menu_condition_t disabled = { fn, ctx };
-    return item_meta_t<Item>(item, hidden, disabled);
+static inline constexpr item_meta_t<Item> menu_item_disabled(Item const &item, menu_predicate_ctx_fptr_t fn, void *ctx) {
+    return item_meta_t<Item>(item, menu_condition_t{ 0, 0 }, menu_condition_t{ fn, ctx });
 }
+#endif
 
+#if MENU_FEATURE_FORMAT
 template<typename Item>
-static inline item_format_t<Item> menu_item_format(Item const &item, menu_format_ctx_fptr_t fn, void *ctx) {
+static inline constexpr item_format_t<Item> menu_item_format(Item const &item, menu_format_ctx_fptr_t fn, void *ctx) {
     return item_format_t<Item>(item, fn, ctx);
 }
+#endif
 
 template<typename Item>
-static inline item_change_t<Item> menu_item_on_change(Item const &item, menu_on_change_ctx_fptr_t fn, void *ctx) {
+static inline constexpr item_change_t<Item> menu_item_on_change(Item const &item, menu_on_change_ctx_fptr_t fn, void *ctx) {
     return item_change_t<Item>(item, fn, ctx);
 }
 
+template<typename Item>
+static inline constexpr item_default_t<Item> menu_item_default(Item const &item, int value) {
+    return item_default_t<Item>(item, value);
+}
+
 #define MENU(/*title, items...*/...) (menu_make(__VA_ARGS__))
 #define ITEM_INT(/*label, ptr, minv, maxv, optional step*/...) make_item_int(__VA_ARGS__)
 #define ITEM_INT_STEP(label, ptr, minv, maxv, step) make_item_int((label), (ptr), (minv), (maxv), (step))
@@ -669,10 +859,16 @@ static inline item_change_t<Item> menu_item_on_change(Item const &item, menu_on_
 #define ITEM_SELECT(/*label, ptr, choices...*/...) make_item_select(__VA_ARGS__)
 #define MENU_CHOICE(label, value)        menu_choice((label), (value))
 #define ITEM_VALUE(/*label, getter, ctx, optional setter/min/max/step*/...) make_item_value(__VA_ARGS__)
+#define ITEM_LIST(label, list)           make_item_list((label), (list))
+#if MENU_FEATURE_VISIBILITY
 #define ITEM_HIDDEN(item, fn, ctx)       menu_item_hidden((item), (fn), (ctx))
 #define ITEM_DISABLED(item, fn, ctx)     menu_item_disabled((item), (fn), (ctx))
+#endif
+#if MENU_FEATURE_FORMAT
 #define ITEM_FORMAT(item, fn, ctx)       menu_item_format((item), (fn), (ctx))
+#endif
 #define ITEM_ON_CHANGE(item, fn, ctx)    menu_item_on_change((item), (fn), (ctx))
+#define ITEM_DEFAULT(item, value)        menu_item_default((item), (value))
 
 /* =========================== Runtime type erasure ======================== */
 
@@ -694,56 +890,184 @@ struct menu_ops_t {
     menu_text_t  (*value_label_at)(void const *, uint8_t idx, uint8_t value_idx);
     uint8_t      (*value_selected)(void const *, uint8_t idx);
     void         (*value_select)(void const *, uint8_t idx, uint8_t value_idx);
+#if MENU_FEATURE_VISIBILITY
     bool         (*hidden)(void const *, uint8_t idx);
     bool         (*disabled)(void const *, uint8_t idx);
+#endif
+#if MENU_FEATURE_FORMAT
     bool         (*format_value)(void const *, uint8_t idx, char *out, uint8_t cap);
+#endif
     void         (*on_change)(void const *, uint8_t idx);
+    bool         (*default_at)(void const *, uint8_t idx, int *out);
+};
+
+/* Every call through a menu_ops_t reads its slot with menu_ops_fn(), so with MENU_PROGMEM_OPS
+   the tables can live in flash and cost no SRAM. Hand-written tables must then be PROGMEM too. */
+#if MENU_PROGMEM_OPS && defined(ARDUINO) && defined(__AVR__)
+#define MENU_OPS_STORAGE PROGMEM
+template<typename Fn>
+static inline Fn menu_ops_fn(Fn const *slot) {
+    return reinterpret_cast<Fn>(reinterpret_cast<uintptr_t>(pgm_read_ptr(slot)));
+}
+#else
+#define MENU_OPS_STORAGE
+template<typename Fn>
+static inline Fn menu_ops_fn(Fn const *slot) { return *slot; }
+#endif
+
+/* =============================== List Pages ============================== */
+
+/*
+ * An open ITEM_LIST is one menu level showing entries first .. first + MENU_LIST_PAGE - 1 as
+ * FUNC rows, after a "previous page" row when first > 0 and before a "next page" row when more
+ * entries follow. Activating a page row moves first by a page; activating an entry stores its
+ * index in chosen and calls select. The runtime and every adapter see an ordinary menu, and
+ * only the rows they render or list reach label_at.
+ */
+#ifdef ARDUINO
+static const char menu_list_prev_label[] PROGMEM = "<< Prev";
+static const char menu_list_next_label[] PROGMEM = "Next >>";
+#endif
+
+static inline menu_list_t *menu_list_of(void const *mptr) { return static_cast<menu_list_t *>(const_cast<void *>(mptr)); }
+
+/* Rows of the current page. Clamps first when the list shrank below it. */
+struct menu_list_page_t { uint8_t prev; uint8_t entries; uint8_t next; };
+static menu_list_page_t menu_list_page(menu_list_t *list) {
+    menu_list_page_t page = { 0, 0, 0 };
+    uint16_t const total = list->count ? list->count(list->ctx) : 0;
+    if (list->first >= total) { list->first = total ? static_cast<uint16_t>((total - 1) / MENU_LIST_PAGE * MENU_LIST_PAGE) : 0; }
+    uint16_t const left = static_cast<uint16_t>(total - list->first);
+    page.prev = list->first > 0 ? 1 : 0;
+    page.entries = static_cast<uint8_t>(left > MENU_LIST_PAGE ? MENU_LIST_PAGE : left);
+    page.next = left > MENU_LIST_PAGE ? 1 : 0;
+    return page;
+}
+
+/* The list rows' ops. A class-template static gives the table one address program-wide: the tree
+   walks tell list children apart by that address, and a header-level static would give each
+   translation unit its own copy. */
+template<typename Unused = void>
+struct menu_list_rows {
+    static uint8_t count(void const *mptr) {
+        menu_list_page_t const page = menu_list_page(menu_list_of(mptr));
+        return static_cast<uint8_t>(page.prev + page.entries + page.next);
+    }
+
+    static menu_text_t title(void const *mptr) { return menu_list_of(mptr)->title; }
+
+    static menu_text_t label_at(void const *mptr, uint8_t idx) {
+        menu_list_t *const list = menu_list_of(mptr);
+        menu_list_page_t const page = menu_list_page(list);
+        if (page.prev && idx == 0) {
+#ifdef ARDUINO
+            return menu_flash_text(menu_list_prev_label);
+#else
+            return menu_text("<< Prev");
+#endif
+        }
+        uint8_t const entry = static_cast<uint8_t>(idx - page.prev);
+        if (entry >= page.entries) {
+#ifdef ARDUINO
+            return menu_flash_text(menu_list_next_label);
+#else
+            return menu_text("Next >>");
+#endif
+        }
+        list->label[0] = '\0';
+        if (list->label_at) { list->label_at(list->ctx, static_cast<uint16_t>(list->first + entry), list->label, MENU_LIST_LABEL); }
+        list->label[MENU_LIST_LABEL - 1] = '\0';
+        return menu_text(list->label);
+    }
+
+    static void call(void const *mptr, uint8_t idx) {
+        menu_list_t *const list = menu_list_of(mptr);
+        menu_list_page_t const page = menu_list_page(list);
+        if (page.prev && idx == 0) {
+            list->first = static_cast<uint16_t>(list->first > MENU_LIST_PAGE ? list->first - MENU_LIST_PAGE : 0);
+            return;
+        }
+        uint8_t const entry = static_cast<uint8_t>(idx - page.prev);
+        if (entry >= page.entries) {
+            if (page.next) { list->first = static_cast<uint16_t>(list->first + MENU_LIST_PAGE); }
+            return;
+        }
+        list->chosen = static_cast<uint16_t>(list->first + entry);
+        if (list->select) { list->select(list->ctx, list->chosen); }
+    }
+
+    static menu_ops_t const ops;
+};
+
+/* Slots a list row has no use for stay empty; the runtime treats them as plain FUNC rows. */
+template<typename Unused>
+menu_ops_t const menu_list_rows<Unused>::ops MENU_OPS_STORAGE = {
+    &menu_list_rows<Unused>::count, &menu_list_rows<Unused>::label_at, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    &menu_list_rows<Unused>::call, &menu_list_rows<Unused>::title, 0, 0, 0, 0,
+#if MENU_FEATURE_VISIBILITY
+    0, 0,
+#endif
+#if MENU_FEATURE_FORMAT
+    0,
+#endif
+    0, 0
 };
 
+/* True for the menu an ITEM_LIST row opens. */
+static inline bool menu_ops_is_list(menu_ops_t const *ops) { return ops == &menu_list_rows<>::ops; }
+
 /* Item trait helpers */
 static inline menu_text_t item_label(item_int_t const &i)  { return i.label; }
 static inline menu_text_t item_label(item_bool_t const &b) { return b.label; }
 static inline menu_text_t item_label(item_func_t const &f) { return f.label; }
 static inline menu_text_t item_label(item_func_ctx_t const &f) { return f.label; }
 static inline menu_text_t item_label(item_value_t const &v) { return v.label; }
+static inline menu_text_t item_label(item_list_t const &l) { return l.label; }
 template<typename CM> static inline menu_text_t item_label(item_menu_t<CM> const &m) { return m.label; }
 template<typename... Choices> static inline menu_text_t item_label(item_select_t<Choices...> const &s) { return s.label; }
 template<typename Item> static inline menu_text_t item_label(item_meta_t<Item> const &m) { return item_label(m.item); }
 template<typename Item> static inline menu_text_t item_label(item_format_t<Item> const &m) { return item_label(m.item); }
 template<typename Item> static inline menu_text_t item_label(item_change_t<Item> const &m) { return item_label(m.item); }
+template<typename Item> static inline menu_text_t item_label(item_default_t<Item> const &m) { return item_label(m.item); }
 
 static inline entry_t item_type(item_int_t const &)  { return ENTRY_INT; }
 static inline entry_t item_type(item_bool_t const &) { return ENTRY_BOOL; }
 static inline entry_t item_type(item_func_t const &) { return ENTRY_FUNC; }
 static inline entry_t item_type(item_func_ctx_t const &) { return ENTRY_FUNC; }
 static inline entry_t item_type(item_value_t const &) { return ENTRY_VALUE; }
+static inline entry_t item_type(item_list_t const &) { return ENTRY_MENU; }
 template<typename CM> static inline entry_t item_type(item_menu_t<CM> const &) { return ENTRY_MENU; }
 template<typename... Choices> static inline entry_t item_type(item_select_t<Choices...> const &) { return ENTRY_SELECT; }
 template<typename Item> static inline entry_t item_type(item_meta_t<Item> const &m) { return item_type(m.item); }
 template<typename Item> static inline entry_t item_type(item_format_t<Item> const &m) { return item_type(m.item); }
 template<typename Item> static inline entry_t item_type(item_change_t<Item> const &m) { return item_type(m.item); }
+template<typename Item> static inline entry_t item_type(item_default_t<Item> const &m) { return item_type(m.item); }
 
 static inline bool item_int_has(item_int_t const &i)  { return i.ptr != 0; }
 static inline bool item_int_has(item_bool_t const &) { return false; }
 static inline bool item_int_has(item_func_t const &) { return false; }
 static inline bool item_int_has(item_func_ctx_t const &) { return false; }
 static inline bool item_int_has(item_value_t const &v) { return v.get != 0 && v.set != 0; }
+static inline bool item_int_has(item_list_t const &) { return false; }
 template<typename CM> static inline bool item_int_has(item_menu_t<CM> const &) { return false; }
 template<typename... Choices> static inline bool item_int_has(item_select_t<Choices...> const &) { return false; }
 template<typename Item> static inline bool item_int_has(item_meta_t<Item> const &m) { return item_int_has(m.item); }
 template<typename Item> static inline bool item_int_has(item_format_t<Item> const &m) { return item_int_has(m.item); }
 template<typename Item> static inline bool item_int_has(item_change_t<Item> const &m) { return item_int_has(m.item); }
+template<typename Item> static inline bool item_int_has(item_default_t<Item> const &m) { return item_int_has(m.item); }
 
 static inline bool item_scalar_has(item_int_t const &i)  { return i.ptr != 0; }
 static inline bool item_scalar_has(item_bool_t const &) { return false; }
 static inline bool item_scalar_has(item_func_t const &) { return false; }
 static inline bool item_scalar_has(item_func_ctx_t const &) { return false; }
 static inline bool item_scalar_has(item_value_t const &v) { return v.get != 0; }
+static inline bool item_scalar_has(item_list_t const &) { return false; }
 template<typename CM> static inline bool item_scalar_has(item_menu_t<CM> const &) { return false; }
 template<typename... Choices> static inline bool item_scalar_has(item_select_t<Choices...> const &) { return false; }
 template<typename Item> static inline bool item_scalar_has(item_meta_t<Item> const &m) { return item_scalar_has(m.item); }
 template<typename Item> static inline bool item_scalar_has(item_format_t<Item> const &m) { return item_scalar_has(m.item); }
 template<typename Item> static inline bool item_scalar_has(item_change_t<Item> const &m) { return item_scalar_has(m.item); }
+template<typename Item> static inline bool item_scalar_has(item_default_t<Item> const &m) { return item_scalar_has(m.item); }
 
 static inline int  item_int_get(item_int_t const &i) { return i.ptr ? *(i.ptr) : 0; }
 static inline void item_int_set(item_int_t const &i, int v) { if (i.ptr) { *(i.ptr) = v; } }
@@ -775,6 +1099,12 @@ static inline int  item_int_min(item_value_t const &v) { return v.minv; }
 static inline int  item_int_max(item_value_t const &v) { return v.maxv; }
 static inline int  item_int_step(item_value_t const &v) { return v.step; }
 
+static inline int  item_int_get(item_list_t const &) { return 0; }
+static inline void item_int_set(item_list_t const &, int) { }
+static inline int  item_int_min(item_list_t const &) { return 0; }
+static inline int  item_int_max(item_list_t const &) { return 0; }
+static inline int  item_int_step(item_list_t const &) { return 1; }
+
 template<typename CM> static inline int  item_int_get(item_menu_t<CM> const &) { return 0; }
 template<typename CM> static inline void item_int_set(item_menu_t<CM> const &, int)  { }
 template<typename CM> static inline int  item_int_min(item_menu_t<CM> const &) { return 0; }
@@ -798,21 +1128,28 @@ template<typename Item> static inline int  item_int_min(item_format_t<Item> cons
 template<typename Item> static inline int  item_int_max(item_format_t<Item> const &m) { return item_int_max(m.item); }
 template<typename Item> static inline int  item_int_step(item_format_t<Item> const &m) { return item_int_step(m.item); }
 template<typename Item> static inline int  item_int_get(item_change_t<Item> const &m) { return item_int_get(m.item); }
+template<typename Item> static inline int  item_int_get(item_default_t<Item> const &m) { return item_int_get(m.item); }
 template<typename Item> static inline void item_int_set(item_change_t<Item> const &m, int value) { item_int_set(m.item, value); }
+template<typename Item> static inline void item_int_set(item_default_t<Item> const &m, int value) { item_int_set(m.item, value); }
 template<typename Item> static inline int  item_int_min(item_change_t<Item> const &m) { return item_int_min(m.item); }
+template<typename Item> static inline int  item_int_min(item_default_t<Item> const &m) { return item_int_min(m.item); }
 template<typename Item> static inline int  item_int_max(item_change_t<Item> const &m) { return item_int_max(m.item); }
+template<typename Item> static inline int  item_int_max(item_default_t<Item> const &m) { return item_int_max(m.item); }
 template<typename Item> static inline int  item_int_step(item_change_t<Item> const &m) { return item_int_step(m.item); }
+template<typename Item> static inline int  item_int_step(item_default_t<Item> const &m) { return item_int_step(m.item); }
 
 static inline void item_call(item_func_t const &f) { if (f.fn) { f.fn(); } }
 static inline void item_call(item_func_ctx_t const &f) { if (f.fn) { f.fn(f.ctx); } }
 static inline void item_call(item_int_t const &)   { }
 static inline void item_call(item_bool_t const &)  { }
 static inline void item_call(item_value_t const &) { }
+static inline void item_call(item_list_t const &) { }
 template<typename CM> static inline void item_call(item_menu_t<CM> const &) { }
 template<typename... Choices> static inline void item_call(item_select_t<Choices...> const &) { }
 template<typename Item> static inline void item_call(item_meta_t<Item> const &m) { item_call(m.item); }
 template<typename Item> static inline void item_call(item_format_t<Item> const &m) { item_call(m.item); }
 template<typename Item> static inline void item_call(item_change_t<Item> const &m) { item_call(m.item); }
+template<typename Item> static inline void item_call(item_default_t<Item> const &m) { item_call(m.item); }
 
 /* Child discovery */
 template<typename CM> static inline bool item_child(item_menu_t<CM> const &m, void const **out_child, menu_ops_t const **out_ops);
@@ -821,23 +1158,46 @@ static inline bool item_child(item_bool_t const &, void const **, menu_ops_t con
 static inline bool item_child(item_func_t const &, void const **, menu_ops_t const **) { return false; }
 static inline bool item_child(item_func_ctx_t const &, void const **, menu_ops_t const **) { return false; }
 static inline bool item_child(item_value_t const &, void const **, menu_ops_t const **) { return false; }
+static inline bool item_child(item_list_t const &l, void const **out_child, menu_ops_t const **out_ops) {
+    if (!l.list || !out_child || !out_ops) { return false; }
+    l.list->title = l.label;
+    *out_child = static_cast<void const *>(l.list);
+    *out_ops = &menu_list_rows<>::ops;
+    return true;
+}
 template<typename... Choices> static inline bool item_child(item_select_t<Choices...> const &, void const **, menu_ops_t const **) { return false; }
 template<typename Item> static inline bool item_child(item_meta_t<Item> const &m, void const **out_child, menu_ops_t const **out_ops) { return item_child(m.item, out_child, out_ops); }
 template<typename Item> static inline bool item_child(item_format_t<Item> const &m, void const **out_child, menu_ops_t const **out_ops) { return item_child(m.item, out_child, out_ops); }
 template<typename Item> static inline bool item_child(item_change_t<Item> const &m, void const **out_child, menu_ops_t const **out_ops) { return item_child(m.item, out_child, out_ops); }
-
-static inline menu_text_t choice_label_at_pack(pack_nil const &, uint8_t) { return menu_text(""); }
-template<typename Head, typename Tail>
-static inline menu_text_t choice_label_at_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? p.head.label : choice_label_at_pack(p.tail, static_cast<uint8_t>(idx-1)); }
-
-static inline int choice_value_at_pack(pack_nil const &, uint8_t) { return 0; }
-template<typename Head, typename Tail>
-static inline int choice_value_at_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? p.head.value : choice_value_at_pack(p.tail, static_cast<uint8_t>(idx-1)); }
-
-static inline uint8_t choice_index_for_value_pack(pack_nil const &, int, uint8_t) { return 255; }
-template<typename Head, typename Tail>
-static inline uint8_t choice_index_for_value_pack(pack_node<Head, Tail> const &p, int value, uint8_t idx) {
-    return (p.head.value == value) ? idx : choice_index_for_value_pack(p.tail, value, static_cast<uint8_t>(idx + 1));
+template<typename Item> static inline bool item_child(item_default_t<Item> const &m, void const **out_child, menu_ops_t const **out_ops) { return item_child(m.item, out_child, out_ops); }
+
+typedef int (*menu_choice_value_fptr_t)(select_choice_t const *c);
+static inline int menu_choice_value(select_choice_t const *c) { return c->value; }
+
+/* Position of value among a select's choices, or 255. value_of reads one entry, so flash-resident
+   choices are searched without being copied out whole. */
+static inline uint8_t menu_choice_index(select_choice_t const *choices, uint8_t count, uint8_t lookup, int value, menu_choice_value_fptr_t value_of) {
+    if (count == 0) { return 255; }
+    if (lookup & MENU_CHOICES_CONTIGUOUS) {
+        int const first = value_of(choices);
+        if (value < first) { return 255; }
+        unsigned const offset = static_cast<unsigned>(value) - static_cast<unsigned>(first);
+        return offset < count ? static_cast<uint8_t>(offset) : 255;
+    }
+    if (lookup & MENU_CHOICES_ASCENDING) {
+        uint8_t lo = 0, hi = count;
+        while (lo < hi) {
+            uint8_t const mid = static_cast<uint8_t>(lo + (hi - lo) / 2);
+            int const v = value_of(choices + mid);
+            if (v == value) { return mid; }
+            if (v < value) { lo = static_cast<uint8_t>(mid + 1); } else { hi = mid; }
+        }
+        return 255;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        if (value_of(choices + i) == value) { return i; }
+    }
+    return 255;
 }
 
 static inline uint8_t item_value_count(item_int_t const &) { return 0; }
@@ -845,44 +1205,52 @@ static inline uint8_t item_value_count(item_bool_t const &b) { return b.ptr ? 2
 static inline uint8_t item_value_count(item_func_t const &) { return 0; }
 static inline uint8_t item_value_count(item_func_ctx_t const &) { return 0; }
 static inline uint8_t item_value_count(item_value_t const &) { return 0; }
+static inline uint8_t item_value_count(item_list_t const &) { return 0; }
 template<typename CM> static inline uint8_t item_value_count(item_menu_t<CM> const &) { return 0; }
 template<typename... Choices> static inline uint8_t item_value_count(item_select_t<Choices...> const &s) { return s.ptr ? static_cast<uint8_t>(sizeof...(Choices)) : 0; }
 template<typename Item> static inline uint8_t item_value_count(item_meta_t<Item> const &m) { return item_value_count(m.item); }
 template<typename Item> static inline uint8_t item_value_count(item_format_t<Item> const &m) { return item_value_count(m.item); }
 template<typename Item> static inline uint8_t item_value_count(item_change_t<Item> const &m) { return item_value_count(m.item); }
+template<typename Item> static inline uint8_t item_value_count(item_default_t<Item> const &m) { return item_value_count(m.item); }
 
 static inline menu_text_t item_value_label_at(item_int_t const &, uint8_t) { return menu_text(""); }
 static inline menu_text_t item_value_label_at(item_bool_t const &b, uint8_t idx) { return idx ? b.true_label : b.false_label; }
 static inline menu_text_t item_value_label_at(item_func_t const &, uint8_t) { return menu_text(""); }
 static inline menu_text_t item_value_label_at(item_func_ctx_t const &, uint8_t) { return menu_text(""); }
 static inline menu_text_t item_value_label_at(item_value_t const &, uint8_t) { return menu_text(""); }
+static inline menu_text_t item_value_label_at(item_list_t const &, uint8_t) { return menu_text(""); }
 template<typename CM> static inline menu_text_t item_value_label_at(item_menu_t<CM> const &, uint8_t) { return menu_text(""); }
-template<typename... Choices> static inline menu_text_t item_value_label_at(item_select_t<Choices...> const &s, uint8_t idx) { return choice_label_at_pack(s.choices, idx); }
+template<typename... Choices> static inline menu_text_t item_value_label_at(item_select_t<Choices...> const &s, uint8_t idx) { return idx < s.count() ? s.choices[idx].label : menu_text(""); }
 template<typename Item> static inline menu_text_t item_value_label_at(item_meta_t<Item> const &m, uint8_t idx) { return item_value_label_at(m.item, idx); }
 template<typename Item> static inline menu_text_t item_value_label_at(item_format_t<Item> const &m, uint8_t idx) { return item_value_label_at(m.item, idx); }
 template<typename Item> static inline menu_text_t item_value_label_at(item_change_t<Item> const &m, uint8_t idx) { return item_value_label_at(m.item, idx); }
+template<typename Item> static inline menu_text_t item_value_label_at(item_default_t<Item> const &m, uint8_t idx) { return item_value_label_at(m.item, idx); }
 
 static inline uint8_t item_value_selected(item_int_t const &) { return 255; }
 static inline uint8_t item_value_selected(item_bool_t const &b) { return (b.ptr && *b.ptr) ? 1 : 0; }
 static inline uint8_t item_value_selected(item_func_t const &) { return 255; }
 static inline uint8_t item_value_selected(item_func_ctx_t const &) { return 255; }
 static inline uint8_t item_value_selected(item_value_t const &) { return 255; }
+static inline uint8_t item_value_selected(item_list_t const &) { return 255; }
 template<typename CM> static inline uint8_t item_value_selected(item_menu_t<CM> const &) { return 255; }
-template<typename... Choices> static inline uint8_t item_value_selected(item_select_t<Choices...> const &s) { return s.ptr ? choice_index_for_value_pack(s.choices, *s.ptr, 0) : 255; }
+template<typename... Choices> static inline uint8_t item_value_selected(item_select_t<Choices...> const &s) { return s.ptr ? menu_choice_index(s.choices, s.count(), s.lookup, *s.ptr, &menu_choice_value) : 255; }
 template<typename Item> static inline uint8_t item_value_selected(item_meta_t<Item> const &m) { return item_value_selected(m.item); }
 template<typename Item> static inline uint8_t item_value_selected(item_format_t<Item> const &m) { return item_value_selected(m.item); }
 template<typename Item> static inline uint8_t item_value_selected(item_change_t<Item> const &m) { return item_value_selected(m.item); }
+template<typename Item> static inline uint8_t item_value_selected(item_default_t<Item> const &m) { return item_value_selected(m.item); }
 
 static inline void item_value_select(item_int_t const &, uint8_t) { }
 static inline void item_value_select(item_bool_t const &b, uint8_t idx) { if (b.ptr) { *b.ptr = idx != 0; } }
 static inline void item_value_select(item_func_t const &, uint8_t) { }
 static inline void item_value_select(item_func_ctx_t const &, uint8_t) { }
 static inline void item_value_select(item_value_t const &, uint8_t) { }
+static inline void item_value_select(item_list_t const &, uint8_t) { }
 template<typename CM> static inline void item_value_select(item_menu_t<CM> const &, uint8_t) { }
-template<typename... Choices> static inline void item_value_select(item_select_t<Choices...> const &s, uint8_t idx) { if (s.ptr) { *s.ptr = choice_value_at_pack(s.choices, idx); } }
+template<typename... Choices> static inline void item_value_select(item_select_t<Choices...> const &s, uint8_t idx) { if (s.ptr) { *s.ptr = idx < s.count() ? s.choices[idx].value : 0; } }
 template<typename Item> static inline void item_value_select(item_meta_t<Item> const &m, uint8_t idx) { item_value_select(m.item, idx); }
 template<typename Item> static inline void item_value_select(item_format_t<Item> const &m, uint8_t idx) { item_value_select(m.item, idx); }
 template<typename Item> static inline void item_value_select(item_change_t<Item> const &m, uint8_t idx) { item_value_select(m.item, idx); }
+template<typename Item> static inline void item_value_select(item_default_t<Item> const &m, uint8_t idx) { item_value_select(m.item, idx); }
 
 static inline bool menu_condition_matches(menu_condition_t const &condition) {
     return condition.fn ? condition.fn(condition.ctx) : false;
@@ -893,28 +1261,33 @@ static inline bool item_hidden(item_bool_t const &) { return false; }
 static inline bool item_hidden(item_func_t const &) { return false; }
 static inline bool item_hidden(item_func_ctx_t const &) { return false; }
 static inline bool item_hidden(item_value_t const &) { return false; }
+static inline bool item_hidden(item_list_t const &) { return false; }
 template<typename CM> static inline bool item_hidden(item_menu_t<CM> const &) { return false; }
 template<typename... Choices> static inline bool item_hidden(item_select_t<Choices...> const &) { return false; }
 template<typename Item> static inline bool item_hidden(item_meta_t<Item> const &m) { return menu_condition_matches(m.hidden) || item_hidden(m.item); }
 template<typename Item> static inline bool item_hidden(item_format_t<Item> const &m) { return item_hidden(m.item); }
 template<typename Item> static inline bool item_hidden(item_change_t<Item> const &m) { return item_hidden(m.item); }
+template<typename Item> static inline bool item_hidden(item_default_t<Item> const &m) { return item_hidden(m.item); }
 
 static inline bool item_disabled(item_int_t const &) { return false; }
 static inline bool item_disabled(item_bool_t const &) { return false; }
 static inline bool item_disabled(item_func_t const &) { return false; }
 static inline bool item_disabled(item_func_ctx_t const &) { return false; }
 static inline bool item_disabled(item_value_t const &) { return false; }
+static inline bool item_disabled(item_list_t const &) { return false; }
 template<typename CM> static inline bool item_disabled(item_menu_t<CM> const &) { return false; }
 template<typename... Choices> static inline bool item_disabled(item_select_t<Choices...> const &) { return false; }
 template<typename Item> static inline bool item_disabled(item_meta_t<Item> const &m) { return menu_condition_matches(m.disabled) || item_disabled(m.item); }
 template<typename Item> static inline bool item_disabled(item_format_t<Item> const &m) { return item_disabled(m.item); }
 template<typename Item> static inline bool item_disabled(item_change_t<Item> const &m) { return item_disabled(m.item); }
+template<typename Item> static inline bool item_disabled(item_default_t<Item> const &m) { return item_disabled(m.item); }
 
 static inline bool item_format_value(item_int_t const &, char *, uint8_t) { return false; }
 static inline bool item_format_value(item_bool_t const &, char *, uint8_t) { return false; }
 static inline bool item_format_value(item_func_t const &, char *, uint8_t) { return false; }
 static inline bool item_format_value(item_func_ctx_t const &, char *, uint8_t) { return false; }
 static inline bool item_format_value(item_value_t const &, char *, uint8_t) { return false; }
+static inline bool item_format_value(item_list_t const &, char *, uint8_t) { return false; }
 template<typename CM> static inline bool item_format_value(item_menu_t<CM> const &, char *, uint8_t) { return false; }
 template<typename... Choices> static inline bool item_format_value(item_select_t<Choices...> const &, char *, uint8_t) { return false; }
 template<typename Item> static inline bool item_format_value(item_meta_t<Item> const &m, char *out, uint8_t cap) { return item_format_value(m.item, out, cap); }
@@ -928,138 +1301,374 @@ template<typename Item> static inline bool item_format_value(item_format_t<Item>
     return item_format_value(m.item, out, cap);
 }
 template<typename Item> static inline bool item_format_value(item_change_t<Item> const &m, char *out, uint8_t cap) { return item_format_value(m.item, out, cap); }
+template<typename Item> static inline bool item_format_value(item_default_t<Item> const &m, char *out, uint8_t cap) { return item_format_value(m.item, out, cap); }
 
 static inline void item_on_change(item_int_t const &) { }
 static inline void item_on_change(item_bool_t const &) { }
 static inline void item_on_change(item_func_t const &) { }
 static inline void item_on_change(item_func_ctx_t const &) { }
 static inline void item_on_change(item_value_t const &) { }
+static inline void item_on_change(item_list_t const &) { }
 template<typename CM> static inline void item_on_change(item_menu_t<CM> const &) { }
 template<typename... Choices> static inline void item_on_change(item_select_t<Choices...> const &) { }
 template<typename Item> static inline void item_on_change(item_meta_t<Item> const &m) { item_on_change(m.item); }
 template<typename Item> static inline void item_on_change(item_format_t<Item> const &m) { item_on_change(m.item); }
+template<typename Item> static inline void item_on_change(item_default_t<Item> const &m) { item_on_change(m.item); }
 template<typename Item> static inline void item_on_change(item_change_t<Item> const &m) {
     item_on_change(m.item);
     if (m.fn) { m.fn(m.ctx); }
 }
 
-/* pack walkers */
-static inline menu_text_t label_at_pack(pack_nil const &, uint8_t) { return menu_text(""); }
-template<typename Head, typename Tail>
-static inline menu_text_t label_at_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_label(p.head) : label_at_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+static inline bool item_default_value(item_int_t const &, int *) { return false; }
+static inline bool item_default_value(item_bool_t const &, int *) { return false; }
+static inline bool item_default_value(item_func_t const &, int *) { return false; }
+static inline bool item_default_value(item_func_ctx_t const &, int *) { return false; }
+static inline bool item_default_value(item_value_t const &, int *) { return false; }
+static inline bool item_default_value(item_list_t const &, int *) { return false; }
+template<typename CM> static inline bool item_default_value(item_menu_t<CM> const &, int *) { return false; }
+template<typename... Choices> static inline bool item_default_value(item_select_t<Choices...> const &, int *) { return false; }
+template<typename Item> static inline bool item_default_value(item_meta_t<Item> const &m, int *out) { return item_default_value(m.item, out); }
+template<typename Item> static inline bool item_default_value(item_format_t<Item> const &m, int *out) { return item_default_value(m.item, out); }
+template<typename Item> static inline bool item_default_value(item_change_t<Item> const &m, int *out) { return item_default_value(m.item, out); }
+template<typename Item> static inline bool item_default_value(item_default_t<Item> const &m, int *out) {
+    if (out) { *out = m.value; }
+    return true;
+}
 
-static inline entry_t type_at_pack(pack_nil const &, uint8_t) { return ENTRY_FUNC; }
-template<typename Head, typename Tail>
-static inline entry_t type_at_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_type(p.head) : type_at_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+/* ============================= Item Dispatch ============================= */
+/*
+ * Every ops slot asks one op of the item at an index through a menu_item_query_t. A menu with
+ * fewer than MENU_SHARED_DISPATCH_ITEMS items walks its pack once per slot, and each walk
+ * inlines that op for each item, so a small tree keeps only the code its slots reach. A
+ * larger menu shares one walk that finds the item's address and the handler for its type,
+ * and the handler switches on the op. That costs a menu one walker and each item type one
+ * handler rather than one walker per slot, which keeps large single-declaration menus quick
+ * to compile. Access is menu_ram_item for RAM trees and menu_pgm_item for flash-resident ones.
+ */
+enum menu_item_op_t {
+    MENU_ITEM_LABEL,
+    MENU_ITEM_TYPE,
+    MENU_ITEM_INT_HAS,
+    MENU_ITEM_SCALAR_HAS,
+    MENU_ITEM_INT_GET,
+    MENU_ITEM_INT_SET,
+    MENU_ITEM_INT_MIN,
+    MENU_ITEM_INT_MAX,
+    MENU_ITEM_INT_STEP,
+    MENU_ITEM_CHILD,
+    MENU_ITEM_CALL,
+    MENU_ITEM_VALUE_COUNT,
+    MENU_ITEM_VALUE_LABEL_AT,
+    MENU_ITEM_VALUE_SELECTED,
+    MENU_ITEM_VALUE_SELECT,
+    MENU_ITEM_HIDDEN,
+    MENU_ITEM_DISABLED,
+    MENU_ITEM_FORMAT_VALUE,
+    MENU_ITEM_ON_CHANGE,
+    MENU_ITEM_DEFAULT
+};
 
-static inline bool int_has_pack(pack_nil const &, uint8_t) { return false; }
-template<typename Head, typename Tail>
-static inline bool int_has_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_int_has(p.head) : int_has_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+/* One op on one item. value carries the op's input (new value, value index or buffer size) and
+   comes back as its answer; an item that is not found leaves it as passed in. */
+struct menu_item_query_t {
+    uint8_t     op;
+    int         value;
+    void       *a;     /* FORMAT_VALUE buffer, CHILD child, DEFAULT result */
+    void       *b;     /* CHILD child ops */
+    menu_text_t text;  /* LABEL, VALUE_LABEL_AT */
+};
 
-static inline bool scalar_has_pack(pack_nil const &, uint8_t) { return false; }
-template<typename Head, typename Tail>
-static inline bool scalar_has_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_scalar_has(p.head) : scalar_has_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+typedef void (*menu_item_answer_fptr_t)(void const *item, menu_item_query_t &q);
 
-static inline int int_get_pack(pack_nil const &, uint8_t) { return 0; }
-template<typename Head, typename Tail>
-static inline int int_get_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_int_get(p.head) : int_get_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+template<typename Item>
+struct menu_ram_item {
+    static menu_text_t label(Item const *p) { return item_label(*p); }
+    static entry_t     type(Item const *p) { return item_type(*p); }
+    static bool        int_has(Item const *p) { return item_int_has(*p); }
+    static bool        scalar_has(Item const *p) { return item_scalar_has(*p); }
+    static int         int_get(Item const *p) { return item_int_get(*p); }
+    static void        int_set(Item const *p, int v) { item_int_set(*p, v); }
+    static int         int_min(Item const *p) { return item_int_min(*p); }
+    static int         int_max(Item const *p) { return item_int_max(*p); }
+    static int         int_step(Item const *p) { return item_int_step(*p); }
+    static void        call(Item const *p) { item_call(*p); }
+    static bool        child(Item const *p, void const **out_child, menu_ops_t const **out_ops) { return item_child(*p, out_child, out_ops); }
+    static uint8_t     value_count(Item const *p) { return item_value_count(*p); }
+    static menu_text_t value_label_at(Item const *p, uint8_t value_idx) { return item_value_label_at(*p, value_idx); }
+    static uint8_t     value_selected(Item const *p) { return item_value_selected(*p); }
+    static void        value_select(Item const *p, uint8_t value_idx) { item_value_select(*p, value_idx); }
+    static bool        hidden(Item const *p) { return item_hidden(*p); }
+    static bool        disabled(Item const *p) { return item_disabled(*p); }
+    static bool        format_value(Item const *p, char *out, uint8_t cap) { return item_format_value(*p, out, cap); }
+    static void        on_change(Item const *p) { item_on_change(*p); }
+    static bool        default_value(Item const *p, int *out) { return item_default_value(*p, out); }
+};
 
-static inline void int_set_pack(pack_nil const &, uint8_t, int) { }
-template<typename Head, typename Tail>
-static inline void int_set_pack(pack_node<Head, Tail> const &p, uint8_t idx, int v) { if (idx==0) { item_int_set(p.head, v); } else { int_set_pack(p.tail, static_cast<uint8_t>(idx-1), v); } }
+template<typename Item, template<typename> class Access>
+static void menu_item_answer(void const *item, menu_item_query_t &q) {
+    typedef Access<Item> A;
+    Item const *p = static_cast<Item const *>(item);
+    switch (q.op) {
+        case MENU_ITEM_LABEL:          q.text = A::label(p); break;
+        case MENU_ITEM_TYPE:           q.value = A::type(p); break;
+        case MENU_ITEM_INT_HAS:        q.value = A::int_has(p); break;
+        case MENU_ITEM_SCALAR_HAS:     q.value = A::scalar_has(p); break;
+        case MENU_ITEM_INT_GET:        q.value = A::int_get(p); break;
+        case MENU_ITEM_INT_SET:        A::int_set(p, q.value); break;
+        case MENU_ITEM_INT_MIN:        q.value = A::int_min(p); break;
+        case MENU_ITEM_INT_MAX:        q.value = A::int_max(p); break;
+        case MENU_ITEM_INT_STEP:       q.value = A::int_step(p); break;
+        case MENU_ITEM_CHILD:          q.value = A::child(p, static_cast<void const **>(q.a), static_cast<menu_ops_t const **>(q.b)); break;
+        case MENU_ITEM_CALL:           A::call(p); break;
+        case MENU_ITEM_VALUE_COUNT:    q.value = A::value_count(p); break;
+        case MENU_ITEM_VALUE_LABEL_AT: q.text = A::value_label_at(p, static_cast<uint8_t>(q.value)); break;
+        case MENU_ITEM_VALUE_SELECTED: q.value = A::value_selected(p); break;
+        case MENU_ITEM_VALUE_SELECT:   A::value_select(p, static_cast<uint8_t>(q.value)); break;
+#if MENU_FEATURE_VISIBILITY
+        case MENU_ITEM_HIDDEN:         q.value = A::hidden(p); break;
+        case MENU_ITEM_DISABLED:       q.value = A::disabled(p); break;
+#endif
+#if MENU_FEATURE_FORMAT
+        case MENU_ITEM_FORMAT_VALUE:   q.value = A::format_value(p, static_cast<char *>(q.a), static_cast<uint8_t>(q.value)); break;
+#endif
+        case MENU_ITEM_ON_CHANGE:      A::on_change(p); break;
+        case MENU_ITEM_DEFAULT:        q.value = A::default_value(p, static_cast<int *>(q.a)); break;
+        default: break;
+    }
+}
 
-static inline int int_min_pack(pack_nil const &, uint8_t) { return 0; }
-template<typename Head, typename Tail>
-static inline int int_min_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_int_min(p.head) : int_min_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+/* The shared walker: the address of item idx and its handler, or null past the end. */
+template<template<typename> class Access>
+static inline menu_item_answer_fptr_t menu_item_at(pack_nil const *, uint8_t, void const **) { return 0; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline menu_item_answer_fptr_t menu_item_at(pack_node<Head, Tail> const *p, uint8_t idx, void const **out_item) {
+    if (idx != 0) { return menu_item_at<Access>(&p->tail, static_cast<uint8_t>(idx - 1), out_item); }
+    *out_item = static_cast<void const *>(&p->head);
+    return &menu_item_answer<Head, Access>;
+}
 
-static inline int int_max_pack(pack_nil const &, uint8_t) { return 0; }
-template<typename Head, typename Tail>
-static inline int int_max_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_int_max(p.head) : int_max_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+static int menu_item_ask(menu_item_answer_fptr_t fn, void const *item, uint8_t op, int value, void *a = 0, void *b = 0) {
+    menu_item_query_t q = { op, value, a, b, menu_text("") };
+    if (fn) { fn(item, q); }
+    return q.value;
+}
 
-static inline int int_step_pack(pack_nil const &, uint8_t) { return 1; }
-template<typename Head, typename Tail>
-static inline int int_step_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_int_step(p.head) : int_step_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+static menu_text_t menu_item_ask_text(menu_item_answer_fptr_t fn, void const *item, uint8_t op, int value) {
+    menu_item_query_t q = { op, value, 0, 0, menu_text("") };
+    if (fn) { fn(item, q); }
+    return q.text;
+}
 
-static inline void call_func_pack(pack_nil const &, uint8_t) { }
-template<typename Head, typename Tail>
-static inline void call_func_pack(pack_node<Head, Tail> const &p, uint8_t idx) { if (idx==0) { item_call(p.head); } else { call_func_pack(p.tail, static_cast<uint8_t>(idx-1)); } }
+/* Per-slot walkers: each one inlines its op for every item of the menu. */
+template<template<typename> class Access>
+static inline menu_text_t label_at_pack(pack_nil const *, uint8_t) { return menu_text(""); }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline menu_text_t label_at_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::label(&p->head) : label_at_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
 
-static inline bool child_at_pack(pack_nil const &, uint8_t, void const **, menu_ops_t const **) { return false; }
-template<typename Head, typename Tail>
-static inline bool child_at_pack(pack_node<Head, Tail> const &p, uint8_t idx, void const **out_child, menu_ops_t const **out_ops) { return (idx==0) ? item_child(p.head, out_child, out_ops) : child_at_pack(p.tail, static_cast<uint8_t>(idx-1), out_child, out_ops); }
+template<template<typename> class Access>
+static inline entry_t type_at_pack(pack_nil const *, uint8_t) { return ENTRY_FUNC; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline entry_t type_at_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::type(&p->head) : type_at_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
 
-static inline uint8_t value_count_pack(pack_nil const &, uint8_t) { return 0; }
-template<typename Head, typename Tail>
-static inline uint8_t value_count_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_value_count(p.head) : value_count_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+template<template<typename> class Access>
+static inline bool int_has_pack(pack_nil const *, uint8_t) { return false; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline bool int_has_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::int_has(&p->head) : int_has_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
 
-static inline menu_text_t value_label_at_pack(pack_nil const &, uint8_t, uint8_t) { return menu_text(""); }
-template<typename Head, typename Tail>
-static inline menu_text_t value_label_at_pack(pack_node<Head, Tail> const &p, uint8_t idx, uint8_t value_idx) {
-    return (idx==0) ? item_value_label_at(p.head, value_idx) : value_label_at_pack(p.tail, static_cast<uint8_t>(idx-1), value_idx);
+template<template<typename> class Access>
+static inline bool scalar_has_pack(pack_nil const *, uint8_t) { return false; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline bool scalar_has_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::scalar_has(&p->head) : scalar_has_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
 }
 
-static inline uint8_t value_selected_pack(pack_nil const &, uint8_t) { return 255; }
-template<typename Head, typename Tail>
-static inline uint8_t value_selected_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_value_selected(p.head) : value_selected_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+template<template<typename> class Access>
+static inline int int_get_pack(pack_nil const *, uint8_t) { return 0; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline int int_get_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::int_get(&p->head) : int_get_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
 
-static inline void value_select_pack(pack_nil const &, uint8_t, uint8_t) { }
-template<typename Head, typename Tail>
-static inline void value_select_pack(pack_node<Head, Tail> const &p, uint8_t idx, uint8_t value_idx) {
-    if (idx==0) { item_value_select(p.head, value_idx); }
-    else { value_select_pack(p.tail, static_cast<uint8_t>(idx-1), value_idx); }
+template<template<typename> class Access>
+static inline void int_set_pack(pack_nil const *, uint8_t, int) { }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline void int_set_pack(pack_node<Head, Tail> const *p, uint8_t idx, int v) {
+    if (idx == 0) { Access<Head>::int_set(&p->head, v); } else { int_set_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1), v); }
 }
 
-static inline bool hidden_pack(pack_nil const &, uint8_t) { return false; }
-template<typename Head, typename Tail>
-static inline bool hidden_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_hidden(p.head) : hidden_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+template<template<typename> class Access>
+static inline int int_min_pack(pack_nil const *, uint8_t) { return 0; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline int int_min_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::int_min(&p->head) : int_min_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
 
-static inline bool disabled_pack(pack_nil const &, uint8_t) { return false; }
-template<typename Head, typename Tail>
-static inline bool disabled_pack(pack_node<Head, Tail> const &p, uint8_t idx) { return (idx==0) ? item_disabled(p.head) : disabled_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+template<template<typename> class Access>
+static inline int int_max_pack(pack_nil const *, uint8_t) { return 0; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline int int_max_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::int_max(&p->head) : int_max_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
 
-static inline bool format_value_pack(pack_nil const &, uint8_t, char *, uint8_t) { return false; }
-template<typename Head, typename Tail>
-static inline bool format_value_pack(pack_node<Head, Tail> const &p, uint8_t idx, char *out, uint8_t cap) {
-    return (idx==0) ? item_format_value(p.head, out, cap) : format_value_pack(p.tail, static_cast<uint8_t>(idx-1), out, cap);
+template<template<typename> class Access>
+static inline int int_step_pack(pack_nil const *, uint8_t) { return 1; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline int int_step_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::int_step(&p->head) : int_step_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
 }
 
-static inline void on_change_pack(pack_nil const &, uint8_t) { }
-template<typename Head, typename Tail>
-static inline void on_change_pack(pack_node<Head, Tail> const &p, uint8_t idx) {
-    if (idx==0) { item_on_change(p.head); }
-    else { on_change_pack(p.tail, static_cast<uint8_t>(idx-1)); }
+template<template<typename> class Access>
+static inline bool child_at_pack(pack_nil const *, uint8_t, void const **, menu_ops_t const **) { return false; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline bool child_at_pack(pack_node<Head, Tail> const *p, uint8_t idx, void const **out_child, menu_ops_t const **out_ops) {
+    return (idx == 0) ? Access<Head>::child(&p->head, out_child, out_ops) : child_at_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1), out_child, out_ops);
+}
+
+template<template<typename> class Access>
+static inline void call_func_pack(pack_nil const *, uint8_t) { }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline void call_func_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    if (idx == 0) { Access<Head>::call(&p->head); } else { call_func_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1)); }
+}
+
+template<template<typename> class Access>
+static inline uint8_t value_count_pack(pack_nil const *, uint8_t) { return 0; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline uint8_t value_count_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::value_count(&p->head) : value_count_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
+
+template<template<typename> class Access>
+static inline menu_text_t value_label_at_pack(pack_nil const *, uint8_t, uint8_t) { return menu_text(""); }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline menu_text_t value_label_at_pack(pack_node<Head, Tail> const *p, uint8_t idx, uint8_t value_idx) {
+    return (idx == 0) ? Access<Head>::value_label_at(&p->head, value_idx) : value_label_at_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1), value_idx);
+}
+
+template<template<typename> class Access>
+static inline uint8_t value_selected_pack(pack_nil const *, uint8_t) { return 255; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline uint8_t value_selected_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::value_selected(&p->head) : value_selected_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
+
+template<template<typename> class Access>
+static inline void value_select_pack(pack_nil const *, uint8_t, uint8_t) { }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline void value_select_pack(pack_node<Head, Tail> const *p, uint8_t idx, uint8_t value_idx) {
+    if (idx == 0) { Access<Head>::value_select(&p->head, value_idx); } else { value_select_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1), value_idx); }
+}
+
+template<template<typename> class Access>
+static inline bool hidden_pack(pack_nil const *, uint8_t) { return false; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline bool hidden_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::hidden(&p->head) : hidden_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
+
+template<template<typename> class Access>
+static inline bool disabled_pack(pack_nil const *, uint8_t) { return false; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline bool disabled_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    return (idx == 0) ? Access<Head>::disabled(&p->head) : disabled_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1));
+}
+
+template<template<typename> class Access>
+static inline bool format_value_pack(pack_nil const *, uint8_t, char *, uint8_t) { return false; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline bool format_value_pack(pack_node<Head, Tail> const *p, uint8_t idx, char *out, uint8_t cap) {
+    return (idx == 0) ? Access<Head>::format_value(&p->head, out, cap) : format_value_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1), out, cap);
+}
+
+template<template<typename> class Access>
+static inline void on_change_pack(pack_nil const *, uint8_t) { }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline void on_change_pack(pack_node<Head, Tail> const *p, uint8_t idx) {
+    if (idx == 0) { Access<Head>::on_change(&p->head); } else { on_change_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1)); }
+}
+
+template<template<typename> class Access>
+static inline bool default_at_pack(pack_nil const *, uint8_t, int *) { return false; }
+template<template<typename> class Access, typename Head, typename Tail>
+static inline bool default_at_pack(pack_node<Head, Tail> const *p, uint8_t idx, int *out) {
+    return (idx == 0) ? Access<Head>::default_value(&p->head, out) : default_at_pack<Access>(&p->tail, static_cast<uint8_t>(idx - 1), out);
 }
 
+/* The per-item half of an ops table, shared by ops_for and pgm_ops_for. Menus below
+   MENU_SHARED_DISPATCH_ITEMS items walk their pack once per slot. */
+template<typename M, template<typename> class Access, bool Shared = (M::items_count >= MENU_SHARED_DISPATCH_ITEMS)>
+struct menu_item_ops_for {
+    static typename M::items_t const *items(void const *mptr) { return &static_cast<M const *>(mptr)->items; }
+    static menu_text_t _label_at(void const *mptr, uint8_t idx) { return label_at_pack<Access>(items(mptr), idx); }
+    static entry_t    _type_at(void const *mptr, uint8_t idx) { return type_at_pack<Access>(items(mptr), idx); }
+    static bool       _int_has(void const *mptr, uint8_t idx) { return int_has_pack<Access>(items(mptr), idx); }
+    static bool       _scalar_has(void const *mptr, uint8_t idx) { return scalar_has_pack<Access>(items(mptr), idx); }
+    static int        _int_get(void const *mptr, uint8_t idx) { return int_get_pack<Access>(items(mptr), idx); }
+    static void       _int_set(void const *mptr, uint8_t idx, int v) { int_set_pack<Access>(items(mptr), idx, v); }
+    static int        _int_min(void const *mptr, uint8_t idx) { return int_min_pack<Access>(items(mptr), idx); }
+    static int        _int_max(void const *mptr, uint8_t idx) { return int_max_pack<Access>(items(mptr), idx); }
+    static int        _int_step(void const *mptr, uint8_t idx) { return int_step_pack<Access>(items(mptr), idx); }
+    static bool       _child_at(void const *mptr, uint8_t idx, void const **out_child, menu_ops_t const **out_ops) { return child_at_pack<Access>(items(mptr), idx, out_child, out_ops); }
+    static void       _call_func(void const *mptr, uint8_t idx) { call_func_pack<Access>(items(mptr), idx); }
+    static uint8_t    _value_count(void const *mptr, uint8_t idx) { return value_count_pack<Access>(items(mptr), idx); }
+    static menu_text_t _value_label_at(void const *mptr, uint8_t idx, uint8_t value_idx) { return value_label_at_pack<Access>(items(mptr), idx, value_idx); }
+    static uint8_t    _value_selected(void const *mptr, uint8_t idx) { return value_selected_pack<Access>(items(mptr), idx); }
+    static void       _value_select(void const *mptr, uint8_t idx, uint8_t value_idx) { value_select_pack<Access>(items(mptr), idx, value_idx); }
+    static bool       _hidden(void const *mptr, uint8_t idx) { return hidden_pack<Access>(items(mptr), idx); }
+    static bool       _disabled(void const *mptr, uint8_t idx) { return disabled_pack<Access>(items(mptr), idx); }
+    static bool       _format_value(void const *mptr, uint8_t idx, char *out, uint8_t cap) { return format_value_pack<Access>(items(mptr), idx, out, cap); }
+    static void       _on_change(void const *mptr, uint8_t idx) { on_change_pack<Access>(items(mptr), idx); }
+    static bool       _default_at(void const *mptr, uint8_t idx, int *out) { return default_at_pack<Access>(items(mptr), idx, out); }
+};
+
+/* Menus of MENU_SHARED_DISPATCH_ITEMS items or more share menu_item_at across every slot. */
+template<typename M, template<typename> class Access>
+struct menu_item_ops_for<M, Access, true> {
+    static menu_item_answer_fptr_t find(void const *mptr, uint8_t idx, void const **item) {
+        return menu_item_at<Access>(&static_cast<M const *>(mptr)->items, idx, item);
+    }
+    static menu_text_t _label_at(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask_text(fn, it, MENU_ITEM_LABEL, 0); }
+    static entry_t    _type_at(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return static_cast<entry_t>(menu_item_ask(fn, it, MENU_ITEM_TYPE, ENTRY_FUNC)); }
+    static bool       _int_has(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_INT_HAS, 0) != 0; }
+    static bool       _scalar_has(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_SCALAR_HAS, 0) != 0; }
+    static int        _int_get(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_INT_GET, 0); }
+    static void       _int_set(void const *mptr, uint8_t idx, int v) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); menu_item_ask(fn, it, MENU_ITEM_INT_SET, v); }
+    static int        _int_min(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_INT_MIN, 0); }
+    static int        _int_max(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_INT_MAX, 0); }
+    static int        _int_step(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_INT_STEP, 1); }
+    static bool       _child_at(void const *mptr, uint8_t idx, void const **out_child, menu_ops_t const **out_ops) {
+        void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it);
+        return menu_item_ask(fn, it, MENU_ITEM_CHILD, 0, static_cast<void *>(out_child), static_cast<void *>(out_ops)) != 0;
+    }
+    static void       _call_func(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); menu_item_ask(fn, it, MENU_ITEM_CALL, 0); }
+    static uint8_t    _value_count(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return static_cast<uint8_t>(menu_item_ask(fn, it, MENU_ITEM_VALUE_COUNT, 0)); }
+    static menu_text_t _value_label_at(void const *mptr, uint8_t idx, uint8_t value_idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask_text(fn, it, MENU_ITEM_VALUE_LABEL_AT, value_idx); }
+    static uint8_t    _value_selected(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return static_cast<uint8_t>(menu_item_ask(fn, it, MENU_ITEM_VALUE_SELECTED, 255)); }
+    static void       _value_select(void const *mptr, uint8_t idx, uint8_t value_idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); menu_item_ask(fn, it, MENU_ITEM_VALUE_SELECT, value_idx); }
+    static bool       _hidden(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_HIDDEN, 0) != 0; }
+    static bool       _disabled(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_DISABLED, 0) != 0; }
+    static bool       _format_value(void const *mptr, uint8_t idx, char *out, uint8_t cap) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return fn && menu_item_ask(fn, it, MENU_ITEM_FORMAT_VALUE, cap, out) != 0; }
+    static void       _on_change(void const *mptr, uint8_t idx) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); menu_item_ask(fn, it, MENU_ITEM_ON_CHANGE, 0); }
+    static bool       _default_at(void const *mptr, uint8_t idx, int *out) { void const *it = 0; menu_item_answer_fptr_t fn = find(mptr, idx, &it); return menu_item_ask(fn, it, MENU_ITEM_DEFAULT, 0, out) != 0; }
+};
+
 /* ops_for<menu_t<...>> */
 template<typename MenuConcrete> struct ops_for;
 template<typename... Items>
-struct ops_for<menu_t<Items...>> {
+struct ops_for<menu_t<Items...>> : menu_item_ops_for<menu_t<Items...>, menu_ram_item> {
     typedef menu_t<Items...> M;
     static uint8_t    _count(void const *) { return static_cast<uint8_t>(sizeof...(Items)); }
     static menu_text_t _title(void const *mptr) { M const &m = *static_cast<M const *>(mptr); return m.title.ptr ? m.title : menu_text(""); }
-    static menu_text_t _label_at(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return label_at_pack(m.items, idx); }
-    static entry_t    _type_at(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return type_at_pack(m.items, idx); }
-    static bool       _int_has(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return int_has_pack(m.items, idx); }
-    static bool       _scalar_has(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return scalar_has_pack(m.items, idx); }
-    static int        _int_get(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return int_get_pack(m.items, idx); }
-    static void       _int_set(void const *mptr, uint8_t idx, int v){ M const &m = *static_cast<M const *>(mptr); return int_set_pack(m.items, idx, v); }
-    static int        _int_min(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return int_min_pack(m.items, idx); }
-    static int        _int_max(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return int_max_pack(m.items, idx); }
-    static int        _int_step(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return int_step_pack(m.items, idx); }
-    static bool       _child_at(void const *mptr, uint8_t idx, void const **out_child, menu_ops_t const **out_ops) { M const &m = *static_cast<M const *>(mptr); return child_at_pack(m.items, idx, out_child, out_ops); }
-    static void       _call_func(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); call_func_pack(m.items, idx); }
-    static uint8_t    _value_count(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return value_count_pack(m.items, idx); }
-    static menu_text_t _value_label_at(void const *mptr, uint8_t idx, uint8_t value_idx) { M const &m = *static_cast<M const *>(mptr); return value_label_at_pack(m.items, idx, value_idx); }
-    static uint8_t    _value_selected(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return value_selected_pack(m.items, idx); }
-    static void       _value_select(void const *mptr, uint8_t idx, uint8_t value_idx) { M const &m = *static_cast<M const *>(mptr); value_select_pack(m.items, idx, value_idx); }
-    static bool       _hidden(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return hidden_pack(m.items, idx); }
-    static bool       _disabled(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); return disabled_pack(m.items, idx); }
-    static bool       _format_value(void const *mptr, uint8_t idx, char *out, uint8_t cap) { M const &m = *static_cast<M const *>(mptr); return format_value_pack(m.items, idx, out, cap); }
-    static void       _on_change(void const *mptr, uint8_t idx) { M const &m = *static_cast<M const *>(mptr); on_change_pack(m.items, idx); }
     static menu_ops_t const ops;
 };
 template<typename... Items>
-menu_ops_t const ops_for<menu_t<Items...>>::ops = {
+menu_ops_t const ops_for<menu_t<Items...>>::ops MENU_OPS_STORAGE = {
     &ops_for<menu_t<Items...>>::_count,
     &ops_for<menu_t<Items...>>::_label_at,
     &ops_for<menu_t<Items...>>::_type_at,
@@ -1077,10 +1686,15 @@ menu_ops_t const ops_for<menu_t<Items...>>::ops = {
     &ops_for<menu_t<Items...>>::_value_label_at,
     &ops_for<menu_t<Items...>>::_value_selected,
     &ops_for<menu_t<Items...>>::_value_select,
+#if MENU_FEATURE_VISIBILITY
     &ops_for<menu_t<Items...>>::_hidden,
     &ops_for<menu_t<Items...>>::_disabled,
+#endif
+#if MENU_FEATURE_FORMAT
     &ops_for<menu_t<Items...>>::_format_value,
-    &ops_for<menu_t<Items...>>::_on_change
+#endif
+    &ops_for<menu_t<Items...>>::_on_change,
+    &ops_for<menu_t<Items...>>::_default_at
 };
 
 template<typename CM>
@@ -1091,92 +1705,667 @@ static inline bool item_child(item_menu_t<CM> const &m, void const **out_child,
     return true;
 }
 
-/* ============================= Engine Runtime ============================ */
+/* ========================== Flash-resident Trees ========================= */
+
+/*
+ * A tree declared `static const ... PROGMEM` is never touched by the RAM ops above. Instead
+ * menu_progmem(tree) hands the runtime pgm_ops_for<Menu>::ops, which walks the same pack by
+ * address and copies each field out of flash only while one op runs. A leaf op reads just
+ * the fields it uses; decorators and submenus are walked by address so a child tree is
+ * never copied.
+ */
+template<typename T>
+static inline T menu_pgm_read(T const *p) {
+#if defined(ARDUINO) && defined(__AVR__)
+    T value;
+    memcpy_P(&value, p, sizeof(T));
+    return value;
+#else
+    return *p;
+#endif
+}
 
-struct menu_cursor_t { void const *menu_ptr; menu_ops_t const *ops; uint8_t selected; uint8_t top; };
+/* Entry type of a leaf item, from its type alone, so type() never builds one. */
+template<typename Item> struct menu_leaf_entry;
+template<> struct menu_leaf_entry<item_int_t>      { static constexpr entry_t value = ENTRY_INT; };
+template<> struct menu_leaf_entry<item_bool_t>     { static constexpr entry_t value = ENTRY_BOOL; };
+template<> struct menu_leaf_entry<item_func_t>     { static constexpr entry_t value = ENTRY_FUNC; };
+template<> struct menu_leaf_entry<item_func_ctx_t> { static constexpr entry_t value = ENTRY_FUNC; };
+template<> struct menu_leaf_entry<item_value_t>    { static constexpr entry_t value = ENTRY_VALUE; };
+template<> struct menu_leaf_entry<item_list_t>     { static constexpr entry_t value = ENTRY_MENU; };
+
+/* Leaf items answer each op by reading only the fields it needs. The base holds the answers
+   of an item without that op; each leaf below overrides the ops it has. */
+template<typename Item>
+struct menu_pgm_leaf {
+    static menu_text_t label(Item const *p) { return menu_pgm_read(&p->label); }
+    static entry_t     type(Item const *) { return menu_leaf_entry<Item>::value; }
+    static bool        int_has(Item const *) { return false; }
+    static bool        scalar_has(Item const *) { return false; }
+    static int         int_get(Item const *) { return 0; }
+    static void        int_set(Item const *, int) { }
+    static int         int_min(Item const *) { return 0; }
+    static int         int_max(Item const *) { return 0; }
+    static int         int_step(Item const *) { return 1; }
+    static void        call(Item const *) { }
+    static bool        child(Item const *, void const **, menu_ops_t const **) { return false; }
+    static uint8_t     value_count(Item const *) { return 0; }
+    static menu_text_t value_label_at(Item const *, uint8_t) { return menu_text(""); }
+    static uint8_t     value_selected(Item const *) { return 255; }
+    static void        value_select(Item const *, uint8_t) { }
+    static bool        hidden(Item const *) { return false; }
+    static bool        disabled(Item const *) { return false; }
+    static bool        format_value(Item const *, char *, uint8_t) { return false; }
+    static void        on_change(Item const *) { }
+    static bool        default_value(Item const *, int *) { return false; }
+};
 
-struct menu_runtime_t {
-    display_t         display;
-    input_fptr_t      input_cb;        /* legacy optional */
-    input_source_t    input_src;       /* provider optional */
-    uint8_t           use_numbers : 1,
-	                      show_title  : 1,
-	                      initialized : 1,
-	                      editing     : 1,
-	                      dirty       : 1,
-	                      has_src     : 1,
-	                      show_breadcrumbs : 1,
-	                      show_affordances : 1,
-                          navigation_wrap  : 1;
+template<typename Item> struct menu_pgm_item;
+
+template<>
+struct menu_pgm_item<item_int_t> : menu_pgm_leaf<item_int_t> {
+    typedef item_int_t I;
+    static bool int_has(I const *p) { return menu_pgm_read(&p->ptr) != 0; }
+    static bool scalar_has(I const *p) { return menu_pgm_read(&p->ptr) != 0; }
+    static int  int_get(I const *p) { int *const ptr = menu_pgm_read(&p->ptr); return ptr ? *ptr : 0; }
+    static void int_set(I const *p, int v) { int *const ptr = menu_pgm_read(&p->ptr); if (ptr) { *ptr = v; } }
+    static int  int_min(I const *p) { return menu_pgm_read(&p->minv); }
+    static int  int_max(I const *p) { return menu_pgm_read(&p->maxv); }
+    static int  int_step(I const *p) { return menu_pgm_read(&p->step); }
+};
 
-    menu_cursor_t     stack[MENU_MAX_STACK];
-    uint8_t           depth;
-    int               edit_original;
-    menu_persistence_t persistence;
+template<>
+struct menu_pgm_item<item_bool_t> : menu_pgm_leaf<item_bool_t> {
+    typedef item_bool_t I;
+    static uint8_t     value_count(I const *p) { return menu_pgm_read(&p->ptr) ? 2 : 0; }
+    static menu_text_t value_label_at(I const *p, uint8_t value_idx) { return menu_pgm_read(value_idx ? &p->true_label : &p->false_label); }
+    static uint8_t     value_selected(I const *p) { bool *const ptr = menu_pgm_read(&p->ptr); return (ptr && *ptr) ? 1 : 0; }
+    static void        value_select(I const *p, uint8_t value_idx) { bool *const ptr = menu_pgm_read(&p->ptr); if (ptr) { *ptr = value_idx != 0; } }
+};
 
-    menu_runtime_t() :
-        display(make_display(0, 0, 0, 0)),
-        input_cb(0),
-        input_src(),
-        use_numbers(0),
-        show_title(0),
-        initialized(0),
-        editing(0),
-        dirty(1),
-        has_src(0),
-        show_breadcrumbs(0),
-        show_affordances(0),
-        navigation_wrap(0),
-        stack(),
-        depth(0),
-        edit_original(0),
-        persistence() {
-    }
+template<>
+struct menu_pgm_item<item_func_t> : menu_pgm_leaf<item_func_t> {
+    static void call(item_func_t const *p) { menu_func_fptr_t const fn = menu_pgm_read(&p->fn); if (fn) { fn(); } }
+};
 
-    /* construct with legacy callback */
-    template<typename RootMenu>
-    static inline menu_runtime_t make(RootMenu const &root, display_t const &disp, input_fptr_t inp, bool use_nums) {
-        menu_runtime_t r = base_init(root, disp, use_nums);
-        r.input_cb = inp;
-        r.has_src  = 0;
-        return r;
-    }
-    template<typename RootMenu>
-    static inline menu_runtime_t make(RootMenu const &&root, display_t const &disp, input_fptr_t inp, bool use_nums) = delete;
+template<>
+struct menu_pgm_item<item_func_ctx_t> : menu_pgm_leaf<item_func_ctx_t> {
+    static void call(item_func_ctx_t const *p) { menu_func_ctx_fptr_t const fn = menu_pgm_read(&p->fn); if (fn) { fn(menu_pgm_read(&p->ctx)); } }
+};
 
-    /* construct with provider */
-    template<typename RootMenu>
-    static inline menu_runtime_t make(RootMenu const &root, display_t const &disp, input_source_t src, bool use_nums) {
-        menu_runtime_t r = base_init(root, disp, use_nums);
-        r.input_cb = 0;
-        r.input_src = src;
-        r.has_src  = 1;
-        return r;
-    }
-    template<typename RootMenu>
-    static inline menu_runtime_t make(RootMenu const &&root, display_t const &disp, input_source_t src, bool use_nums) = delete;
+template<>
+struct menu_pgm_item<item_value_t> : menu_pgm_leaf<item_value_t> {
+    typedef item_value_t I;
+    static bool int_has(I const *p) { return menu_pgm_read(&p->get) != 0 && menu_pgm_read(&p->set) != 0; }
+    static bool scalar_has(I const *p) { return menu_pgm_read(&p->get) != 0; }
+    static int  int_get(I const *p) { menu_get_int_ctx_fptr_t const get = menu_pgm_read(&p->get); return get ? get(menu_pgm_read(&p->ctx)) : 0; }
+    static void int_set(I const *p, int v) { menu_set_int_ctx_fptr_t const set = menu_pgm_read(&p->set); if (set) { set(menu_pgm_read(&p->ctx), v); } }
+    static int  int_min(I const *p) { return menu_pgm_read(&p->minv); }
+    static int  int_max(I const *p) { return menu_pgm_read(&p->maxv); }
+    static int  int_step(I const *p) { return menu_pgm_read(&p->step); }
+};
 
-    inline void begin(void) { initialized = 1; dirty = 1; }
+template<>
+struct menu_pgm_item<item_list_t> : menu_pgm_leaf<item_list_t> {
+    static bool child(item_list_t const *p, void const **out_child, menu_ops_t const **out_ops) {
+        item_list_t const l = { menu_pgm_read(&p->label), menu_pgm_read(&p->list) };
+        return item_child(l, out_child, out_ops);
+    }
+};
 
-    inline void request_redraw(void) { dirty = 1; }
+/* Decorators forward everything to the wrapped item and override only their own op. */
+template<typename Outer, typename Inner>
+struct menu_pgm_forward {
+    typedef menu_pgm_item<Inner> I;
+    static menu_text_t label(Outer const *p) { return I::label(&p->item); }
+    static entry_t     type(Outer const *p) { return I::type(&p->item); }
+    static bool        int_has(Outer const *p) { return I::int_has(&p->item); }
+    static bool        scalar_has(Outer const *p) { return I::scalar_has(&p->item); }
+    static int         int_get(Outer const *p) { return I::int_get(&p->item); }
+    static void        int_set(Outer const *p, int v) { I::int_set(&p->item, v); }
+    static int         int_min(Outer const *p) { return I::int_min(&p->item); }
+    static int         int_max(Outer const *p) { return I::int_max(&p->item); }
+    static int         int_step(Outer const *p) { return I::int_step(&p->item); }
+    static void        call(Outer const *p) { I::call(&p->item); }
+    static bool        child(Outer const *p, void const **out_child, menu_ops_t const **out_ops) { return I::child(&p->item, out_child, out_ops); }
+    static uint8_t     value_count(Outer const *p) { return I::value_count(&p->item); }
+    static menu_text_t value_label_at(Outer const *p, uint8_t value_idx) { return I::value_label_at(&p->item, value_idx); }
+    static uint8_t     value_selected(Outer const *p) { return I::value_selected(&p->item); }
+    static void        value_select(Outer const *p, uint8_t value_idx) { I::value_select(&p->item, value_idx); }
+    static bool        hidden(Outer const *p) { return I::hidden(&p->item); }
+    static bool        disabled(Outer const *p) { return I::disabled(&p->item); }
+    static bool        format_value(Outer const *p, char *out, uint8_t cap) { return I::format_value(&p->item, out, cap); }
+    static void        on_change(Outer const *p) { I::on_change(&p->item); }
+    static bool        default_value(Outer const *p, int *out) { return I::default_value(&p->item, out); }
+};
 
-    inline void reset_navigation(void) {
-        depth = 0;
-        editing = 0;
-        edit_original = 0;
-        stack[0].selected = 0;
-        stack[0].top = 0;
-        dirty = 1;
+template<typename Item>
+struct menu_pgm_item<item_meta_t<Item>> : menu_pgm_forward<item_meta_t<Item>, Item> {
+    static bool hidden(item_meta_t<Item> const *p) {
+        return menu_condition_matches(menu_pgm_read(&p->hidden)) || menu_pgm_item<Item>::hidden(&p->item);
     }
-
+    static bool disabled(item_meta_t<Item> const *p) {
+        return menu_condition_matches(menu_pgm_read(&p->disabled)) || menu_pgm_item<Item>::disabled(&p->item);
+    }
+};
+
+template<typename Item>
+struct menu_pgm_item<item_format_t<Item>> : menu_pgm_forward<item_format_t<Item>, Item> {
+    static bool format_value(item_format_t<Item> const *p, char *out, uint8_t cap) {
+        menu_format_ctx_fptr_t const fn = menu_pgm_read(&p->fn);
+        if (out && cap) { out[0] = '\0'; }
+        if (fn) {
+            fn(menu_pgm_read(&p->ctx), out, cap);
+            if (out && cap) { out[cap - 1] = '\0'; }
+            return true;
+        }
+        return menu_pgm_item<Item>::format_value(&p->item, out, cap);
+    }
+};
+
+template<typename Item>
+struct menu_pgm_item<item_change_t<Item>> : menu_pgm_forward<item_change_t<Item>, Item> {
+    static void on_change(item_change_t<Item> const *p) {
+        menu_pgm_item<Item>::on_change(&p->item);
+        menu_on_change_ctx_fptr_t const fn = menu_pgm_read(&p->fn);
+        if (fn) { fn(menu_pgm_read(&p->ctx)); }
+    }
+};
+
+template<typename Item>
+struct menu_pgm_item<item_default_t<Item>> : menu_pgm_forward<item_default_t<Item>, Item> {
+    static bool default_value(item_default_t<Item> const *p, int *out) {
+        if (out) { *out = menu_pgm_read(&p->value); }
+        return true;
+    }
+};
+
+static inline int menu_choice_value_pgm(select_choice_t const *c) { return menu_pgm_read(&c->value); }
+
+/* A select is read one field at a time, so a long choice list is never copied out of flash. */
+template<typename... Choices>
+struct menu_pgm_item<item_select_t<Choices...>> {
+    typedef item_select_t<Choices...> S;
+    static menu_text_t label(S const *p) { return menu_pgm_read(&p->label); }
+    static entry_t     type(S const *) { return ENTRY_SELECT; }
+    static bool        int_has(S const *) { return false; }
+    static bool        scalar_has(S const *) { return false; }
+    static int         int_get(S const *) { return 0; }
+    static void        int_set(S const *, int) { }
+    static int         int_min(S const *) { return 0; }
+    static int         int_max(S const *) { return 0; }
+    static int         int_step(S const *) { return 1; }
+    static void        call(S const *) { }
+    static bool        child(S const *, void const **, menu_ops_t const **) { return false; }
+    static uint8_t     value_count(S const *p) { return menu_pgm_read(&p->ptr) ? S::count() : 0; }
+    static menu_text_t value_label_at(S const *p, uint8_t value_idx) { return value_idx < S::count() ? menu_pgm_read(&p->choices[value_idx].label) : menu_text(""); }
+    static uint8_t     value_selected(S const *p) {
+        int *const ptr = menu_pgm_read(&p->ptr);
+        return ptr ? menu_choice_index(p->choices, S::count(), menu_pgm_read(&p->lookup), *ptr, &menu_choice_value_pgm) : 255;
+    }
+    static void        value_select(S const *p, uint8_t value_idx) {
+        int *const ptr = menu_pgm_read(&p->ptr);
+        if (ptr) { *ptr = value_idx < S::count() ? menu_pgm_read(&p->choices[value_idx].value) : 0; }
+    }
+    static bool        hidden(S const *) { return false; }
+    static bool        disabled(S const *) { return false; }
+    static bool        format_value(S const *, char *, uint8_t) { return false; }
+    static void        on_change(S const *) { }
+    static bool        default_value(S const *, int *) { return false; }
+};
+
+template<typename MenuConcrete> struct pgm_ops_for;
+
+template<typename CM>
+struct menu_pgm_item<item_menu_t<CM>> {
+    typedef item_menu_t<CM> M;
+    static menu_text_t label(M const *p) { return menu_pgm_read(&p->label); }
+    static entry_t     type(M const *) { return ENTRY_MENU; }
+    static bool        int_has(M const *) { return false; }
+    static bool        scalar_has(M const *) { return false; }
+    static int         int_get(M const *) { return 0; }
+    static void        int_set(M const *, int) { }
+    static int         int_min(M const *) { return 0; }
+    static int         int_max(M const *) { return 0; }
+    static int         int_step(M const *) { return 1; }
+    static void        call(M const *) { }
+    static bool        child(M const *p, void const **out_child, menu_ops_t const **out_ops) {
+        if (!out_child || !out_ops) { return false; }
+        *out_child = static_cast<void const *>(&p->child);
+        *out_ops   = &pgm_ops_for<CM>::ops;
+        return true;
+    }
+    static uint8_t     value_count(M const *) { return 0; }
+    static menu_text_t value_label_at(M const *, uint8_t) { return menu_text(""); }
+    static uint8_t     value_selected(M const *) { return 255; }
+    static void        value_select(M const *, uint8_t) { }
+    static bool        hidden(M const *) { return false; }
+    static bool        disabled(M const *) { return false; }
+    static bool        format_value(M const *, char *, uint8_t) { return false; }
+    static void        on_change(M const *) { }
+    static bool        default_value(M const *, int *) { return false; }
+};
+
+/* pgm_ops_for<menu_t<...>>: the flash-reading twin of ops_for */
+template<typename... Items>
+struct pgm_ops_for<menu_t<Items...>> : menu_item_ops_for<menu_t<Items...>, menu_pgm_item> {
+    typedef menu_t<Items...> M;
+    static uint8_t    _count(void const *) { return static_cast<uint8_t>(sizeof...(Items)); }
+    static menu_text_t _title(void const *mptr) { menu_text_t const t = menu_pgm_read(&static_cast<M const *>(mptr)->title); return t.ptr ? t : menu_text(""); }
+    static menu_ops_t const ops;
+};
+template<typename... Items>
+menu_ops_t const pgm_ops_for<menu_t<Items...>>::ops MENU_OPS_STORAGE = {
+    &pgm_ops_for<menu_t<Items...>>::_count,
+    &pgm_ops_for<menu_t<Items...>>::_label_at,
+    &pgm_ops_for<menu_t<Items...>>::_type_at,
+    &pgm_ops_for<menu_t<Items...>>::_int_has,
+    &pgm_ops_for<menu_t<Items...>>::_scalar_has,
+    &pgm_ops_for<menu_t<Items...>>::_int_get,
+    &pgm_ops_for<menu_t<Items...>>::_int_set,
+    &pgm_ops_for<menu_t<Items...>>::_int_min,
+    &pgm_ops_for<menu_t<Items...>>::_int_max,
+    &pgm_ops_for<menu_t<Items...>>::_int_step,
+    &pgm_ops_for<menu_t<Items...>>::_child_at,
+    &pgm_ops_for<menu_t<Items...>>::_call_func,
+    &pgm_ops_for<menu_t<Items...>>::_title,
+    &pgm_ops_for<menu_t<Items...>>::_value_count,
+    &pgm_ops_for<menu_t<Items...>>::_value_label_at,
+    &pgm_ops_for<menu_t<Items...>>::_value_selected,
+    &pgm_ops_for<menu_t<Items...>>::_value_select,
+#if MENU_FEATURE_VISIBILITY
+    &pgm_ops_for<menu_t<Items...>>::_hidden,
+    &pgm_ops_for<menu_t<Items...>>::_disabled,
+#endif
+#if MENU_FEATURE_FORMAT
+    &pgm_ops_for<menu_t<Items...>>::_format_value,
+#endif
+    &pgm_ops_for<menu_t<Items...>>::_on_change,
+    &pgm_ops_for<menu_t<Items...>>::_default_at
+};
+
+/* Handle passed to menu_runtime_t::make() in place of a RAM tree. Keep it in a variable: the
+ * runtime rejects temporaries for roots of either kind. */
+template<typename Menu>
+struct menu_progmem_t { Menu const *menu; };
+
+template<typename Menu>
+static inline constexpr menu_progmem_t<Menu> menu_progmem(Menu const &menu) {
+    return menu_progmem_t<Menu>{ &menu };
+}
+
+/* ============================= Tree Footprint ============================ */
+
+/*
+ * menu_footprint<decltype(tree)> describes a declared tree at compile time, so firmware can
+ * budget it with static_assert before anything is flashed:
+ *
+ *   static_assert(menu_footprint<decltype(mainMenu)>::bytes <= 400, "menu tree too large");
+ *
+ * bytes is sizeof the whole tree. items counts every item at every level, and the per-kind
+ * counts split them by entry type (decorators are counted separately and not as items).
+ * menus counts the root and each submenu. depth is the number of menu levels (1 for a flat
+ * menu), which is what the runtime's cursor stack must hold. max_items is the longest single
+ * menu. ops_tables is the number of distinct menu types, one ops_for table each. texts counts
+ * the menu_text_t fields: titles, labels, bool labels and choice labels.
+ */
+template<typename... Ts> struct menu_type_list { };
+
+template<typename A, typename B> struct menu_type_list_cat;
+template<typename... A, typename... B>
+struct menu_type_list_cat<menu_type_list<A...>, menu_type_list<B...>> { typedef menu_type_list<A..., B...> type; };
+
+template<typename A, typename B> struct menu_is_same { static constexpr bool value = false; };
+template<typename A> struct menu_is_same<A, A> { static constexpr bool value = true; };
+
+template<typename T, typename List> struct menu_type_list_has;
+template<typename T> struct menu_type_list_has<T, menu_type_list<>> { static constexpr bool value = false; };
+template<typename T, typename Head, typename... Rest>
+struct menu_type_list_has<T, menu_type_list<Head, Rest...>> {
+    static constexpr bool value = menu_is_same<T, Head>::value || menu_type_list_has<T, menu_type_list<Rest...>>::value;
+};
+
+template<typename List> struct menu_type_list_unique;
+template<> struct menu_type_list_unique<menu_type_list<>> { static constexpr uint16_t value = 0; };
+template<typename Head, typename... Rest>
+struct menu_type_list_unique<menu_type_list<Head, Rest...>> {
+    static constexpr uint16_t value = static_cast<uint16_t>((menu_type_list_has<Head, menu_type_list<Rest...>>::value ? 0 : 1) +
+                                                            menu_type_list_unique<menu_type_list<Rest...>>::value);
+};
+
+static inline constexpr uint16_t menu_max_u16(uint16_t a, uint16_t b) { return a > b ? a : b; }
+
+template<uint16_t Ints, uint16_t Bools, uint16_t Selects, uint16_t Choices, uint16_t Values, uint16_t Funcs, uint16_t Texts>
+struct menu_leaf_footprint {
+    static constexpr uint16_t ints = Ints;
+    static constexpr uint16_t bools = Bools;
+    static constexpr uint16_t selects = Selects;
+    static constexpr uint16_t choices = Choices;
+    static constexpr uint16_t values = Values;
+    static constexpr uint16_t funcs = Funcs;
+    static constexpr uint16_t submenus = 0;
+    static constexpr uint16_t decorators = 0;
+    static constexpr uint16_t texts = Texts;
+    static constexpr uint16_t items_below = 0;   /* items inside a submenu */
+    static constexpr uint16_t depth = 0;         /* menu levels below this item */
+    static constexpr uint16_t max_items = 0;
+    typedef menu_type_list<> menu_types;
+};
+
+template<typename Item> struct menu_item_footprint;
+template<> struct menu_item_footprint<item_int_t> : menu_leaf_footprint<1, 0, 0, 0, 0, 0, 1> { };
+template<> struct menu_item_footprint<item_bool_t> : menu_leaf_footprint<0, 1, 0, 0, 0, 0, 3> { };
+template<> struct menu_item_footprint<item_func_t> : menu_leaf_footprint<0, 0, 0, 0, 0, 1, 1> { };
+template<> struct menu_item_footprint<item_func_ctx_t> : menu_leaf_footprint<0, 0, 0, 0, 0, 1, 1> { };
+template<> struct menu_item_footprint<item_value_t> : menu_leaf_footprint<0, 0, 0, 0, 1, 0, 1> { };
+/* A list opens one menu level whose rows are not part of the declaration. */
+template<> struct menu_item_footprint<item_list_t> : menu_leaf_footprint<0, 0, 0, 0, 0, 0, 1> {
+    static constexpr uint16_t submenus = 1;
+    static constexpr uint16_t depth = 1;
+};
+template<typename... Choices>
+struct menu_item_footprint<item_select_t<Choices...>>
+    : menu_leaf_footprint<0, 0, 1, sizeof...(Choices), 0, 0, 1 + sizeof...(Choices)> { };
+
+template<typename Inner>
+struct menu_decorator_footprint : menu_item_footprint<Inner> {
+    static constexpr uint16_t decorators = static_cast<uint16_t>(menu_item_footprint<Inner>::decorators + 1);
+};
+template<typename Item> struct menu_item_footprint<item_meta_t<Item>> : menu_decorator_footprint<Item> { };
+template<typename Item> struct menu_item_footprint<item_format_t<Item>> : menu_decorator_footprint<Item> { };
+template<typename Item> struct menu_item_footprint<item_change_t<Item>> : menu_decorator_footprint<Item> { };
+template<typename Item> struct menu_item_footprint<item_default_t<Item>> : menu_decorator_footprint<Item> { };
+
+template<typename Menu> struct menu_footprint;
+
+template<typename CM>
+struct menu_item_footprint<item_menu_t<CM>> {
+    typedef menu_footprint<CM> C;
+    static constexpr uint16_t ints = C::ints;
+    static constexpr uint16_t bools = C::bools;
+    static constexpr uint16_t selects = C::selects;
+    static constexpr uint16_t choices = C::choices;
+    static constexpr uint16_t values = C::values;
+    static constexpr uint16_t funcs = C::funcs;
+    static constexpr uint16_t submenus = C::menus;
+    static constexpr uint16_t decorators = C::decorators;
+    static constexpr uint16_t texts = static_cast<uint16_t>(1 + C::texts);
+    static constexpr uint16_t items_below = C::items;
+    static constexpr uint16_t depth = C::depth;
+    static constexpr uint16_t max_items = C::max_items;
+    typedef typename C::menu_types menu_types;
+};
+
+template<typename Pack> struct menu_pack_footprint;
+template<> struct menu_pack_footprint<pack_nil> : menu_leaf_footprint<0, 0, 0, 0, 0, 0, 0> { };
+template<typename Head, typename Tail>
+struct menu_pack_footprint<pack_node<Head, Tail>> {
+    typedef menu_item_footprint<Head> H;
+    typedef menu_pack_footprint<Tail> T;
+    static constexpr uint16_t ints = static_cast<uint16_t>(H::ints + T::ints);
+    static constexpr uint16_t bools = static_cast<uint16_t>(H::bools + T::bools);
+    static constexpr uint16_t selects = static_cast<uint16_t>(H::selects + T::selects);
+    static constexpr uint16_t choices = static_cast<uint16_t>(H::choices + T::choices);
+    static constexpr uint16_t values = static_cast<uint16_t>(H::values + T::values);
+    static constexpr uint16_t funcs = static_cast<uint16_t>(H::funcs + T::funcs);
+    static constexpr uint16_t submenus = static_cast<uint16_t>(H::submenus + T::submenus);
+    static constexpr uint16_t decorators = static_cast<uint16_t>(H::decorators + T::decorators);
+    static constexpr uint16_t texts = static_cast<uint16_t>(H::texts + T::texts);
+    static constexpr uint16_t items_below = static_cast<uint16_t>(H::items_below + T::items_below);
+    static constexpr uint16_t depth = menu_max_u16(H::depth, T::depth);
+    static constexpr uint16_t max_items = menu_max_u16(H::max_items, T::max_items);
+    typedef typename menu_type_list_cat<typename H::menu_types, typename T::menu_types>::type menu_types;
+};
+
+template<typename... Items>
+struct menu_footprint<menu_t<Items...>> {
+    typedef menu_pack_footprint<typename pack<Items...>::type> P;
+    static constexpr size_t   bytes = sizeof(menu_t<Items...>);
+    static constexpr uint16_t items = static_cast<uint16_t>(sizeof...(Items) + P::items_below);
+    static constexpr uint16_t menus = static_cast<uint16_t>(1 + P::submenus);
+    static constexpr uint16_t depth = static_cast<uint16_t>(1 + P::depth);
+    static constexpr uint16_t max_items = menu_max_u16(sizeof...(Items), P::max_items);
+    static constexpr uint16_t texts = static_cast<uint16_t>(1 + P::texts);
+    static constexpr uint16_t ints = P::ints;
+    static constexpr uint16_t bools = P::bools;
+    static constexpr uint16_t selects = P::selects;
+    static constexpr uint16_t choices = P::choices;
+    static constexpr uint16_t values = P::values;
+    static constexpr uint16_t funcs = P::funcs;
+    static constexpr uint16_t decorators = P::decorators;
+    typedef typename menu_type_list_cat<menu_type_list<menu_t<Items...>>, typename P::menu_types>::type menu_types;
+    static constexpr uint16_t ops_tables = menu_type_list_unique<menu_types>::value;
+};
+/* decltype of a `static const` tree names a const type. */
+template<typename Menu> struct menu_footprint<Menu const> : menu_footprint<Menu> { };
+
+/* Cursor-stack levels a tree needs: the root plus one per nested ITEM_MENU. */
+template<typename Menu>
+struct menu_tree_depth {
+    static_assert(menu_footprint<Menu>::depth <= 255, "BetterMenu supports at most 255 menu levels");
+    static constexpr uint8_t value = static_cast<uint8_t>(menu_footprint<Menu>::depth);
+};
+
+/* ============================= Engine Runtime ============================ */
+
+struct menu_cursor_t { void const *menu_ptr; menu_ops_t const *ops; uint8_t selected; uint8_t top; };
+
+/* One open level of a MENU_COMPACT_STACK runtime; its menu is reached through the levels above. */
+struct menu_stack_frame_t { uint8_t selected; uint8_t top; };
+
+/* Result of validating or writing one item value outside the input loop. */
+enum menu_value_status_t {
+    MENU_VALUE_OK           = 0,
+    MENU_VALUE_NOT_FOUND    = 1,
+    MENU_VALUE_READ_ONLY    = 2,
+    MENU_VALUE_OUT_OF_RANGE = 3
+};
+
+/* Position of a pre-order walk over the whole tree; see Tree Walking below. Levels bounds the
+   walk the same way it bounds a runtime's cursor stack. */
+template<uint8_t Levels>
+struct basic_menu_tree_iter_t {
+    static constexpr uint8_t levels = Levels;
+    menu_cursor_t path[Levels]; /* selected is the current item at each level */
+    uint8_t       depth;
+    uint8_t       valid;
+    uint16_t      id;
+};
+
+/* The walk matching menu_runtime_t. */
+typedef basic_menu_tree_iter_t<MENU_MAX_STACK> menu_tree_iter_t;
+
+/* Compile-time settings of a basic_menu_runtime_t. Levels is the depth of its cursor stack. */
+template<uint8_t Levels>
+struct menu_runtime_config {
+    static constexpr uint8_t levels = Levels;
+};
+
+/* The engine. Display and Input are the adapter types it calls into:
+   - display_t and input_source_t dispatch through their ops tables at run time;
+     menu_runtime_t (below) is that instantiation, and every adapter takes it.
+   - any other Display derives from menu_display_base, and any other Input provides
+     menu_event_t read_event(). Their calls are resolved at compile time and can inline.
+   menu_runtime_for<Tree>::type sizes the stack to exactly what Tree needs. */
+template<typename Display, typename Input, typename Config>
+struct basic_menu_runtime_t {
+    static constexpr uint8_t levels = Config::levels;
+    static_assert(levels >= 1, "a runtime needs at least one cursor level");
+    typedef basic_menu_tree_iter_t<levels> tree_iter_t;
+
+    Display           display;
+#if MENU_FEATURE_LEGACY_INPUT
+    input_fptr_t      input_cb;        /* legacy optional */
+#endif
+    Input             input_src;       /* provider optional */
+    uint8_t           use_numbers : 1,
+	                      show_title  : 1,
+	                      initialized : 1,
+	                      editing     : 1,
+	                      dirty       : 1,
+	                      has_src     : 1,
+	                      show_breadcrumbs : 1,
+	                      show_affordances : 1,
+                          navigation_wrap  : 1,
+                          show_modified    : 1,
+                          headless         : 1;
+
+#if MENU_COMPACT_STACK
+    void const       *root_ptr;
+    menu_ops_t const *root_ops;
+    menu_cursor_t     current;         /* top level, cached */
+    uint8_t           current_depth;   /* level current was opened at */
+    menu_stack_frame_t frames[levels]; /* levels below depth */
+#else
+    menu_cursor_t     stack[levels];
+#endif
+    uint8_t           depth;
+#if MENU_RENDER_ARENA
+    char              scratch[2 * MENU_MAX_LINE]; /* row text, then value text; reused for every row */
+#endif
+    int               edit_original;
+    menu_persistence_t persistence;
+    menu_defaults_t   defaults;
+
+    basic_menu_runtime_t() :
+        display(),
+#if MENU_FEATURE_LEGACY_INPUT
+        input_cb(0),
+#endif
+        input_src(),
+        use_numbers(0),
+        show_title(0),
+        initialized(0),
+        editing(0),
+        dirty(1),
+        has_src(0),
+        show_breadcrumbs(0),
+        show_affordances(0),
+        navigation_wrap(0),
+        show_modified(0),
+        headless(0),
+#if MENU_COMPACT_STACK
+        root_ptr(0),
+        root_ops(0),
+        current(),
+        current_depth(0),
+        frames(),
+#else
+        stack(),
+#endif
+        depth(0),
+#if MENU_RENDER_ARENA
+        scratch(),
+#endif
+        edit_original(0),
+        persistence(),
+        defaults() {
+    }
+
+#if MENU_FEATURE_LEGACY_INPUT
+    /* construct with legacy callback */
+    template<typename RootMenu>
+    static inline basic_menu_runtime_t make(RootMenu const &root, Display const &disp, input_fptr_t inp, bool use_nums) {
+        basic_menu_runtime_t r = base_init(root, disp, use_nums);
+        r.input_cb = inp;
+        r.has_src  = 0;
+        return r;
+    }
+    template<typename RootMenu>
+    static inline basic_menu_runtime_t make(RootMenu const &&root, Display const &disp, input_fptr_t inp, bool use_nums) = delete;
+#endif
+
+    /* construct with provider */
+    template<typename RootMenu>
+    static inline basic_menu_runtime_t make(RootMenu const &root, Display const &disp, Input const &src, bool use_nums) {
+        basic_menu_runtime_t r = base_init(root, disp, use_nums);
+        r.input_src = src;
+        r.has_src  = 1;
+        return r;
+    }
+    template<typename RootMenu>
+    static inline basic_menu_runtime_t make(RootMenu const &&root, Display const &disp, Input const &src, bool use_nums) = delete;
+
+    /* construct without display or input, for products driven only through the path API */
+    template<typename RootMenu>
+    static inline basic_menu_runtime_t make_headless(RootMenu const &root) {
+        basic_menu_runtime_t r = base_init(root, Display(), false);
+        r.headless = 1;
+        return r;
+    }
+    template<typename RootMenu>
+    static inline basic_menu_runtime_t make_headless(RootMenu const &&root) = delete;
+
+    inline void begin(void) { initialized = 1; dirty = 1; }
+
+    inline void request_redraw(void) { dirty = 1; }
+
+    inline void reset_navigation(void) {
+        depth = 0;
+        editing = 0;
+        edit_original = 0;
+        top().selected = 0;
+        top().top = 0;
+#if MENU_COMPACT_STACK
+        current.menu_ptr = root_ptr;
+        current.ops = root_ops;
+        current_depth = 0;
+#endif
+        dirty = 1;
+    }
+
+    /* The root menu as a cursor at its first item. */
+    inline menu_cursor_t root(void) const {
+#if MENU_COMPACT_STACK
+        menu_cursor_t const cur = { root_ptr, root_ops, 0, 0 };
+#else
+        menu_cursor_t const cur = { stack[0].menu_ptr, stack[0].ops, 0, 0 };
+#endif
+        return cur;
+    }
+
+    /* The open menu at depth. Writes through it move the highlight or scroll position. */
+#if MENU_COMPACT_STACK
+    inline menu_cursor_t &top(void) { return current; }
+    inline menu_cursor_t const &top(void) const { return current; }
+#else
+    inline menu_cursor_t &top(void) { return stack[depth]; }
+    inline menu_cursor_t const &top(void) const { return stack[depth]; }
+#endif
+
+    /* False when depth points past the open levels, e.g. after project code rewrote it. */
+    inline bool top_valid(void) const {
+#if MENU_COMPACT_STACK
+        return menu_cursor_valid(current) && current_depth == depth;
+#else
+        return menu_cursor_valid(stack[depth]);
+#endif
+    }
+
+    /* The menu open at level (0 = root, depth = top). */
+    inline menu_cursor_t cursor_at(uint8_t level) const {
+#if MENU_COMPACT_STACK
+        if (level >= depth) { return current; }
+        return derive_level(level);
+#else
+        return stack[level];
+#endif
+    }
+
     /* ---------- helpers ---------- */
-    static inline menu_runtime_t base_init(void const *root_ptr, menu_ops_t const *root_ops, display_t const &disp, bool use_nums) {
-        menu_runtime_t r;
+    static inline basic_menu_runtime_t base_init(void const *root_ptr, menu_ops_t const *root_ops, Display const &disp, bool use_nums) {
+        basic_menu_runtime_t r;
         r.display      = disp;
+#if MENU_FEATURE_LEGACY_INPUT
         r.input_cb     = 0;
-        r.input_src.ctx = 0;
-        r.input_src.ops = 0;
+#endif
+        r.input_src    = Input();
+#if MENU_FEATURE_NUMBERING
         r.use_numbers  = use_nums ? 1 : 0;
+#else
+        r.use_numbers  = 0;
+        (void)use_nums;
+#endif
         r.show_title   = 0;
         r.initialized  = 0;
         r.editing      = 0;
@@ -1185,24 +2374,47 @@ struct menu_runtime_t {
 	    r.show_breadcrumbs = 0;
 	    r.show_affordances = 0;
         r.navigation_wrap = 0;
+        r.show_modified = 0;
+        r.headless     = 0;
 	    r.depth        = 0;
 	    r.edit_original= 0;
 	    r.persistence  = menu_persistence_t();
+        r.defaults     = menu_defaults_t();
+#if MENU_COMPACT_STACK
+        r.root_ptr         = root_ptr;
+        r.root_ops         = root_ops;
+        r.current.menu_ptr = root_ptr;
+        r.current.ops      = root_ops;
+        r.current.selected = 0;
+        r.current.top      = 0;
+        r.current_depth    = 0;
+#else
         r.stack[0].menu_ptr = root_ptr;
         r.stack[0].ops      = root_ops;
         r.stack[0].selected = 0;
         r.stack[0].top      = 0;
+#endif
         return r;
     }
     template<typename RootMenu>
-    static inline menu_runtime_t base_init(RootMenu const &root, display_t const &disp, bool use_nums) {
+    static inline basic_menu_runtime_t base_init(RootMenu const &root, Display const &disp, bool use_nums) {
+        static_assert(!MENU_DEPTH_CHECK || menu_tree_depth<RootMenu>::value <= levels,
+                      "menu tree is deeper than the cursor stack: raise MENU_MAX_STACK or use menu_runtime_for<>");
         return base_init(static_cast<void const *>(&root), &ops_for<RootMenu>::ops, disp, use_nums);
     }
     template<typename RootMenu>
-    static inline menu_runtime_t base_init(RootMenu const &&root, display_t const &disp, bool use_nums) = delete;
+    static inline basic_menu_runtime_t base_init(RootMenu const &&root, Display const &disp, bool use_nums) = delete;
+    template<typename Menu>
+    static inline basic_menu_runtime_t base_init(menu_progmem_t<Menu> const &root, Display const &disp, bool use_nums) {
+        static_assert(!MENU_DEPTH_CHECK || menu_tree_depth<Menu>::value <= levels,
+                      "menu tree is deeper than the cursor stack: raise MENU_MAX_STACK or use menu_runtime_for<>");
+        return base_init(static_cast<void const *>(root.menu), &pgm_ops_for<Menu>::ops, disp, use_nums);
+    }
 
     inline void set_show_title(bool enable) { show_title = enable ? 1 : 0; dirty = 1; }
+#if MENU_FEATURE_BREADCRUMBS
     inline void set_show_breadcrumbs(bool enable) { show_breadcrumbs = enable ? 1 : 0; dirty = 1; }
+#endif
     inline void set_show_affordances(bool enable) { show_affordances = enable ? 1 : 0; dirty = 1; }
     inline void set_navigation_mode(menu_navigation_mode_t mode) { navigation_wrap = (mode == MENU_NAV_WRAP) ? 1 : 0; }
     inline void set_navigation_wrap(bool enable) { navigation_wrap = enable ? 1 : 0; }
@@ -1215,91 +2427,221 @@ struct menu_runtime_t {
     inline void save_persistence(void) {
         if (persistence.save) { persistence.save(persistence.ctx); }
     }
+    inline void set_show_modified(bool enable) { show_modified = enable ? 1 : 0; dirty = 1; }
+    inline void set_headless(bool enable) { headless = enable ? 1 : 0; dirty = 1; }
+    inline void set_defaults(int *table, uint16_t count) { defaults = menu_defaults_t(table, count); }
+
+    /* Factory defaults; defined after Tree Walking. */
+    inline void capture_defaults(void);
+    inline void restore_defaults(void);
+    inline bool restore_defaults(uint16_t id);
+    inline bool default_value(menu_cursor_t const &cur, uint8_t idx, uint16_t id, long *out) const;
+    inline bool is_modified(uint16_t id) const;
+    inline uint32_t modified_rows(menu_cursor_t const &view, uint8_t first_idx) const;
+    inline bool restore_item(menu_cursor_t const &cur, uint8_t idx, uint16_t id);
 
     static inline uint8_t min_u8(uint8_t a, uint8_t b) { return a < b ? a : b; }
-    static inline uint8_t effective_width(display_t const &d) { return (d.width == 0 || d.width >= MENU_MAX_LINE) ? static_cast<uint8_t>(MENU_MAX_LINE - 1) : d.width; }
-    static inline uint8_t effective_line_capacity(display_t const &d) { return static_cast<uint8_t>(effective_width(d) + 1); }
-    static inline void display_clear(display_t const &d) {
+    static inline uint8_t effective_width(Display const &d) { return (d.width == 0 || d.width >= MENU_MAX_LINE) ? static_cast<uint8_t>(MENU_MAX_LINE - 1) : d.width; }
+    static inline uint8_t effective_line_capacity(Display const &d) { return static_cast<uint8_t>(effective_width(d) + 1); }
+    static inline void display_clear(display_t &d) {
         if (d.ops && d.ops->clear) { d.ops->clear(d.ctx); }
+#if MENU_FEATURE_LEGACY_DISPLAY
         else if (d.clear) { d.clear(); }
+#endif
     }
-    static inline void display_write_line(display_t const &d, uint8_t row, char const *text) {
+    static inline void display_write_line(display_t &d, uint8_t row, char const *text) {
         if (d.ops && d.ops->write_line) { d.ops->write_line(d.ctx, row, text); }
+#if MENU_FEATURE_LEGACY_DISPLAY
         else if (d.write_line) { d.write_line(row, text); }
+#endif
     }
-    static inline void display_flush(display_t const &d) {
+    static inline void display_flush(display_t &d) {
         if (d.ops && d.ops->flush) { d.ops->flush(d.ctx); }
+#if MENU_FEATURE_LEGACY_DISPLAY
         else if (d.flush) { d.flush(); }
+#endif
     }
-    static inline void display_render_line(display_t const &d, menu_render_line_t const &line) {
+    static inline void display_render_line(display_t &d, menu_render_line_t const &line) {
         if (d.ops && d.ops->render_line) { d.ops->render_line(d.ctx, &line); }
         else { display_write_line(d, line.row, line.text); }
     }
+    /* A concrete Display is called directly; the display_t overloads above win for display_t. */
+    template<typename D>
+    static inline void display_clear(D &d) { d.clear(); }
+    template<typename D>
+    static inline void display_flush(D &d) { d.flush(); }
+    template<typename D>
+    static inline void display_render_line(D &d, menu_render_line_t const &line) { d.render_line(line); }
+    static inline menu_event_t input_read(input_source_t &src) {
+        menu_event_t event = menu_event(Choice_Invalid);
+        if (!src.ops) { return event; }
+        if (src.ops->capture) { src.ops->capture(src.ctx); }
+        if (src.ops->read_event) { event = src.ops->read_event(src.ctx); }
+        if (event.choice == Choice_Invalid && src.ops->read) { event.choice = src.ops->read(src.ctx); }
+        if (event.choice == Choice_Invalid) {
+            if      (src.ops->up     && src.ops->up(src.ctx))       { event.choice = Choice_Up; }
+            else if (src.ops->down   && src.ops->down(src.ctx))     { event.choice = Choice_Down; }
+            else if (src.ops->select && src.ops->select(src.ctx))   { event.choice = Choice_Select; }
+            else if (src.ops->cancel && src.ops->cancel(src.ctx))   { event.choice = Choice_Cancel; }
+            else if (src.ops->left   && src.ops->left(src.ctx))     { event.choice = Choice_Left; }
+            else if (src.ops->right  && src.ops->right(src.ctx))    { event.choice = Choice_Right; }
+        }
+        return event;
+    }
+    template<typename I>
+    static inline menu_event_t input_read(I &in) { return in.read_event(); }
     static inline bool menu_cursor_valid(menu_cursor_t const &c) {
         return c.menu_ptr != 0 && c.ops != 0;
     }
+    /* The op in slot, or null when the cursor or the slot is empty. */
+    template<typename Fn>
+    static inline Fn menu_op(menu_cursor_t const &c, Fn menu_ops_t::*slot) {
+        return menu_cursor_valid(c) ? menu_ops_fn(&(c.ops->*slot)) : 0;
+    }
     static inline uint8_t menu_count(menu_cursor_t const &c) {
-        return (menu_cursor_valid(c) && c.ops->count) ? c.ops->count(c.menu_ptr) : 0;
+        auto const fn = menu_op(c, &menu_ops_t::count);
+        return fn ? fn(c.menu_ptr) : 0;
     }
     static inline menu_text_t menu_title(menu_cursor_t const &c) {
-        return (menu_cursor_valid(c) && c.ops->title) ? c.ops->title(c.menu_ptr) : menu_text("");
+        auto const fn = menu_op(c, &menu_ops_t::title);
+        return fn ? fn(c.menu_ptr) : menu_text("");
     }
     static inline menu_text_t menu_label_at(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->label_at) ? c.ops->label_at(c.menu_ptr, idx) : menu_text("");
+        auto const fn = menu_op(c, &menu_ops_t::label_at);
+        return fn ? fn(c.menu_ptr, idx) : menu_text("");
     }
     static inline entry_t menu_type_at(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->type_at) ? c.ops->type_at(c.menu_ptr, idx) : ENTRY_FUNC;
+        auto const fn = menu_op(c, &menu_ops_t::type_at);
+        return fn ? fn(c.menu_ptr, idx) : ENTRY_FUNC;
     }
     static inline bool menu_int_has(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->int_has) ? c.ops->int_has(c.menu_ptr, idx) : false;
+        auto const fn = menu_op(c, &menu_ops_t::int_has);
+        return fn ? fn(c.menu_ptr, idx) : false;
     }
     static inline bool menu_scalar_has(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->scalar_has) ? c.ops->scalar_has(c.menu_ptr, idx) : false;
+        auto const fn = menu_op(c, &menu_ops_t::scalar_has);
+        return fn ? fn(c.menu_ptr, idx) : false;
     }
     static inline int menu_int_get(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->int_get) ? c.ops->int_get(c.menu_ptr, idx) : 0;
+        auto const fn = menu_op(c, &menu_ops_t::int_get);
+        return fn ? fn(c.menu_ptr, idx) : 0;
     }
     static inline void menu_int_set(menu_cursor_t const &c, uint8_t idx, int value) {
-        if (menu_cursor_valid(c) && c.ops->int_set) { c.ops->int_set(c.menu_ptr, idx, value); }
+        auto const fn = menu_op(c, &menu_ops_t::int_set);
+        if (fn) { fn(c.menu_ptr, idx, value); }
     }
     static inline int menu_int_min(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->int_min) ? c.ops->int_min(c.menu_ptr, idx) : 0;
+        auto const fn = menu_op(c, &menu_ops_t::int_min);
+        return fn ? fn(c.menu_ptr, idx) : 0;
     }
     static inline int menu_int_max(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->int_max) ? c.ops->int_max(c.menu_ptr, idx) : 0;
+        auto const fn = menu_op(c, &menu_ops_t::int_max);
+        return fn ? fn(c.menu_ptr, idx) : 0;
     }
     static inline int menu_int_step(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->int_step) ? c.ops->int_step(c.menu_ptr, idx) : 1;
+        auto const fn = menu_op(c, &menu_ops_t::int_step);
+        return fn ? fn(c.menu_ptr, idx) : 1;
     }
     static inline bool menu_child_at(menu_cursor_t const &c, uint8_t idx, void const **out_child, menu_ops_t const **out_ops) {
-        return (menu_cursor_valid(c) && c.ops->child_at) ? c.ops->child_at(c.menu_ptr, idx, out_child, out_ops) : false;
+        auto const fn = menu_op(c, &menu_ops_t::child_at);
+        return fn ? fn(c.menu_ptr, idx, out_child, out_ops) : false;
     }
     static inline void menu_call_func(menu_cursor_t const &c, uint8_t idx) {
-        if (menu_cursor_valid(c) && c.ops->call_func) { c.ops->call_func(c.menu_ptr, idx); }
+        auto const fn = menu_op(c, &menu_ops_t::call_func);
+        if (fn) { fn(c.menu_ptr, idx); }
     }
     static inline uint8_t menu_value_count(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->value_count) ? c.ops->value_count(c.menu_ptr, idx) : 0;
+        auto const fn = menu_op(c, &menu_ops_t::value_count);
+        return fn ? fn(c.menu_ptr, idx) : 0;
     }
     static inline menu_text_t menu_value_label_at(menu_cursor_t const &c, uint8_t idx, uint8_t value_idx) {
-        return (menu_cursor_valid(c) && c.ops->value_label_at) ? c.ops->value_label_at(c.menu_ptr, idx, value_idx) : menu_text("");
+        auto const fn = menu_op(c, &menu_ops_t::value_label_at);
+        return fn ? fn(c.menu_ptr, idx, value_idx) : menu_text("");
     }
     static inline uint8_t menu_value_selected(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->value_selected) ? c.ops->value_selected(c.menu_ptr, idx) : 255;
+        auto const fn = menu_op(c, &menu_ops_t::value_selected);
+        return fn ? fn(c.menu_ptr, idx) : 255;
     }
     static inline void menu_value_select(menu_cursor_t const &c, uint8_t idx, uint8_t value_idx) {
-        if (menu_cursor_valid(c) && c.ops->value_select) { c.ops->value_select(c.menu_ptr, idx, value_idx); }
+        auto const fn = menu_op(c, &menu_ops_t::value_select);
+        if (fn) { fn(c.menu_ptr, idx, value_idx); }
     }
+#if MENU_FEATURE_VISIBILITY
     static inline bool menu_hidden(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->hidden) ? c.ops->hidden(c.menu_ptr, idx) : false;
+        auto const fn = menu_op(c, &menu_ops_t::hidden);
+        return fn ? fn(c.menu_ptr, idx) : false;
     }
     static inline bool menu_disabled(menu_cursor_t const &c, uint8_t idx) {
-        return (menu_cursor_valid(c) && c.ops->disabled) ? c.ops->disabled(c.menu_ptr, idx) : false;
+        auto const fn = menu_op(c, &menu_ops_t::disabled);
+        return fn ? fn(c.menu_ptr, idx) : false;
     }
+#else
+    static inline bool menu_hidden(menu_cursor_t const &, uint8_t) { return false; }
+    static inline bool menu_disabled(menu_cursor_t const &, uint8_t) { return false; }
+#endif
+#if MENU_FEATURE_FORMAT
     static inline bool menu_format_value(menu_cursor_t const &c, uint8_t idx, char *out, uint8_t cap) {
-        return (menu_cursor_valid(c) && c.ops->format_value) ? c.ops->format_value(c.menu_ptr, idx, out, cap) : false;
+        auto const fn = menu_op(c, &menu_ops_t::format_value);
+        return fn ? fn(c.menu_ptr, idx, out, cap) : false;
     }
+#else
+    static inline bool menu_format_value(menu_cursor_t const &, uint8_t, char *, uint8_t) { return false; }
+#endif
     static inline void menu_on_change(menu_cursor_t const &c, uint8_t idx) {
-        if (menu_cursor_valid(c) && c.ops->on_change) { c.ops->on_change(c.menu_ptr, idx); }
+        auto const fn = menu_op(c, &menu_ops_t::on_change);
+        if (fn) { fn(c.menu_ptr, idx); }
+    }
+    static inline bool menu_default_at(menu_cursor_t const &c, uint8_t idx, int *out) {
+        auto const fn = menu_op(c, &menu_ops_t::default_at);
+        return fn ? fn(c.menu_ptr, idx, out) : false;
+    }
+    /* Item values as seen by remote/automation code: INT and VALUE items use their integer,
+       BOOL and SELECT items use the position of the selected choice. */
+    static inline bool menu_value_read(menu_cursor_t const &c, uint8_t idx, long *out) {
+        switch (menu_type_at(c, idx)) {
+            case ENTRY_INT:
+            case ENTRY_VALUE:
+                if (!menu_scalar_has(c, idx)) { return false; }
+                if (out) { *out = menu_int_get(c, idx); }
+                return true;
+            case ENTRY_BOOL:
+            case ENTRY_SELECT: {
+                uint8_t const selected = menu_value_selected(c, idx);
+                if (selected >= menu_value_count(c, idx)) { return false; }
+                if (out) { *out = selected; }
+                return true;
+            }
+            default: return false;
+        }
+    }
+    static inline uint8_t menu_value_check(menu_cursor_t const &c, uint8_t idx, long value) {
+        if (!menu_cursor_valid(c) || idx >= menu_count(c)) { return MENU_VALUE_NOT_FOUND; }
+        switch (menu_type_at(c, idx)) {
+            case ENTRY_INT:
+            case ENTRY_VALUE: {
+                if (!menu_int_has(c, idx)) { return MENU_VALUE_READ_ONLY; }
+                int mn = menu_int_min(c, idx);
+                int mx = menu_int_max(c, idx);
+                normalize_range(mn, mx);
+                return (value < mn || value > mx) ? MENU_VALUE_OUT_OF_RANGE : MENU_VALUE_OK;
+            }
+            case ENTRY_BOOL:
+            case ENTRY_SELECT: {
+                uint8_t const count = menu_value_count(c, idx);
+                if (!count) { return MENU_VALUE_READ_ONLY; }
+                return (value < 0 || value >= count) ? MENU_VALUE_OUT_OF_RANGE : MENU_VALUE_OK;
+            }
+            default: return MENU_VALUE_READ_ONLY;
+        }
+    }
+    /* Stores an already checked value; returns true when the stored value changed. */
+    static inline bool menu_value_store(menu_cursor_t const &c, uint8_t idx, long value) {
+        long before = 0;
+        bool const had_value = menu_value_read(c, idx, &before);
+        entry_t const tp = menu_type_at(c, idx);
+        if (tp == ENTRY_INT || tp == ENTRY_VALUE) { menu_int_set(c, idx, static_cast<int>(value)); }
+        else { menu_value_select(c, idx, static_cast<uint8_t>(value)); }
+        return !had_value || before != value;
     }
     inline uint8_t title_rows(uint8_t total) const {
         return (show_title && (display.height == 0 || display.height > 1 || total == 0)) ? 1 : 0;
@@ -1410,6 +2752,14 @@ struct menu_runtime_t {
         uint8_t pos = 0; if (neg && pos < cap - 1) { buf[pos++] = '-'; }
         while (i && pos < cap - 1) { buf[pos++] = tmp[--i]; } buf[pos] = '\0'; return buf;
     }
+    /* Full-width variant for the byte-stream adapters, whose values and ids are long. */
+    static inline char *long_to_str(long v, char *buf, uint8_t cap) {
+        if (cap == 0) { return buf; }
+        char tmp[3 * sizeof(long)]; uint8_t i = 0; bool neg = v < 0; unsigned long uv = neg ? (0UL - static_cast<unsigned long>(v)) : static_cast<unsigned long>(v);
+        do { tmp[i++] = static_cast<char>('0' + (uv % 10UL)); uv /= 10UL; } while (uv && i < sizeof(tmp));
+        uint8_t pos = 0; if (neg && pos < cap - 1) { buf[pos++] = '-'; }
+        while (i && pos < cap - 1) { buf[pos++] = tmp[--i]; } buf[pos] = '\0'; return buf;
+    }
     static inline void normalize_range(int &mn, int &mx) {
         if (mn > mx) { int tmp = mn; mn = mx; mx = tmp; }
     }
@@ -1454,43 +2804,54 @@ struct menu_runtime_t {
     void format_title(menu_cursor_t const &cur, char *out_buf) {
         out_buf[0] = '\0';
         uint8_t const cap = effective_line_capacity(display);
+#if MENU_FEATURE_BREADCRUMBS
         if (show_breadcrumbs && depth > 0) {
-            for (uint8_t i = 0; i <= depth && i < MENU_MAX_STACK; ++i) {
+            for (uint8_t i = 0; i <= depth && i < levels; ++i) {
                 if (i) { append_capped(out_buf, cap, "/"); }
-                append_capped(out_buf, cap, menu_title(stack[i]));
+                append_capped(out_buf, cap, menu_title(cursor_at(i)));
             }
         } else {
             append_capped(out_buf, cap, menu_title(cur));
         }
+#else
+        append_capped(out_buf, cap, menu_title(cur));
+#endif
         if (show_affordances && depth > 0) { append_capped(out_buf, cap, " <"); }
     }
 
     void format_line(menu_cursor_t const &cur, uint8_t idx, char *out_buf) {
         uint8_t const cap = effective_line_capacity(display); out_buf[0] = '\0';
+        /* Value text; row numbers and plain integers are formatted here too, before it is used. */
+#if MENU_RENDER_ARENA
+        char *const formatted = scratch + MENU_MAX_LINE;
+#else
+        char formatted[MENU_MAX_LINE];
+#endif
         bool const disabled = menu_disabled(cur, idx);
         bool const selected = (idx == cur.selected) && !disabled;
         append_capped(out_buf, cap, selected ? ">" : " ");
+#if MENU_FEATURE_NUMBERING
         if (use_numbers) {
             uint8_t const display_idx = raw_to_visible(cur, menu_count(cur), idx);
-            char nb[6]; append_capped(out_buf, cap, int_to_str(static_cast<int>(display_idx) + 1, nb, sizeof(nb))); append_capped(out_buf, cap, " ");
+            append_capped(out_buf, cap, int_to_str(static_cast<int>(display_idx) + 1, formatted, MENU_MAX_LINE)); append_capped(out_buf, cap, " ");
         }
+#endif
         append_capped(out_buf, cap, menu_label_at(cur, idx));
         entry_t tp = menu_type_at(cur, idx);
-        char formatted[MENU_MAX_LINE];
         if (tp == ENTRY_INT || tp == ENTRY_VALUE) {
-            bool const has_custom_format = menu_format_value(cur, idx, formatted, sizeof(formatted));
+            bool const has_custom_format = menu_format_value(cur, idx, formatted, MENU_MAX_LINE);
             if (menu_scalar_has(cur, idx) || has_custom_format) {
                 append_capped(out_buf, cap, ": ");
                 if (has_custom_format) {
                     append_capped(out_buf, cap, formatted);
                 } else {
-                    char nb[12]; append_capped(out_buf, cap, int_to_str(menu_int_get(cur, idx), nb, sizeof(nb)));
+                    append_capped(out_buf, cap, int_to_str(menu_int_get(cur, idx), formatted, MENU_MAX_LINE));
                 }
                 if (editing && idx == cur.selected && menu_int_has(cur, idx)) { append_capped(out_buf, cap, "  (edit)"); }
             }
         } else if (tp == ENTRY_BOOL || tp == ENTRY_SELECT) {
             uint8_t value_count = menu_value_count(cur, idx);
-            bool const has_custom_format = menu_format_value(cur, idx, formatted, sizeof(formatted));
+            bool const has_custom_format = menu_format_value(cur, idx, formatted, MENU_MAX_LINE);
             if (value_count || has_custom_format) {
                 uint8_t value_idx = menu_value_selected(cur, idx);
                 append_capped(out_buf, cap, ": ");
@@ -1502,7 +2863,7 @@ struct menu_runtime_t {
                     append_capped(out_buf, cap, "?");
                 }
             }
-        } else if (menu_format_value(cur, idx, formatted, sizeof(formatted))) {
+        } else if (menu_format_value(cur, idx, formatted, MENU_MAX_LINE)) {
             append_capped(out_buf, cap, ": ");
             append_capped(out_buf, cap, formatted);
         }
@@ -1524,18 +2885,45 @@ struct menu_runtime_t {
 
     inline bool push(void const *child_ptr, menu_ops_t const *child_ops) {
         if (!child_ptr) { return false; }
-        if (!child_ops || !child_ops->count) { return false; }
-        if (depth + 1 >= MENU_MAX_STACK) { return false; }
+        if (!child_ops || !menu_ops_fn(&child_ops->count)) { return false; }
+        if (depth + 1 >= levels) { return false; }
         editing = 0;
         edit_original = 0;
+#if MENU_COMPACT_STACK
+        frames[depth].selected = current.selected;
+        frames[depth].top = current.top;
+        depth++; current.menu_ptr = child_ptr; current.ops = child_ops; current.selected = 0; current.top = 0;
+        current_depth = depth; dirty = 1; return true;
+#else
         depth++; stack[depth].menu_ptr = child_ptr; stack[depth].ops = child_ops; stack[depth].selected = 0; stack[depth].top = 0; dirty = 1; return true;
+#endif
     }
     inline bool pop(void) {
         if (depth == 0) { return false; }
         editing = 0;
         edit_original = 0;
-        depth--; dirty = 1; return true;
+        depth--;
+#if MENU_COMPACT_STACK
+        current = derive_level(depth);
+        current_depth = depth;
+#endif
+        dirty = 1; return true;
     }
+#if MENU_COMPACT_STACK
+    /* Walks from the root through the selected child of each level above. */
+    inline menu_cursor_t derive_level(uint8_t level) const {
+        menu_cursor_t cur = { root_ptr, root_ops, frames[0].selected, frames[0].top };
+        for (uint8_t i = 0; i < level; ++i) {
+            void const *child_ptr = 0; menu_ops_t const *child_ops = 0;
+            if (!menu_child_at(cur, frames[i].selected, &child_ptr, &child_ops)) { break; }
+            cur.menu_ptr = child_ptr;
+            cur.ops = child_ops;
+            cur.selected = frames[i + 1].selected;
+            cur.top = frames[i + 1].top;
+        }
+        return cur;
+    }
+#endif
 
     void render(menu_cursor_t const &cur) {
         menu_cursor_t view = cur;
@@ -1543,25 +2931,44 @@ struct menu_runtime_t {
         uint8_t const visible_total = visible_count(view, total);
         clamp_menu_view(view, total, visible_total, item_window_height(visible_total));
         display_clear(display);
+#if MENU_RENDER_ARENA
+        char *const line = scratch;
+#else
+        char line[MENU_MAX_LINE];
+#endif
         uint8_t row = 0;
         if (title_rows(visible_total)) {
-            char line[MENU_MAX_LINE]; format_title(view, line);
+            format_title(view, line);
             menu_render_line_t render_line = { row, 255, MENU_RENDER_TITLE, 0, static_cast<uint8_t>(depth > 0 ? MENU_RENDER_BACK_AVAILABLE : 0), line };
             display_render_line(display, render_line);
             ++row;
         }
         uint8_t const visible = min_u8(item_window_height(visible_total), visible_total);
+        uint32_t modified = 0;      /* modified_rows() for items modified_from .. modified_from + 31 */
+        uint8_t modified_from = 0;
+        bool modified_known = false;
         for (uint8_t i = 0; i < visible; ++i) {
             uint16_t item_pos = static_cast<uint16_t>(view.top) + static_cast<uint16_t>(i);
             if (item_pos >= visible_total) { break; }
             uint8_t item_idx = 0;
             if (!visible_to_raw(view, total, static_cast<uint8_t>(item_pos), &item_idx)) { break; }
-            char line[MENU_MAX_LINE]; format_line(view, item_idx, line);
+            format_line(view, item_idx, line);
             uint8_t flags = 0;
             if (item_idx == view.selected && !menu_disabled(view, item_idx)) { flags = MENU_RENDER_SELECTED; }
             if (editing && item_idx == view.selected) { flags = static_cast<uint8_t>(flags | MENU_RENDER_EDITING); }
             if (menu_disabled(view, item_idx)) { flags = static_cast<uint8_t>(flags | MENU_RENDER_DISABLED); }
             if (menu_type_at(view, item_idx) == ENTRY_MENU) { flags = static_cast<uint8_t>(flags | MENU_RENDER_HAS_CHILD); }
+            if (show_modified) {
+                if (!modified_known || item_idx - modified_from >= 32) {
+                    modified_from = item_idx;
+                    modified = modified_rows(view, item_idx);
+                    modified_known = true;
+                }
+                if ((modified >> (item_idx - modified_from)) & 1U) {
+                    flags = static_cast<uint8_t>(flags | MENU_RENDER_MODIFIED);
+                    append_capped(line, effective_line_capacity(display), " *");
+                }
+            }
             if (i == 0 && view.top > 0) { flags = static_cast<uint8_t>(flags | MENU_RENDER_SCROLL_UP); }
             if (i == static_cast<uint8_t>(visible - 1) && static_cast<uint16_t>(view.top) + visible < visible_total) { flags = static_cast<uint8_t>(flags | MENU_RENDER_SCROLL_DOWN); }
             menu_render_line_t render_line = {
@@ -1590,6 +2997,103 @@ struct menu_runtime_t {
         save_persistence();
     }
 
+    inline bool is_editing(menu_cursor_t const &cur, uint8_t idx) const {
+        return editing && depth < levels &&
+               top().menu_ptr == cur.menu_ptr && top().selected == idx;
+    }
+
+    /* Ends an in-progress integer edit and restores the value it started from. */
+    inline void cancel_edit(void) {
+        if (!editing) { return; }
+        if (depth < levels) {
+            menu_cursor_t const &cur = top();
+            if (menu_int_has(cur, cur.selected)) { menu_int_set(cur, cur.selected, edit_original); }
+        }
+        editing = 0;
+        edit_original = 0;
+        dirty = 1;
+    }
+
+    /* Validated write from project, remote, or automation code; runs the same change and
+       persistence hooks as an interactive edit. Returns a menu_value_status_t. */
+    inline uint8_t set_value(menu_cursor_t const &cur, uint8_t idx, long value) {
+        uint8_t const status = menu_value_check(cur, idx, value);
+        if (status != MENU_VALUE_OK) { return status; }
+        if (is_editing(cur, idx)) { cancel_edit(); }
+        if (menu_value_store(cur, idx, value)) {
+            notify_value_change(cur, idx);
+            dirty = 1;
+        }
+        return MENU_VALUE_OK;
+    }
+
+    /* ---------- path API ---------- */
+    /* Paths name items by label from the root, e.g. "Settings/Motor/Max Speed". Each segment
+       must match a label exactly; hidden and disabled items are still found. */
+    static inline bool label_matches(menu_text_t label, char const *seg, char const *seg_end) {
+        uint8_t i = 0;
+        for (; seg + i < seg_end; ++i) {
+            if (i >= MENU_MAX_LINE || menu_text_char_at(label, i) != seg[i]) { return false; }
+        }
+        return menu_text_char_at(label, i) == '\0';
+    }
+    inline bool find_path(char const *path, menu_cursor_t &cur, uint8_t &idx) const {
+        menu_cursor_t level = root();
+        if (!path || !menu_cursor_valid(level)) { return false; }
+        while (*path == '/') { ++path; }
+        if (!*path) { return false; }
+        for (uint8_t d = 0;;) {
+            char const *end = path;
+            while (*end && *end != '/') { ++end; }
+            uint8_t const total = menu_count(level);
+            uint8_t found = 0;
+            while (found < total && !label_matches(menu_label_at(level, found), path, end)) { ++found; }
+            if (found >= total) { return false; }
+            if (!*end || !end[1]) {
+                cur = level;
+                idx = found;
+                return true;
+            }
+            menu_cursor_t child = { 0, 0, 0, 0 };
+            if (++d >= levels || menu_type_at(level, found) != ENTRY_MENU ||
+                !menu_child_at(level, found, &child.menu_ptr, &child.ops) || !menu_cursor_valid(child)) {
+                return false;
+            }
+            level = child;
+            path = end + 1;
+        }
+    }
+    /* Menu named by path ("" or "/" is the root), for iterating its children with menu_count(),
+       menu_label_at(), and the other cursor helpers. */
+    inline bool open_path(char const *path, menu_cursor_t &menu) const {
+        menu_cursor_t root = this->root();
+        if (!path || !menu_cursor_valid(root)) { return false; }
+        while (*path == '/') { ++path; }
+        if (!*path) { menu = root; return true; }
+        menu_cursor_t parent = { 0, 0, 0, 0 };
+        uint8_t idx = 0;
+        menu_cursor_t child = { 0, 0, 0, 0 };
+        if (!find_path(path, parent, idx) || menu_type_at(parent, idx) != ENTRY_MENU ||
+            !menu_child_at(parent, idx, &child.menu_ptr, &child.ops) || !menu_cursor_valid(child)) {
+            return false;
+        }
+        menu = child;
+        return true;
+    }
+    /* Returns a menu_value_status_t; out follows menu_value_read(). */
+    inline uint8_t get_path(char const *path, long *out) const {
+        menu_cursor_t cur = { 0, 0, 0, 0 };
+        uint8_t idx = 0;
+        if (!find_path(path, cur, idx)) { return MENU_VALUE_NOT_FOUND; }
+        return menu_value_read(cur, idx, out) ? MENU_VALUE_OK : MENU_VALUE_READ_ONLY;
+    }
+    inline uint8_t set_path(char const *path, long value) {
+        menu_cursor_t cur = { 0, 0, 0, 0 };
+        uint8_t idx = 0;
+        if (!find_path(path, cur, idx)) { return MENU_VALUE_NOT_FOUND; }
+        return set_value(cur, idx, value);
+    }
+
     inline void move_selection(menu_cursor_t &cur, uint8_t total, int8_t dir, uint8_t steps) {
         if (total == 0 || steps == 0) { return; }
         uint8_t next = cur.selected;
@@ -1656,9 +3160,9 @@ struct menu_runtime_t {
     /* ============================ Non-Blocking ============================ */
     void service(void) {
         if (!initialized) { begin(); }
-        if (depth >= MENU_MAX_STACK) { reset_navigation(); }
-        if (depth > 0 && !menu_cursor_valid(stack[depth])) { reset_navigation(); }
-        menu_cursor_t &cur = stack[depth];
+        if (depth >= levels) { reset_navigation(); }
+        if (depth > 0 && !top_valid()) { reset_navigation(); }
+        menu_cursor_t &cur = top();
         uint8_t const total = menu_count(cur);
         uint8_t const visible_total = visible_count(cur, total);
         uint8_t const selected_before_clamp = cur.selected;
@@ -1680,29 +3184,23 @@ struct menu_runtime_t {
 
         bool just_rendered = false;
         if (dirty) {
-            render(cur);
+            if (!headless) { render(cur); just_rendered = true; }
             dirty = 0;
-            just_rendered = true;
         }
 
         menu_event_t event = menu_event(Choice_Invalid);
 
+#if MENU_FEATURE_LEGACY_INPUT
         if (input_cb) {
             char const *prompt = editing ? "U/R=+  D/L=-  S=save  C=cancel"
                                          : "U/D=move  R/S=select  L/C=back";
             event.choice = input_cb(just_rendered ? prompt : "");
-        } else if (has_src && input_src.ops) {
-            if (input_src.ops->capture) { input_src.ops->capture(input_src.ctx); }
-            if (input_src.ops->read_event) { event = input_src.ops->read_event(input_src.ctx); }
-            if (event.choice == Choice_Invalid && input_src.ops->read) { event.choice = input_src.ops->read(input_src.ctx); }
-            if (event.choice == Choice_Invalid) {
-                if      (input_src.ops->up     && input_src.ops->up(input_src.ctx))       { event.choice = Choice_Up; }
-                else if (input_src.ops->down   && input_src.ops->down(input_src.ctx))     { event.choice = Choice_Down; }
-                else if (input_src.ops->select && input_src.ops->select(input_src.ctx))   { event.choice = Choice_Select; }
-                else if (input_src.ops->cancel && input_src.ops->cancel(input_src.ctx))   { event.choice = Choice_Cancel; }
-                else if (input_src.ops->left   && input_src.ops->left(input_src.ctx))     { event.choice = Choice_Left; }
-                else if (input_src.ops->right  && input_src.ops->right(input_src.ctx))    { event.choice = Choice_Right; }
-            }
+        } else
+#else
+        (void)just_rendered;
+#endif
+        if (has_src) {
+            event = input_read(input_src);
         }
 
         if (event.choice == Choice_Invalid) { return; }
@@ -1725,6 +3223,7 @@ struct menu_runtime_t {
                     int next = step_down_int(v, step, mn);
                     if (next != v) { menu_int_set(cur, cur.selected, next); dirty = 1; }
                 } break;
+#if MENU_FEATURE_POINTER_EVENTS
                 case Choice_Delta: {
                     int next = v;
                     int8_t delta = event.delta;
@@ -1732,17 +3231,19 @@ struct menu_runtime_t {
                     while (delta < 0) { next = step_down_int(next, step, mn); ++delta; }
                     if (next != v) { menu_int_set(cur, cur.selected, next); dirty = 1; }
                 } break;
+#endif
                 case Choice_Select:
                     if (menu_int_get(cur, cur.selected) != edit_original) { notify_value_change(cur, cur.selected); }
                     editing = 0;
                     dirty = 1;
                     break;
-                case Choice_Cancel: menu_int_set(cur, cur.selected, edit_original); editing = 0; dirty = 1; break;
+                case Choice_Cancel: cancel_edit(); break;
                 default: break;
             }
             return;
         }
 
+#if MENU_FEATURE_POINTER_EVENTS
         if (event.choice == Choice_Row) {
             if (select_display_row(cur, total, visible_total, event.row) && (event.flags & MENU_EVENT_ACTIVATE)) {
                 activate_current(cur, total);
@@ -1756,6 +3257,7 @@ struct menu_runtime_t {
             else if (delta < 0) { move_selection(cur, total, -1, static_cast<uint8_t>(-delta)); }
             return;
         }
+#endif
 
         switch (event.choice) {
             case Choice_Up:
@@ -1788,6 +3290,1636 @@ struct menu_runtime_t {
     }
 };
 
+/* The type-erased runtime with a cursor stack of Levels open menus. */
+template<uint8_t Levels>
+using menu_sized_runtime_t = basic_menu_runtime_t<display_t, input_source_t, menu_runtime_config<Levels> >;
+
+typedef menu_sized_runtime_t<MENU_MAX_STACK> menu_runtime_t;
+
+/* Runtime whose cursor stack holds exactly the levels Tree declares:
+     static menu_runtime_for<decltype(rootMenu)>::type runtime =
+         menu_runtime_for<decltype(rootMenu)>::type::make(rootMenu, display, input, true);
+   Display and Input default to the type-erased adapters. */
+template<typename Tree, typename Display = display_t, typename Input = input_source_t>
+struct menu_runtime_for {
+    typedef basic_menu_runtime_t<Display, Input, menu_runtime_config<menu_tree_depth<Tree>::value> > type;
+};
+
+/* ============================== Tree Walking ============================= */
+/* Pre-order walk over every reachable item. The walk position doubles as a compact item id:
+   0 is the first root item, a MENU row is followed by its children, and ids stay stable as long
+   as the declaration order does not change. ITEM_LIST rows are leaves: their pages come from
+   run-time callbacks, so walking into them would shift every id after the list. An iterator
+   visits as many levels as its Levels, so the one a runtime uses internally (tree_iter_t)
+   reaches everything that runtime can navigate to. The byte-stream adapters walk with the
+   tree_iter_t of the runtime they are given; menu_tree_iter_t stops at MENU_MAX_STACK levels. */
+
+template<uint8_t Levels>
+static inline bool menu_tree_begin(basic_menu_tree_iter_t<Levels> &it, void const *root_ptr, menu_ops_t const *root_ops) {
+    menu_cursor_t root = { root_ptr, root_ops, 0, 0 };
+    it.path[0] = root;
+    it.depth = 0;
+    it.id = 0;
+    it.valid = menu_runtime_t::menu_count(root) ? 1 : 0;
+    return it.valid != 0;
+}
+
+template<uint8_t Levels>
+static inline bool menu_tree_next(basic_menu_tree_iter_t<Levels> &it) {
+    if (!it.valid) { return false; }
+    menu_cursor_t const &cur = it.path[it.depth];
+    if (it.depth + 1 < Levels && menu_runtime_t::menu_type_at(cur, cur.selected) == ENTRY_MENU) {
+        menu_cursor_t child = { 0, 0, 0, 0 };
+        if (menu_runtime_t::menu_child_at(cur, cur.selected, &child.menu_ptr, &child.ops) &&
+            !menu_ops_is_list(child.ops) && menu_runtime_t::menu_count(child)) {
+            it.path[++it.depth] = child;
+            ++it.id;
+            return true;
+        }
+    }
+    for (;;) {
+        menu_cursor_t &level = it.path[it.depth];
+        if (static_cast<uint16_t>(level.selected) + 1U < menu_runtime_t::menu_count(level)) {
+            ++level.selected;
+            ++it.id;
+            return true;
+        }
+        if (it.depth == 0) { it.valid = 0; return false; }
+        --it.depth;
+    }
+}
+
+/* Moves to item id, restarting from the root only when id is behind the current position,
+   so ascending lookups cost one walk in total. */
+template<uint8_t Levels>
+static inline bool menu_tree_seek(basic_menu_tree_iter_t<Levels> &it, void const *root_ptr, menu_ops_t const *root_ops, uint16_t id) {
+    if (!it.valid || it.id > id || it.path[0].menu_ptr != root_ptr) {
+        if (!menu_tree_begin(it, root_ptr, root_ops)) { return false; }
+    }
+    while (it.id < id) {
+        if (!menu_tree_next(it)) { return false; }
+    }
+    return true;
+}
+
+template<uint8_t Levels>
+static inline menu_cursor_t const &menu_tree_cursor(basic_menu_tree_iter_t<Levels> const &it) { return it.path[it.depth]; }
+template<uint8_t Levels>
+static inline uint8_t menu_tree_index(basic_menu_tree_iter_t<Levels> const &it) { return it.path[it.depth].selected; }
+
+/* ============================ Factory Defaults =========================== */
+/* An item's default is its ITEM_DEFAULT value when declared, otherwise the entry for its id in
+   the table given to set_defaults(), filled by capture_defaults(). Values follow the same
+   convention as menu_value_read(). Items without a default are never reset or marked modified. */
+
+template<typename Display, typename Input, typename Config>
+inline bool basic_menu_runtime_t<Display, Input, Config>::default_value(menu_cursor_t const &cur, uint8_t idx, uint16_t id, long *out) const {
+    int value = 0;
+    if (menu_default_at(cur, idx, &value)) {
+        if (out) { *out = value; }
+        return true;
+    }
+    if (!defaults.values || id >= defaults.count || !menu_value_read(cur, idx, 0)) { return false; }
+    if (out) { *out = defaults.values[id]; }
+    return true;
+}
+
+template<typename Display, typename Input, typename Config>
+inline void basic_menu_runtime_t<Display, Input, Config>::capture_defaults(void) {
+    if (!defaults.values) { return; }
+    tree_iter_t it;
+    bool more = menu_tree_begin(it, root().menu_ptr, root().ops);
+    while (more && it.id < defaults.count) {
+        long value = 0;
+        if (menu_value_read(menu_tree_cursor(it), menu_tree_index(it), &value)) { defaults.values[it.id] = static_cast<int>(value); }
+        more = menu_tree_next(it);
+    }
+}
+
+template<typename Display, typename Input, typename Config>
+inline bool basic_menu_runtime_t<Display, Input, Config>::restore_item(menu_cursor_t const &cur, uint8_t idx, uint16_t id) {
+    long value = 0;
+    if (!default_value(cur, idx, id, &value) || menu_value_check(cur, idx, value) != MENU_VALUE_OK) { return false; }
+    if (is_editing(cur, idx)) { cancel_edit(); }
+    if (!menu_value_store(cur, idx, value)) { return false; }
+    menu_on_change(cur, idx);
+    return true;
+}
+
+/* Resets every item in the tree, then saves and redraws once if anything changed. */
+template<typename Display, typename Input, typename Config>
+inline void basic_menu_runtime_t<Display, Input, Config>::restore_defaults(void) {
+    tree_iter_t it;
+    bool changed = false;
+    bool more = menu_tree_begin(it, root().menu_ptr, root().ops);
+    while (more) {
+        if (restore_item(menu_tree_cursor(it), menu_tree_index(it), it.id)) { changed = true; }
+        more = menu_tree_next(it);
+    }
+    if (changed) { save_persistence(); dirty = 1; }
+}
+
+/* Resets item id, or every item below it when id is a MENU row. Returns false for unknown ids. */
+template<typename Display, typename Input, typename Config>
+inline bool basic_menu_runtime_t<Display, Input, Config>::restore_defaults(uint16_t id) {
+    tree_iter_t it;
+    it.valid = 0;
+    if (!menu_tree_seek(it, root().menu_ptr, root().ops, id)) { return false; }
+    uint8_t const level = it.depth;
+    bool changed = false;
+    do {
+        if (restore_item(menu_tree_cursor(it), menu_tree_index(it), it.id)) { changed = true; }
+    } while (menu_tree_next(it) && it.depth > level);
+    if (changed) { save_persistence(); dirty = 1; }
+    return true;
+}
+
+template<typename Display, typename Input, typename Config>
+inline bool basic_menu_runtime_t<Display, Input, Config>::is_modified(uint16_t id) const {
+    tree_iter_t it;
+    it.valid = 0;
+    if (!menu_tree_seek(it, root().menu_ptr, root().ops, id)) { return false; }
+    long value = 0;
+    long original = 0;
+    return default_value(menu_tree_cursor(it), menu_tree_index(it), it.id, &original) &&
+           menu_value_read(menu_tree_cursor(it), menu_tree_index(it), &value) && value != original;
+}
+
+/* Render helper: bit i is set when item first_idx + i of view differs from its default. One
+   walk to the end of the window keeps its iterator off render()'s frame, and only runs when
+   the modified marker is on. List pages are not part of the walk and never match. */
+template<typename Display, typename Input, typename Config>
+inline uint32_t basic_menu_runtime_t<Display, Input, Config>::modified_rows(menu_cursor_t const &view, uint8_t first_idx) const {
+    if (menu_ops_is_list(view.ops)) { return 0; }
+    tree_iter_t it;
+    bool more = menu_tree_begin(it, root().menu_ptr, root().ops);
+    while (more && (menu_tree_cursor(it).menu_ptr != view.menu_ptr || menu_tree_index(it) < first_idx)) {
+        more = menu_tree_next(it);
+    }
+    uint32_t mask = 0;
+    uint8_t const level = it.depth;
+    while (more && it.depth >= level) {
+        uint8_t const idx = menu_tree_index(it);
+        if (it.depth == level) {
+            if (idx - first_idx >= 32) { break; }
+            long value = 0;
+            long original = 0;
+            if (default_value(view, idx, it.id, &original) && menu_value_read(view, idx, &value) && value != original) {
+                mask |= static_cast<uint32_t>(1) << (idx - first_idx);
+            }
+        }
+        more = menu_tree_next(it);
+    }
+    return mask;
+}
+
+/* ============================== Byte Streams ============================= */
+/* Minimal non-blocking byte transport used by the framed protocols below.
+   read returns -1 when no byte is waiting. */
+
+struct menu_byte_io_ops_t {
+    int  (*read)(void *ctx);                                      /* optional for write-only sinks */
+    void (*write)(void *ctx, uint8_t const *data, uint16_t len);  /* optional for read-only sources */
+};
+
+struct menu_byte_io_t {
+    void *ctx;
+    menu_byte_io_ops_t const *ops;
+};
+
+static inline menu_byte_io_t make_byte_io(void *ctx, menu_byte_io_ops_t const *ops) {
+    menu_byte_io_t io = { ctx, ops };
+    return io;
+}
+
+static inline int menu_byte_io_read(menu_byte_io_t const &io) {
+    return (io.ops && io.ops->read) ? io.ops->read(io.ctx) : -1;
+}
+
+static inline void menu_byte_io_write(menu_byte_io_t const &io, uint8_t const *data, uint16_t len) {
+    if (io.ops && io.ops->write && data && len) { io.ops->write(io.ctx, data, len); }
+}
+
+#ifdef ARDUINO
+static int stream_byte_io_read(void *ctx) {
+    Stream *stream = static_cast<Stream *>(ctx);
+    return (stream && stream->available() > 0) ? stream->read() : -1;
+}
+static void stream_byte_io_write(void *ctx, uint8_t const *data, uint16_t len) {
+    Stream *stream = static_cast<Stream *>(ctx);
+    if (stream) { stream->write(data, len); }
+}
+static menu_byte_io_ops_t const STREAM_BYTE_IO_OPS = {
+    &stream_byte_io_read, &stream_byte_io_write
+};
+static inline menu_byte_io_t make_stream_byte_io(Stream &stream) {
+    return make_byte_io(&stream, &STREAM_BYTE_IO_OPS);
+}
+static void print_byte_io_write(void *ctx, uint8_t const *data, uint16_t len) {
+    Print *out = static_cast<Print *>(ctx);
+    if (out) { out->write(data, len); }
+}
+static menu_byte_io_ops_t const PRINT_BYTE_IO_OPS = {
+    0, &print_byte_io_write
+};
+/* Write-only sink for output-only protocols such as JSON streaming. */
+static inline menu_byte_io_t make_print_byte_io(Print &out) {
+    return make_byte_io(&out, &PRINT_BYTE_IO_OPS);
+}
+#endif
+
+/* ================================ Framing ================================ */
+/* Frame: A5 5A | type | length (LE u16) | payload | CRC-16/CCITT-FALSE (LE u16).
+   The CRC covers type, length, and payload. Bytes outside a frame are skipped. */
+
+enum {
+    MENU_FRAME_SYNC0 = 0xA5,
+    MENU_FRAME_SYNC1 = 0x5A
+};
+
+enum menu_frame_result_t {
+    MENU_FRAME_PENDING  = 0,
+    MENU_FRAME_READY    = 1,
+    MENU_FRAME_BAD_CRC  = 2,
+    MENU_FRAME_OVERFLOW = 3
+};
+
+static inline uint16_t menu_crc16_update(uint16_t crc, uint8_t byte) {
+    crc = static_cast<uint16_t>(crc ^ (static_cast<uint16_t>(byte) << 8));
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+        crc = (crc & 0x8000U) ? static_cast<uint16_t>((crc << 1) ^ 0x1021U) : static_cast<uint16_t>(crc << 1);
+    }
+    return crc;
+}
+
+/* Receive side: the payload buffer is caller-owned. */
+struct menu_frame_reader_t {
+    uint8_t  *buffer;
+    uint16_t  capacity;
+    uint16_t  length;
+    uint16_t  pos;
+    uint16_t  crc;
+    uint16_t  rx_crc;
+    uint8_t   type;
+    uint8_t   state;
+};
+
+static inline void menu_frame_reader_init(menu_frame_reader_t &r, uint8_t *buffer, uint16_t capacity) {
+    r.buffer = buffer;
+    r.capacity = buffer ? capacity : 0;
+    r.length = 0;
+    r.pos = 0;
+    r.crc = 0xFFFFU;
+    r.rx_crc = 0;
+    r.type = 0;
+    r.state = 0;
+}
+
+/* Feeds one byte; returns a menu_frame_result_t. Oversized frames are consumed and reported as
+   MENU_FRAME_OVERFLOW so the reader stays in sync with the sender. */
+static inline uint8_t menu_frame_feed(menu_frame_reader_t &r, uint8_t byte) {
+    switch (r.state) {
+        case 0: if (byte == MENU_FRAME_SYNC0) { r.state = 1; } return MENU_FRAME_PENDING;
+        case 1:
+            if (byte == MENU_FRAME_SYNC1) { r.state = 2; r.crc = 0xFFFFU; }
+            else if (byte != MENU_FRAME_SYNC0) { r.state = 0; }
+            return MENU_FRAME_PENDING;
+        case 2: r.type = byte; r.crc = menu_crc16_update(r.crc, byte); r.state = 3; return MENU_FRAME_PENDING;
+        case 3: r.length = byte; r.crc = menu_crc16_update(r.crc, byte); r.state = 4; return MENU_FRAME_PENDING;
+        case 4:
+            r.length = static_cast<uint16_t>(r.length | (static_cast<uint16_t>(byte) << 8));
+            r.crc = menu_crc16_update(r.crc, byte);
+            r.pos = 0;
+            r.state = r.length ? 5 : 6;
+            return MENU_FRAME_PENDING;
+        case 5:
+            if (r.pos < r.capacity) { r.buffer[r.pos] = byte; }
+            r.crc = menu_crc16_update(r.crc, byte);
+            if (++r.pos >= r.length) { r.state = 6; }
+            return MENU_FRAME_PENDING;
+        case 6: r.rx_crc = byte; r.state = 7; return MENU_FRAME_PENDING;
+        default:
+            r.rx_crc = static_cast<uint16_t>(r.rx_crc | (static_cast<uint16_t>(byte) << 8));
+            r.state = 0;
+            if (r.rx_crc != r.crc) { return MENU_FRAME_BAD_CRC; }
+            return (r.length > r.capacity) ? MENU_FRAME_OVERFLOW : MENU_FRAME_READY;
+    }
+}
+
+/* Send side: streams straight to the transport with a running CRC, so no frame buffer. */
+struct menu_frame_writer_t {
+    menu_byte_io_t io;
+    uint16_t       crc;
+};
+
+static inline void menu_frame_put(menu_frame_writer_t &w, uint8_t const *data, uint16_t len) {
+    for (uint16_t i = 0; i < len; ++i) { w.crc = menu_crc16_update(w.crc, data[i]); }
+    menu_byte_io_write(w.io, data, len);
+}
+static inline void menu_frame_put_u8(menu_frame_writer_t &w, uint8_t value) {
+    menu_frame_put(w, &value, 1);
+}
+static inline void menu_frame_put_u16(menu_frame_writer_t &w, uint16_t value) {
+    uint8_t bytes[2] = { static_cast<uint8_t>(value & 0xFFU), static_cast<uint8_t>(value >> 8) };
+    menu_frame_put(w, bytes, 2);
+}
+static inline void menu_frame_put_i32(menu_frame_writer_t &w, long value) {
+    uint32_t const v = static_cast<uint32_t>(value);
+    uint8_t bytes[4] = {
+        static_cast<uint8_t>(v & 0xFFU), static_cast<uint8_t>((v >> 8) & 0xFFU),
+        static_cast<uint8_t>((v >> 16) & 0xFFU), static_cast<uint8_t>((v >> 24) & 0xFFU)
+    };
+    menu_frame_put(w, bytes, 4);
+}
+static inline void menu_frame_begin(menu_frame_writer_t &w, menu_byte_io_t const &io, uint8_t type, uint16_t length) {
+    uint8_t const sync[2] = { MENU_FRAME_SYNC0, MENU_FRAME_SYNC1 };
+    w.io = io;
+    menu_byte_io_write(io, sync, 2);
+    w.crc = 0xFFFFU;
+    menu_frame_put_u8(w, type);
+    menu_frame_put_u16(w, length);
+}
+static inline void menu_frame_end(menu_frame_writer_t &w) {
+    uint8_t const bytes[2] = { static_cast<uint8_t>(w.crc & 0xFFU), static_cast<uint8_t>(w.crc >> 8) };
+    menu_byte_io_write(w.io, bytes, 2);
+}
+
+static inline uint16_t menu_frame_get_u16(uint8_t const *p) {
+    return static_cast<uint16_t>(p[0] | (static_cast<uint16_t>(p[1]) << 8));
+}
+static inline long menu_frame_get_i32(uint8_t const *p) {
+    uint32_t const v = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                       (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    return static_cast<long>(static_cast<int32_t>(v));
+}
+
+/* =========================== Bulk Provisioning =========================== */
+/* One PROVISION frame carries (item id u16, value i32) records, all little-endian. Every record
+   is validated against its item's range before any value is written; the batch then applies with
+   per-item change hooks, one persistence save, and one redraw. A STATUS frame answers each
+   request: status u8, applied record count u16, failing record index u16, failing item id u16. */
+
+enum {
+    MENU_FRAME_PROVISION        = 'P',
+    MENU_FRAME_PROVISION_STATUS = 'p',
+    MENU_PROVISION_RECORD_SIZE  = 6
+};
+
+enum menu_provision_status_t {
+    MENU_PROVISION_OK           = 0,
+    MENU_PROVISION_BAD_CRC      = 1,
+    MENU_PROVISION_TOO_LARGE    = 2,
+    MENU_PROVISION_MALFORMED    = 3,
+    MENU_PROVISION_UNKNOWN_ITEM = 4,
+    MENU_PROVISION_READ_ONLY    = 5,
+    MENU_PROVISION_OUT_OF_RANGE = 6
+};
+
+template<typename Runtime>
+struct basic_menu_provision_t {
+    Runtime            *runtime;
+    menu_byte_io_t      io;
+    menu_frame_reader_t reader;
+
+    /* Reads whatever bytes are waiting and handles at most one complete frame. */
+    void service(void) {
+        if (!runtime) { return; }
+        for (;;) {
+            int const ch = menu_byte_io_read(io);
+            if (ch < 0) { return; }
+            uint8_t const result = menu_frame_feed(reader, static_cast<uint8_t>(ch));
+            if (result == MENU_FRAME_PENDING) { continue; }
+            if (result == MENU_FRAME_BAD_CRC) { reply(MENU_PROVISION_BAD_CRC, 0, 0xFFFFU, 0xFFFFU); return; }
+            if (reader.type != MENU_FRAME_PROVISION) { continue; }
+            if (result == MENU_FRAME_OVERFLOW) { reply(MENU_PROVISION_TOO_LARGE, 0, 0xFFFFU, 0xFFFFU); return; }
+            apply(reader.buffer, reader.length);
+            return;
+        }
+    }
+
+    void apply(uint8_t const *payload, uint16_t length) {
+        if (length % MENU_PROVISION_RECORD_SIZE) { reply(MENU_PROVISION_MALFORMED, 0, 0xFFFFU, 0xFFFFU); return; }
+        uint16_t const count = static_cast<uint16_t>(length / MENU_PROVISION_RECORD_SIZE);
+        void const *root_ptr = runtime->root().menu_ptr;
+        menu_ops_t const *root_ops = runtime->root().ops;
+        typename Runtime::tree_iter_t it;
+        it.valid = 0;
+        for (uint16_t i = 0; i < count; ++i) {
+            uint8_t const *record = payload + static_cast<uint16_t>(i * MENU_PROVISION_RECORD_SIZE);
+            uint16_t const id = menu_frame_get_u16(record);
+            uint8_t status = MENU_VALUE_NOT_FOUND;
+            if (menu_tree_seek(it, root_ptr, root_ops, id)) {
+                status = menu_runtime_t::menu_value_check(menu_tree_cursor(it), menu_tree_index(it), menu_frame_get_i32(record + 2));
+            }
+            if (status != MENU_VALUE_OK) {
+                uint8_t const code = (status == MENU_VALUE_NOT_FOUND) ? MENU_PROVISION_UNKNOWN_ITEM :
+                                     (status == MENU_VALUE_READ_ONLY) ? MENU_PROVISION_READ_ONLY : MENU_PROVISION_OUT_OF_RANGE;
+                reply(code, 0, i, id);
+                return;
+            }
+        }
+        bool changed = false;
+        for (uint16_t i = 0; i < count; ++i) {
+            uint8_t const *record = payload + static_cast<uint16_t>(i * MENU_PROVISION_RECORD_SIZE);
+            if (!menu_tree_seek(it, root_ptr, root_ops, menu_frame_get_u16(record))) { continue; }
+            menu_cursor_t const &cur = menu_tree_cursor(it);
+            uint8_t const idx = menu_tree_index(it);
+            if (runtime->is_editing(cur, idx)) { runtime->cancel_edit(); }
+            if (menu_runtime_t::menu_value_store(cur, idx, menu_frame_get_i32(record + 2))) {
+                menu_runtime_t::menu_on_change(cur, idx);
+                changed = true;
+            }
+        }
+        if (changed) {
+            runtime->save_persistence();
+            runtime->request_redraw();
+        }
+        reply(MENU_PROVISION_OK, count, 0xFFFFU, 0xFFFFU);
+    }
+
+    void reply(uint8_t status, uint16_t applied, uint16_t record, uint16_t id) {
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, MENU_FRAME_PROVISION_STATUS, 7);
+        menu_frame_put_u8(w, status);
+        menu_frame_put_u16(w, applied);
+        menu_frame_put_u16(w, record);
+        menu_frame_put_u16(w, id);
+        menu_frame_end(w);
+    }
+};
+typedef basic_menu_provision_t<menu_runtime_t> menu_provision_t;
+
+/* buffer holds one request payload: 6 bytes per record, so 600 bytes fits 100 values. */
+template<typename Runtime>
+static inline void menu_provision_begin(basic_menu_provision_t<Runtime> &p, Runtime &runtime, menu_byte_io_t io,
+                                        uint8_t *buffer, uint16_t capacity) {
+    p.runtime = &runtime;
+    p.io = io;
+    menu_frame_reader_init(p.reader, buffer, capacity);
+}
+
+/* ============================= Remote Control ============================ */
+/* Browse-and-edit protocol over the same frames. Items are addressed by index paths: a path
+   payload is a depth byte followed by one row index per level, so [2, 1, 0] is the first row of
+   the submenu on row 1 of the root. LIST names a menu (the empty path is the root); GET, SET,
+   ACTIVATE and WATCH name an item. Values use the menu_value_read() convention.
+
+     'L' path            -> one 'i' frame per row, then 'l' status u8, row count u8
+     'G' path            -> 'g' status u8, value i32
+     'S' path, value i32 -> 's' status u8, value i32 (value after the write)
+     'A' path            -> 'a' status u8
+     'W' path            -> 'w' status u8, slot u8; later 'n' slot u8, value i32 on each change
+     'U' slot u8         -> 'u' status u8 (slot 0xFF clears every watch)
+     'P' records         -> 'p' as in Bulk Provisioning
+
+   An 'i' row frame carries index u8, entry type u8, flags u8, value i32, min i32, max i32,
+   step i32, label (length u8 + bytes), choice count u8, then each choice label. Frames that fail
+   their CRC or overflow the buffer are answered with 'e' status u8. List rows are sent one per
+   service() call so a long menu never stalls the sketch. */
+
+enum {
+    MENU_FRAME_LIST           = 'L',
+    MENU_FRAME_LIST_ROW       = 'i',
+    MENU_FRAME_LIST_END       = 'l',
+    MENU_FRAME_GET            = 'G',
+    MENU_FRAME_GET_REPLY      = 'g',
+    MENU_FRAME_SET            = 'S',
+    MENU_FRAME_SET_REPLY      = 's',
+    MENU_FRAME_ACTIVATE       = 'A',
+    MENU_FRAME_ACTIVATE_REPLY = 'a',
+    MENU_FRAME_WATCH          = 'W',
+    MENU_FRAME_WATCH_REPLY    = 'w',
+    MENU_FRAME_UNWATCH        = 'U',
+    MENU_FRAME_UNWATCH_REPLY  = 'u',
+    MENU_FRAME_NOTIFY         = 'n',
+    MENU_FRAME_ERROR          = 'e'
+};
+
+/* Shares numbering with menu_provision_status_t. */
+enum menu_remote_status_t {
+    MENU_REMOTE_OK           = 0,
+    MENU_REMOTE_BAD_CRC      = 1,
+    MENU_REMOTE_TOO_LARGE    = 2,
+    MENU_REMOTE_MALFORMED    = 3,
+    MENU_REMOTE_NOT_FOUND    = 4,
+    MENU_REMOTE_READ_ONLY    = 5,
+    MENU_REMOTE_OUT_OF_RANGE = 6,
+    MENU_REMOTE_NOT_A_MENU   = 7,
+    MENU_REMOTE_NO_SLOT      = 8,
+    MENU_REMOTE_DISABLED     = 9
+};
+
+enum menu_remote_row_flags_t {
+    MENU_REMOTE_ROW_HIDDEN    = 1 << 0,
+    MENU_REMOTE_ROW_DISABLED  = 1 << 1,
+    MENU_REMOTE_ROW_READABLE  = 1 << 2,
+    MENU_REMOTE_ROW_WRITABLE  = 1 << 3,
+    MENU_REMOTE_ROW_HAS_CHILD = 1 << 4
+};
+
+/* Follows depth row indices from the root through MENU rows; out is the menu reached. Paths
+   stop at levels, the cursor levels of the runtime they are resolved for. */
+static inline bool menu_path_resolve(void const *root_ptr, menu_ops_t const *root_ops,
+                                     uint8_t const *indices, uint8_t depth, menu_cursor_t &out,
+                                     uint8_t levels = MENU_MAX_STACK) {
+    menu_cursor_t cur = { root_ptr, root_ops, 0, 0 };
+    if (!menu_runtime_t::menu_cursor_valid(cur) || depth >= levels) { return false; }
+    for (uint8_t level = 0; level < depth; ++level) {
+        uint8_t const idx = indices[level];
+        menu_cursor_t child = { 0, 0, 0, 0 };
+        if (idx >= menu_runtime_t::menu_count(cur) || menu_runtime_t::menu_type_at(cur, idx) != ENTRY_MENU ||
+            !menu_runtime_t::menu_child_at(cur, idx, &child.menu_ptr, &child.ops) || !menu_runtime_t::menu_cursor_valid(child)) {
+            return false;
+        }
+        cur = child;
+    }
+    out = cur;
+    return true;
+}
+
+static inline uint8_t menu_text_length(menu_text_t text, uint8_t cap) {
+    uint8_t len = 0;
+    while (len < cap && menu_text_char_at(text, len)) { ++len; }
+    return len;
+}
+
+struct menu_remote_watch_t {
+    menu_cursor_t cur;
+    uint8_t       idx;
+    uint8_t       active;
+    long          last;
+};
+
+template<typename Runtime>
+struct basic_menu_remote_t {
+    Runtime             *runtime;
+    menu_byte_io_t       io;
+    menu_frame_reader_t  reader;
+    menu_remote_watch_t *watches;
+    uint8_t              watch_count;
+    menu_cursor_t        list;      /* selected is the next row to send */
+    uint8_t              listing;
+
+    /* Sends one pending list row, handles at most one request, then reports watched changes. */
+    void service(void) {
+        if (!runtime) { return; }
+        if (listing) { send_list_row(); }
+        for (;;) {
+            int const ch = menu_byte_io_read(io);
+            if (ch < 0) { break; }
+            uint8_t const result = menu_frame_feed(reader, static_cast<uint8_t>(ch));
+            if (result == MENU_FRAME_PENDING) { continue; }
+            if (result == MENU_FRAME_BAD_CRC) { reply_status(MENU_FRAME_ERROR, MENU_REMOTE_BAD_CRC); break; }
+            if (result == MENU_FRAME_OVERFLOW) { reply_status(MENU_FRAME_ERROR, MENU_REMOTE_TOO_LARGE); break; }
+            handle(reader.type, reader.buffer, reader.length);
+            break;
+        }
+        poll_watches();
+    }
+
+    bool resolve_item(uint8_t const *payload, uint16_t length, menu_cursor_t &cur, uint8_t &idx) {
+        if (length < 2 || payload[0] == 0 || length != static_cast<uint16_t>(payload[0] + 1U)) { return false; }
+        uint8_t const depth = static_cast<uint8_t>(payload[0] - 1);
+        if (!menu_path_resolve(runtime->root().menu_ptr, runtime->root().ops, payload + 1, depth, cur, Runtime::levels)) { return false; }
+        idx = payload[1 + depth];
+        return idx < menu_runtime_t::menu_count(cur);
+    }
+
+    void handle(uint8_t type, uint8_t const *payload, uint16_t length) {
+        menu_cursor_t cur = { 0, 0, 0, 0 };
+        uint8_t idx = 0;
+        long value = 0;
+        switch (type) {
+            case MENU_FRAME_LIST:
+                listing = 0;
+                if (!length || length != static_cast<uint16_t>(payload[0] + 1U)) { reply_list_end(MENU_REMOTE_MALFORMED, 0); return; }
+                if (!menu_path_resolve(runtime->root().menu_ptr, runtime->root().ops, payload + 1, payload[0], cur, Runtime::levels)) {
+                    reply_list_end(MENU_REMOTE_NOT_A_MENU, 0);
+                    return;
+                }
+                list = cur;
+                list.selected = 0;
+                listing = 1;
+                send_list_row();
+                return;
+            case MENU_FRAME_GET:
+                if (!resolve_item(payload, length, cur, idx)) { reply_value(MENU_FRAME_GET_REPLY, MENU_REMOTE_NOT_FOUND, 0); return; }
+                if (!menu_runtime_t::menu_value_read(cur, idx, &value)) { reply_value(MENU_FRAME_GET_REPLY, MENU_REMOTE_READ_ONLY, 0); return; }
+                reply_value(MENU_FRAME_GET_REPLY, MENU_REMOTE_OK, value);
+                return;
+            case MENU_FRAME_SET: {
+                if (length < 5) { reply_value(MENU_FRAME_SET_REPLY, MENU_REMOTE_MALFORMED, 0); return; }
+                if (!resolve_item(payload, static_cast<uint16_t>(length - 4), cur, idx)) { reply_value(MENU_FRAME_SET_REPLY, MENU_REMOTE_NOT_FOUND, 0); return; }
+                uint8_t status = menu_runtime_t::menu_disabled(cur, idx) ? static_cast<uint8_t>(MENU_REMOTE_DISABLED) :
+                                 runtime->set_value(cur, idx, menu_frame_get_i32(payload + length - 4));
+                menu_runtime_t::menu_value_read(cur, idx, &value);
+                if (status == MENU_VALUE_NOT_FOUND) { status = MENU_REMOTE_NOT_FOUND; }
+                else if (status == MENU_VALUE_READ_ONLY) { status = MENU_REMOTE_READ_ONLY; }
+                else if (status == MENU_VALUE_OUT_OF_RANGE) { status = MENU_REMOTE_OUT_OF_RANGE; }
+                reply_value(MENU_FRAME_SET_REPLY, status, value);
+                return;
+            }
+            case MENU_FRAME_ACTIVATE:
+                if (!resolve_item(payload, length, cur, idx)) { reply_status(MENU_FRAME_ACTIVATE_REPLY, MENU_REMOTE_NOT_FOUND); return; }
+                if (menu_runtime_t::menu_type_at(cur, idx) != ENTRY_FUNC) { reply_status(MENU_FRAME_ACTIVATE_REPLY, MENU_REMOTE_READ_ONLY); return; }
+                if (!menu_runtime_t::menu_selectable(cur, idx)) { reply_status(MENU_FRAME_ACTIVATE_REPLY, MENU_REMOTE_DISABLED); return; }
+                menu_runtime_t::menu_call_func(cur, idx);
+                runtime->request_redraw();
+                reply_status(MENU_FRAME_ACTIVATE_REPLY, MENU_REMOTE_OK);
+                return;
+            case MENU_FRAME_WATCH: {
+                if (!resolve_item(payload, length, cur, idx) || !menu_runtime_t::menu_value_read(cur, idx, &value)) {
+                    reply_slot(MENU_REMOTE_NOT_FOUND, 0xFFU);
+                    return;
+                }
+                /* An item already watched keeps its slot; otherwise the first free one is taken. */
+                uint8_t slot = 0xFFU;
+                for (uint8_t i = 0; i < watch_count; ++i) {
+                    menu_remote_watch_t const &w = watches[i];
+                    if (w.active && w.cur.menu_ptr == cur.menu_ptr && w.idx == idx) { slot = i; break; }
+                    if (!w.active && slot == 0xFFU) { slot = i; }
+                }
+                if (slot == 0xFFU) { reply_slot(MENU_REMOTE_NO_SLOT, 0xFFU); return; }
+                menu_remote_watch_t &w = watches[slot];
+                w.cur = cur;
+                w.idx = idx;
+                w.active = 1;
+                w.last = value;
+                reply_slot(MENU_REMOTE_OK, slot);
+                return;
+            }
+            case MENU_FRAME_UNWATCH:
+                if (length != 1 || (payload[0] != 0xFFU && payload[0] >= watch_count)) { reply_status(MENU_FRAME_UNWATCH_REPLY, MENU_REMOTE_MALFORMED); return; }
+                for (uint8_t slot = 0; slot < watch_count; ++slot) {
+                    if (payload[0] == 0xFFU || payload[0] == slot) { watches[slot].active = 0; }
+                }
+                reply_status(MENU_FRAME_UNWATCH_REPLY, MENU_REMOTE_OK);
+                return;
+            case MENU_FRAME_PROVISION: {
+                basic_menu_provision_t<Runtime> provision;
+                provision.runtime = runtime;
+                provision.io = io;
+                provision.apply(payload, length);
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+    void send_list_row(void) {
+        uint8_t const total = menu_runtime_t::menu_count(list);
+        if (list.selected >= total) {
+            listing = 0;
+            reply_list_end(MENU_REMOTE_OK, total);
+            return;
+        }
+        uint8_t const idx = list.selected++;
+        entry_t const tp = menu_runtime_t::menu_type_at(list, idx);
+        long value = 0;
+        uint8_t flags = 0;
+        if (menu_runtime_t::menu_hidden(list, idx)) { flags = static_cast<uint8_t>(flags | MENU_REMOTE_ROW_HIDDEN); }
+        if (menu_runtime_t::menu_disabled(list, idx)) { flags = static_cast<uint8_t>(flags | MENU_REMOTE_ROW_DISABLED); }
+        if (menu_runtime_t::menu_value_read(list, idx, &value)) { flags = static_cast<uint8_t>(flags | MENU_REMOTE_ROW_READABLE); }
+        if (menu_runtime_t::menu_value_check(list, idx, value) != MENU_VALUE_READ_ONLY) { flags = static_cast<uint8_t>(flags | MENU_REMOTE_ROW_WRITABLE); }
+        if (tp == ENTRY_MENU) { flags = static_cast<uint8_t>(flags | MENU_REMOTE_ROW_HAS_CHILD); }
+        int mn = 0;
+        int mx = 0;
+        int step = 1;
+        uint8_t choices = 0;
+        if (tp == ENTRY_INT || tp == ENTRY_VALUE) {
+            mn = menu_runtime_t::menu_int_min(list, idx);
+            mx = menu_runtime_t::menu_int_max(list, idx);
+            menu_runtime_t::normalize_range(mn, mx);
+            step = menu_runtime_t::positive_step(menu_runtime_t::menu_int_step(list, idx));
+        } else if (tp == ENTRY_BOOL || tp == ENTRY_SELECT) {
+            choices = menu_runtime_t::menu_value_count(list, idx);
+            mx = choices ? choices - 1 : 0;
+        }
+        menu_text_t const label = menu_runtime_t::menu_label_at(list, idx);
+        uint8_t const label_len = menu_text_length(label, MENU_MAX_LINE - 1);
+        uint16_t length = static_cast<uint16_t>(3 + 16 + 1 + label_len + 1);
+        for (uint8_t c = 0; c < choices; ++c) {
+            length = static_cast<uint16_t>(length + 1 + menu_text_length(menu_runtime_t::menu_value_label_at(list, idx, c), MENU_MAX_LINE - 1));
+        }
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, MENU_FRAME_LIST_ROW, length);
+        menu_frame_put_u8(w, idx);
+        menu_frame_put_u8(w, static_cast<uint8_t>(tp));
+        menu_frame_put_u8(w, flags);
+        menu_frame_put_i32(w, value);
+        menu_frame_put_i32(w, mn);
+        menu_frame_put_i32(w, mx);
+        menu_frame_put_i32(w, step);
+        put_text(w, label, label_len);
+        menu_frame_put_u8(w, choices);
+        for (uint8_t c = 0; c < choices; ++c) {
+            menu_text_t const choice = menu_runtime_t::menu_value_label_at(list, idx, c);
+            put_text(w, choice, menu_text_length(choice, MENU_MAX_LINE - 1));
+        }
+        menu_frame_end(w);
+    }
+
+    static void put_text(menu_frame_writer_t &w, menu_text_t text, uint8_t len) {
+        menu_frame_put_u8(w, len);
+        for (uint8_t i = 0; i < len; ++i) { menu_frame_put_u8(w, static_cast<uint8_t>(menu_text_char_at(text, i))); }
+    }
+
+    void poll_watches(void) {
+        for (uint8_t slot = 0; slot < watch_count; ++slot) {
+            menu_remote_watch_t &w = watches[slot];
+            long value = 0;
+            if (!w.active || !menu_runtime_t::menu_value_read(w.cur, w.idx, &value) || value == w.last) { continue; }
+            w.last = value;
+            menu_frame_writer_t f;
+            menu_frame_begin(f, io, MENU_FRAME_NOTIFY, 5);
+            menu_frame_put_u8(f, slot);
+            menu_frame_put_i32(f, value);
+            menu_frame_end(f);
+        }
+    }
+
+    void reply_status(uint8_t type, uint8_t status) {
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, type, 1);
+        menu_frame_put_u8(w, status);
+        menu_frame_end(w);
+    }
+    void reply_value(uint8_t type, uint8_t status, long value) {
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, type, 5);
+        menu_frame_put_u8(w, status);
+        menu_frame_put_i32(w, value);
+        menu_frame_end(w);
+    }
+    void reply_slot(uint8_t status, uint8_t slot) {
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, MENU_FRAME_WATCH_REPLY, 2);
+        menu_frame_put_u8(w, status);
+        menu_frame_put_u8(w, slot);
+        menu_frame_end(w);
+    }
+    void reply_list_end(uint8_t status, uint8_t count) {
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, MENU_FRAME_LIST_END, 2);
+        menu_frame_put_u8(w, status);
+        menu_frame_put_u8(w, count);
+        menu_frame_end(w);
+    }
+};
+typedef basic_menu_remote_t<menu_runtime_t> menu_remote_t;
+
+template<typename Runtime>
+static inline void menu_remote_begin(basic_menu_remote_t<Runtime> &r, Runtime &runtime, menu_byte_io_t io,
+                                     uint8_t *buffer, uint16_t capacity,
+                                     menu_remote_watch_t *watches, uint8_t watch_count) {
+    r.runtime = &runtime;
+    r.io = io;
+    menu_frame_reader_init(r.reader, buffer, capacity);
+    r.watches = watches;
+    r.watch_count = watches ? watch_count : 0;
+    for (uint8_t slot = 0; slot < r.watch_count; ++slot) { watches[slot].active = 0; }
+    r.list.menu_ptr = 0;
+    r.list.ops = 0;
+    r.list.selected = 0;
+    r.list.top = 0;
+    r.listing = 0;
+}
+
+/* ============================= JSON Streaming ============================ */
+/* Writes the tree as JSON straight to a byte sink, with no document model. A snapshot nests
+   submenu rows under "items"; later diffs list only the items whose value, hidden, or disabled
+   state changed since the previous message:
+
+     {"seq":1,"full":true,"items":[{"id":0,"label":"Speed","type":"int","value":10,"min":0,...}]}
+     {"seq":2,"since":1,"changes":[{"id":0,"value":42},{"id":3,"hidden":true}]}
+
+   Ids are Tree Walking ids and values follow menu_value_read(). Change tracking keeps one
+   caller-owned menu_json_item_t per id; items past the end of that table still appear in
+   snapshots but are not diffed. Output is staged in a caller-owned chunk buffer and handed to
+   the sink in pieces no larger than that buffer, so the chunk size can match the transport. */
+
+enum {
+    MENU_JSON_HIDDEN   = 1 << 0,
+    MENU_JSON_DISABLED = 1 << 1
+};
+
+struct menu_json_item_t {
+    int     value;
+    uint8_t flags;
+};
+
+struct menu_json_writer_t {
+    menu_byte_io_t io;
+    uint8_t       *chunk;
+    uint16_t       capacity;
+    uint16_t       used;
+
+    void flush(void) {
+        if (used) { menu_byte_io_write(io, chunk, used); }
+        used = 0;
+    }
+    void put(char ch) {
+        uint8_t const byte = static_cast<uint8_t>(ch);
+        if (!capacity) { menu_byte_io_write(io, &byte, 1); return; }
+        chunk[used++] = byte;
+        if (used >= capacity) { flush(); }
+    }
+    void put(char const *text) {
+        while (*text) { put(*text++); }
+    }
+    void put_long(long value) {
+        char nb[3 * sizeof(long) + 2];
+        put(menu_runtime_t::long_to_str(value, nb, sizeof(nb)));
+    }
+    void put_seq(uint32_t value) {
+        char tmp[10];
+        uint8_t i = 0;
+        do { tmp[i++] = static_cast<char>('0' + (value % 10U)); value /= 10U; } while (value);
+        while (i) { put(tmp[--i]); }
+    }
+    void put_string(menu_text_t text) {
+        static char const hex[] = "0123456789abcdef";
+        put('"');
+        for (uint8_t i = 0; i < MENU_MAX_LINE; ++i) {
+            char const ch = menu_text_char_at(text, i);
+            if (!ch) { break; }
+            if (ch == '"' || ch == '\\') { put('\\'); put(ch); }
+            else if (static_cast<uint8_t>(ch) < 0x20U) {
+                put("\\u00");
+                put(hex[(static_cast<uint8_t>(ch) >> 4) & 0x0FU]);
+                put(hex[static_cast<uint8_t>(ch) & 0x0FU]);
+            } else { put(ch); }
+        }
+        put('"');
+    }
+};
+
+template<typename Runtime>
+struct basic_menu_json_stream_t {
+    Runtime            *runtime;
+    menu_json_writer_t  out;
+    menu_json_item_t   *items;
+    uint16_t            item_count;
+    uint32_t            seq;
+    uint8_t             primed;
+
+    static uint8_t state_flags(menu_cursor_t const &cur, uint8_t idx) {
+        uint8_t flags = 0;
+        if (menu_runtime_t::menu_hidden(cur, idx)) { flags = static_cast<uint8_t>(flags | MENU_JSON_HIDDEN); }
+        if (menu_runtime_t::menu_disabled(cur, idx)) { flags = static_cast<uint8_t>(flags | MENU_JSON_DISABLED); }
+        return flags;
+    }
+
+    static char const *type_name(entry_t tp) {
+        switch (tp) {
+            case ENTRY_MENU:   return "menu";
+            case ENTRY_INT:    return "int";
+            case ENTRY_BOOL:   return "bool";
+            case ENTRY_SELECT: return "select";
+            case ENTRY_VALUE:  return "value";
+            default:           return "func";
+        }
+    }
+
+    /* Full tree; also resets change tracking. */
+    void snapshot(void) {
+        if (!runtime) { return; }
+        ++seq;
+        out.put("{\"seq\":");
+        out.put_seq(seq);
+        out.put(",\"full\":true,\"items\":[");
+        typename Runtime::tree_iter_t it;
+        uint8_t open = 0;
+        bool first = true;
+        bool more = menu_tree_begin(it, runtime->root().menu_ptr, runtime->root().ops);
+        while (more) {
+            if (!first) { out.put(','); }
+            put_item(it);
+            more = menu_tree_next(it);
+            if (more && it.depth > open) {
+                out.put(",\"items\":[");
+                ++open;
+                first = true;
+                continue;
+            }
+            out.put('}');
+            while (open > (more ? it.depth : 0)) { out.put("]}"); --open; }
+            first = false;
+        }
+        out.put("]}\n");
+        out.flush();
+        primed = 1;
+    }
+
+    /* Changes since the previous message; writes nothing and returns false when nothing changed.
+       The first call after begin or invalidate() sends a snapshot instead. */
+    bool diff(void) {
+        if (!runtime) { return false; }
+        if (!primed) { snapshot(); return true; }
+        typename Runtime::tree_iter_t it;
+        bool opened = false;
+        bool more = menu_tree_begin(it, runtime->root().menu_ptr, runtime->root().ops);
+        while (more && it.id < item_count) {
+            menu_cursor_t const &cur = menu_tree_cursor(it);
+            uint8_t const idx = menu_tree_index(it);
+            menu_json_item_t &seen = items[it.id];
+            long value = 0;
+            bool const has_value = menu_runtime_t::menu_value_read(cur, idx, &value);
+            uint8_t const flags = state_flags(cur, idx);
+            bool const value_changed = has_value && value != seen.value;
+            uint8_t const flipped = static_cast<uint8_t>(flags ^ seen.flags);
+            if (value_changed || flipped) {
+                if (!opened) {
+                    out.put("{\"seq\":");
+                    out.put_seq(seq + 1);
+                    out.put(",\"since\":");
+                    out.put_seq(seq);
+                    out.put(",\"changes\":[");
+                    opened = true;
+                } else {
+                    out.put(',');
+                }
+                out.put("{\"id\":");
+                out.put_long(it.id);
+                if (value_changed) { out.put(",\"value\":"); out.put_long(value); }
+                if (flipped & MENU_JSON_HIDDEN) { out.put((flags & MENU_JSON_HIDDEN) ? ",\"hidden\":true" : ",\"hidden\":false"); }
+                if (flipped & MENU_JSON_DISABLED) { out.put((flags & MENU_JSON_DISABLED) ? ",\"disabled\":true" : ",\"disabled\":false"); }
+                out.put('}');
+                seen.value = static_cast<int>(value);
+                seen.flags = flags;
+            }
+            more = menu_tree_next(it);
+        }
+        if (!opened) { return false; }
+        ++seq;
+        out.put("]}\n");
+        out.flush();
+        return true;
+    }
+
+    /* Makes the next diff() a full snapshot, e.g. when a new client connects. */
+    void invalidate(void) { primed = 0; }
+
+    void put_item(typename Runtime::tree_iter_t const &it) {
+        menu_cursor_t const &cur = menu_tree_cursor(it);
+        uint8_t const idx = menu_tree_index(it);
+        entry_t const tp = menu_runtime_t::menu_type_at(cur, idx);
+        long value = 0;
+        bool const has_value = menu_runtime_t::menu_value_read(cur, idx, &value);
+        uint8_t const flags = state_flags(cur, idx);
+        out.put("{\"id\":");
+        out.put_long(it.id);
+        out.put(",\"label\":");
+        out.put_string(menu_runtime_t::menu_label_at(cur, idx));
+        out.put(",\"type\":\"");
+        out.put(type_name(tp));
+        out.put('"');
+        if (has_value) { out.put(",\"value\":"); out.put_long(value); }
+        if (tp == ENTRY_INT || tp == ENTRY_VALUE) {
+            int mn = menu_runtime_t::menu_int_min(cur, idx);
+            int mx = menu_runtime_t::menu_int_max(cur, idx);
+            menu_runtime_t::normalize_range(mn, mx);
+            out.put(",\"min\":");
+            out.put_long(mn);
+            out.put(",\"max\":");
+            out.put_long(mx);
+            out.put(",\"step\":");
+            out.put_long(menu_runtime_t::positive_step(menu_runtime_t::menu_int_step(cur, idx)));
+            if (!menu_runtime_t::menu_int_has(cur, idx)) { out.put(",\"readonly\":true"); }
+        } else if (tp == ENTRY_BOOL || tp == ENTRY_SELECT) {
+            uint8_t const count = menu_runtime_t::menu_value_count(cur, idx);
+            out.put(",\"choices\":[");
+            for (uint8_t c = 0; c < count; ++c) {
+                if (c) { out.put(','); }
+                out.put_string(menu_runtime_t::menu_value_label_at(cur, idx, c));
+            }
+            out.put(']');
+        }
+        if (flags & MENU_JSON_HIDDEN) { out.put(",\"hidden\":true"); }
+        if (flags & MENU_JSON_DISABLED) { out.put(",\"disabled\":true"); }
+        if (it.id < item_count) {
+            items[it.id].value = static_cast<int>(value);
+            items[it.id].flags = flags;
+        }
+    }
+};
+typedef basic_menu_json_stream_t<menu_runtime_t> menu_json_stream_t;
+
+template<typename Runtime>
+static inline void menu_json_begin(basic_menu_json_stream_t<Runtime> &js, Runtime &runtime, menu_byte_io_t io,
+                                   uint8_t *chunk, uint16_t chunk_size,
+                                   menu_json_item_t *items, uint16_t item_count) {
+    js.runtime = &runtime;
+    js.out.io = io;
+    js.out.chunk = chunk;
+    js.out.capacity = chunk ? chunk_size : 0;
+    js.out.used = 0;
+    js.items = items;
+    js.item_count = items ? item_count : 0;
+    js.seq = 0;
+    js.primed = 0;
+}
+
+/* ============================== Command Line ============================= */
+/* Line-oriented shell over a byte stream, for technicians who would rather type than navigate:
+
+     ls [path]          list a menu: "Speed = 40", "Motor/", "Run()"
+     cd [path]          change menu; no path returns to the root
+     pwd                print the current menu
+     get <path>         print a value
+     set <path> <value> validated write; BOOL/SELECT take a choice label or position
+     run <path>         call a FUNC item
+
+   Paths are label paths, absolute from '/' or relative to the current menu, with "." and "..".
+   Labels may contain spaces: the path is the rest of the line (for set, up to the last space).
+   Tab completes the last path segment. Input is echoed and edited in the caller-owned line
+   buffer; service() consumes waiting bytes and runs at most one command per call. The current
+   menu is kept as row indexes, so resolving a path is one pass over it with no allocation. */
+
+template<typename Runtime>
+struct basic_menu_cli_t {
+    Runtime        *runtime;
+    menu_byte_io_t  io;
+    char           *line;
+    uint8_t         capacity;
+    uint8_t         length;
+    uint8_t         cwd[Runtime::levels];
+    uint8_t         depth;
+    uint8_t         prompted : 1,
+                    last_cr  : 1;
+
+    void service(void) {
+        if (!runtime || !capacity) { return; }
+        if (!prompted) { prompt(); }
+        for (;;) {
+            int const ch = menu_byte_io_read(io);
+            if (ch < 0) { return; }
+            bool const was_cr = last_cr != 0;
+            last_cr = (ch == '\r') ? 1 : 0;
+            if (ch == '\n' && was_cr) { continue; }
+            if (ch == '\r' || ch == '\n') {
+                put("\r\n");
+                line[length] = '\0';
+                execute();
+                length = 0;
+                prompt();
+                return;
+            }
+            if (ch == 0x08 || ch == 0x7F) {
+                if (length) { --length; put("\b \b"); }
+            } else if (ch == '\t') {
+                complete();
+            } else if (ch >= 0x20 && ch < 0x7F) {
+                if (static_cast<uint16_t>(length) + 1U < capacity) {
+                    line[length++] = static_cast<char>(ch);
+                    put_char(static_cast<char>(ch));
+                } else {
+                    put_char('\a');
+                }
+            }
+        }
+    }
+
+    /* ---------- output ---------- */
+    void put_char(char ch) {
+        uint8_t const byte = static_cast<uint8_t>(ch);
+        menu_byte_io_write(io, &byte, 1);
+    }
+    void put(char const *text) {
+        uint16_t len = 0;
+        while (text[len]) { ++len; }
+        menu_byte_io_write(io, reinterpret_cast<uint8_t const *>(text), len);
+    }
+    void put_text(menu_text_t text) {
+        for (uint8_t i = 0; i < MENU_MAX_LINE; ++i) {
+            char const ch = menu_text_char_at(text, i);
+            if (!ch) { break; }
+            put_char(ch);
+        }
+    }
+    void put_long(long value) {
+        char nb[3 * sizeof(long) + 2];
+        put(menu_runtime_t::long_to_str(value, nb, sizeof(nb)));
+    }
+    void put_cwd(void) {
+        menu_cursor_t menu = { 0, 0, 0, 0 };
+        put_char('/');
+        for (uint8_t d = 0; d < depth; ++d) {
+            if (!menu_path_resolve(runtime->root().menu_ptr, runtime->root().ops, cwd, d, menu, Runtime::levels)) { break; }
+            if (d) { put_char('/'); }
+            put_text(menu_runtime_t::menu_label_at(menu, cwd[d]));
+        }
+    }
+    void prompt(void) {
+        prompted = 1;
+        put_cwd();
+        put("> ");
+        for (uint8_t i = 0; i < length; ++i) { put_char(line[i]); }
+    }
+    void put_value(menu_cursor_t const &menu, uint8_t idx) {
+        char formatted[MENU_MAX_LINE];
+        long value = 0;
+        if (menu_runtime_t::menu_format_value(menu, idx, formatted, sizeof(formatted))) { put(formatted); return; }
+        if (!menu_runtime_t::menu_value_read(menu, idx, &value)) { put("?"); return; }
+        entry_t const tp = menu_runtime_t::menu_type_at(menu, idx);
+        if (tp == ENTRY_BOOL || tp == ENTRY_SELECT) { put_text(menu_runtime_t::menu_value_label_at(menu, idx, static_cast<uint8_t>(value))); }
+        else { put_long(value); }
+    }
+
+    /* ---------- paths ---------- */
+    struct target_t {
+        menu_cursor_t menu;      /* menu reached, or the menu holding the item */
+        uint8_t       path[Runtime::levels];
+        uint8_t       depth;
+        uint8_t       idx;
+        uint8_t       has_item;
+    };
+
+    bool resolve(char const *p, char const *end, bool want_menu, target_t &t) const {
+        void const *root_ptr = runtime->root().menu_ptr;
+        menu_ops_t const *root_ops = runtime->root().ops;
+        t.depth = 0;
+        t.has_item = 0;
+        t.idx = 0;
+        if (p < end && *p == '/') { ++p; }
+        else {
+            for (uint8_t d = 0; d < depth; ++d) { t.path[d] = cwd[d]; }
+            t.depth = depth;
+        }
+        if (!menu_path_resolve(root_ptr, root_ops, t.path, t.depth, t.menu, Runtime::levels)) { return false; }
+        while (p < end) {
+            char const *seg_end = p;
+            while (seg_end < end && *seg_end != '/') { ++seg_end; }
+            char const *next = (seg_end < end) ? seg_end + 1 : seg_end;
+            if (seg_end == p || t.has_item || (seg_end - p == 1 && p[0] == '.')) {
+                if (seg_end != p && t.has_item) { return false; }
+                p = next;
+                continue;
+            }
+            if (seg_end - p == 2 && p[0] == '.' && p[1] == '.') {
+                if (t.depth) { --t.depth; }
+                if (!menu_path_resolve(root_ptr, root_ops, t.path, t.depth, t.menu, Runtime::levels)) { return false; }
+                p = next;
+                continue;
+            }
+            uint8_t const total = menu_runtime_t::menu_count(t.menu);
+            uint8_t idx = 0;
+            while (idx < total && !menu_runtime_t::label_matches(menu_runtime_t::menu_label_at(t.menu, idx), p, seg_end)) { ++idx; }
+            if (idx >= total) { return false; }
+            bool last = true;
+            for (char const *q = next; q < end; ++q) { if (*q != '/') { last = false; break; } }
+            bool const is_menu = menu_runtime_t::menu_type_at(t.menu, idx) == ENTRY_MENU;
+            if (!last || (is_menu && want_menu)) {
+                menu_cursor_t child = { 0, 0, 0, 0 };
+                if (!is_menu || static_cast<uint16_t>(t.depth) + 1U >= Runtime::levels ||
+                    !menu_runtime_t::menu_child_at(t.menu, idx, &child.menu_ptr, &child.ops) ||
+                    !menu_runtime_t::menu_cursor_valid(child)) {
+                    return false;
+                }
+                t.path[t.depth++] = idx;
+                t.menu = child;
+            } else {
+                t.idx = idx;
+                t.has_item = 1;
+            }
+            p = next;
+        }
+        return !want_menu || !t.has_item;
+    }
+
+    /* ---------- commands ---------- */
+    static bool word_is(char const *p, char const *end, char const *word) {
+        while (p < end && *word && *p == *word) { ++p; ++word; }
+        return p == end && !*word;
+    }
+    static char const *skip_spaces(char const *p, char const *end) {
+        while (p < end && *p == ' ') { ++p; }
+        return p;
+    }
+    static char const *trim_end(char const *p, char const *end) {
+        while (end > p && end[-1] == ' ') { --end; }
+        return end;
+    }
+    static bool parse_long(char const *p, char const *end, long *out) {
+        bool neg = false;
+        if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); ++p; }
+        if (p == end) { return false; }
+        long value = 0;
+        for (; p < end; ++p) {
+            if (*p < '0' || *p > '9' || value > 99999999L) { return false; }
+            value = value * 10 + (*p - '0');
+        }
+        *out = neg ? -value : value;
+        return true;
+    }
+
+    void execute(void) {
+        char const *p = skip_spaces(line, line + length);
+        char const *end = trim_end(p, line + length);
+        if (p == end) { return; }
+        char const *cmd_end = p;
+        while (cmd_end < end && *cmd_end != ' ') { ++cmd_end; }
+        char const *arg = skip_spaces(cmd_end, end);
+        target_t t;
+        if (word_is(p, cmd_end, "ls")) {
+            if (!resolve(arg, end, true, t)) { put("error: no such menu\r\n"); return; }
+            list(t.menu);
+        } else if (word_is(p, cmd_end, "cd")) {
+            if (arg == end) { depth = 0; return; }
+            if (!resolve(arg, end, true, t)) { put("error: no such menu\r\n"); return; }
+            for (uint8_t d = 0; d < t.depth; ++d) { cwd[d] = t.path[d]; }
+            depth = t.depth;
+        } else if (word_is(p, cmd_end, "pwd")) {
+            put_cwd();
+            put("\r\n");
+        } else if (word_is(p, cmd_end, "get")) {
+            if (!resolve(arg, end, false, t) || !t.has_item) { put("error: not found\r\n"); return; }
+            put_text(menu_runtime_t::menu_label_at(t.menu, t.idx));
+            put(" = ");
+            put_value(t.menu, t.idx);
+            put("\r\n");
+        } else if (word_is(p, cmd_end, "set")) {
+            char const *value_start = end;
+            while (value_start > arg && value_start[-1] != ' ') { --value_start; }
+            char const *path_end = trim_end(arg, value_start);
+            if (value_start == arg || path_end == arg) { put("usage: set <path> <value>\r\n"); return; }
+            if (!resolve(arg, path_end, false, t) || !t.has_item) { put("error: not found\r\n"); return; }
+            set(t, value_start, end);
+        } else if (word_is(p, cmd_end, "run")) {
+            if (!resolve(arg, end, false, t) || !t.has_item) { put("error: not found\r\n"); return; }
+            if (menu_runtime_t::menu_type_at(t.menu, t.idx) != ENTRY_FUNC) { put("error: not a function\r\n"); return; }
+            if (!menu_runtime_t::menu_selectable(t.menu, t.idx)) { put("error: disabled\r\n"); return; }
+            menu_runtime_t::menu_call_func(t.menu, t.idx);
+            runtime->request_redraw();
+            put("ok\r\n");
+        } else if (word_is(p, cmd_end, "help")) {
+            put("ls [path]  cd [path]  pwd  get <path>  set <path> <value>  run <path>\r\n");
+        } else {
+            put("error: unknown command\r\n");
+        }
+    }
+
+    void list(menu_cursor_t const &menu) {
+        uint8_t const total = menu_runtime_t::menu_count(menu);
+        for (uint8_t idx = 0; idx < total; ++idx) {
+            if (menu_runtime_t::menu_hidden(menu, idx)) { continue; }
+            entry_t const tp = menu_runtime_t::menu_type_at(menu, idx);
+            put_text(menu_runtime_t::menu_label_at(menu, idx));
+            if (tp == ENTRY_MENU) { put_char('/'); }
+            else if (tp == ENTRY_FUNC) { put("()"); }
+            else { put(" = "); put_value(menu, idx); }
+            if (menu_runtime_t::menu_disabled(menu, idx)) { put("  (disabled)"); }
+            put("\r\n");
+        }
+    }
+
+    void set(target_t const &t, char const *p, char const *end) {
+        long value = 0;
+        entry_t const tp = menu_runtime_t::menu_type_at(t.menu, t.idx);
+        bool parsed = parse_long(p, end, &value);
+        if (!parsed && (tp == ENTRY_BOOL || tp == ENTRY_SELECT)) {
+            uint8_t const count = menu_runtime_t::menu_value_count(t.menu, t.idx);
+            for (uint8_t c = 0; c < count && !parsed; ++c) {
+                if (menu_runtime_t::label_matches(menu_runtime_t::menu_value_label_at(t.menu, t.idx, c), p, end)) { value = c; parsed = true; }
+            }
+        }
+        if (!parsed) { put("error: bad value\r\n"); return; }
+        if (menu_runtime_t::menu_disabled(t.menu, t.idx)) { put("error: disabled\r\n"); return; }
+        uint8_t const status = runtime->set_value(t.menu, t.idx, value);
+        if (status == MENU_VALUE_OK) {
+            put_text(menu_runtime_t::menu_label_at(t.menu, t.idx));
+            put(" = ");
+            put_value(t.menu, t.idx);
+            put("\r\n");
+        } else if (status == MENU_VALUE_OUT_OF_RANGE) {
+            put("error: out of range ");
+            if (tp == ENTRY_INT || tp == ENTRY_VALUE) {
+                int mn = menu_runtime_t::menu_int_min(t.menu, t.idx);
+                int mx = menu_runtime_t::menu_int_max(t.menu, t.idx);
+                menu_runtime_t::normalize_range(mn, mx);
+                put_long(mn);
+                put("..");
+                put_long(mx);
+            } else {
+                put("0..");
+                put_long(static_cast<long>(menu_runtime_t::menu_value_count(t.menu, t.idx)) - 1);
+            }
+            put("\r\n");
+        } else {
+            put("error: read only\r\n");
+        }
+    }
+
+    /* Completes the last segment of the argument against the labels of its menu. */
+    void complete(void) {
+        char const *p = skip_spaces(line, line + length);
+        char const *end = line + length;
+        char const *cmd_end = p;
+        while (cmd_end < end && *cmd_end != ' ') { ++cmd_end; }
+        if (cmd_end == end) { return; }
+        char const *arg = skip_spaces(cmd_end, end);
+        char const *prefix = end;
+        while (prefix > arg && prefix[-1] != '/') { --prefix; }
+        target_t t;
+        if (!resolve(arg, prefix, true, t)) { put_char('\a'); return; }
+        uint8_t const total = menu_runtime_t::menu_count(t.menu);
+        uint8_t const typed = static_cast<uint8_t>(end - prefix);
+        uint8_t matches = 0;
+        uint8_t first = 0;
+        uint8_t common = 0;
+        for (uint8_t idx = 0; idx < total; ++idx) {
+            if (menu_runtime_t::menu_hidden(t.menu, idx) || !label_starts_with(menu_runtime_t::menu_label_at(t.menu, idx), prefix, typed)) { continue; }
+            menu_text_t const label = menu_runtime_t::menu_label_at(t.menu, idx);
+            if (!matches++) {
+                first = idx;
+                common = menu_text_length(label, MENU_MAX_LINE - 1);
+            } else {
+                menu_text_t const head = menu_runtime_t::menu_label_at(t.menu, first);
+                uint8_t same = typed;
+                while (same < common && menu_text_char_at(head, same) == menu_text_char_at(label, same)) { ++same; }
+                common = same;
+            }
+        }
+        if (!matches) { put_char('\a'); return; }
+        menu_text_t const head = menu_runtime_t::menu_label_at(t.menu, first);
+        for (uint8_t i = typed; i < common && static_cast<uint16_t>(length) + 1U < capacity; ++i) {
+            line[length++] = menu_text_char_at(head, i);
+            put_char(line[length - 1]);
+        }
+        if (matches == 1) {
+            char const tail = (menu_runtime_t::menu_type_at(t.menu, first) == ENTRY_MENU) ? '/' : ' ';
+            if (static_cast<uint16_t>(length) + 1U < capacity) { line[length++] = tail; put_char(tail); }
+            return;
+        }
+        if (common > typed) { return; }
+        put("\r\n");
+        for (uint8_t idx = 0; idx < total; ++idx) {
+            if (menu_runtime_t::menu_hidden(t.menu, idx) || !label_starts_with(menu_runtime_t::menu_label_at(t.menu, idx), prefix, typed)) { continue; }
+            put_text(menu_runtime_t::menu_label_at(t.menu, idx));
+            put("  ");
+        }
+        put("\r\n");
+        prompt();
+    }
+
+    static bool label_starts_with(menu_text_t label, char const *prefix, uint8_t len) {
+        for (uint8_t i = 0; i < len; ++i) {
+            if (menu_text_char_at(label, i) != prefix[i]) { return false; }
+        }
+        return true;
+    }
+};
+typedef basic_menu_cli_t<menu_runtime_t> menu_cli_t;
+
+template<typename Runtime>
+static inline void menu_cli_begin(basic_menu_cli_t<Runtime> &cli, Runtime &runtime, menu_byte_io_t io,
+                                  char *line, uint8_t capacity) {
+    cli.runtime = &runtime;
+    cli.io = io;
+    cli.line = line;
+    cli.capacity = line ? capacity : 0;
+    cli.length = 0;
+    cli.depth = 0;
+    cli.prompted = 0;
+    cli.last_cr = 0;
+}
+
+/* =========================== Display Streaming =========================== */
+/* Mirrors rendered frames to another process or board as row diffs over the same frames, so a
+   panel renderer can run apart from the menu. Each flush sends one 'r' frame per row whose
+   kind, flags, item, or text changed since the previous flush, then an 'f' frame that commits
+   them. A flush that changed nothing sends no bytes.
+
+     'r' row u8, kind u8, flags u8, item index u8, entry type u8, text (length u8 + bytes)
+     'f' frame u16, row count u8, changed rows u8
+     'D' (client, no payload) resend every row with the next frame
+
+   Change detection keeps one caller-owned 32-bit hash per row rather than a copy of its text;
+   rows past the end of that table are sent on every flush. menu_display_shadow_t is the
+   receiving side: it applies row frames to caller-owned rows and reports each committed frame,
+   so the renderer never sees half of one. */
+
+enum {
+    MENU_FRAME_DISPLAY_ROW  = 'r',
+    MENU_FRAME_DISPLAY_END  = 'f',
+    MENU_FRAME_DISPLAY_SYNC = 'D'
+};
+
+static inline uint32_t menu_display_row_hash(menu_render_line_t const &line) {
+    uint8_t const head[4] = { line.kind, line.flags, line.item_index, line.entry_type };
+    uint32_t hash = 2166136261UL;
+    for (uint8_t i = 0; i < 4; ++i) { hash = (hash ^ head[i]) * 16777619UL; }
+    for (char const *p = line.text ? line.text : ""; *p; ++p) { hash = (hash ^ static_cast<uint8_t>(*p)) * 16777619UL; }
+    return hash;
+}
+
+template<typename Runtime>
+struct basic_menu_display_stream_t {
+    menu_byte_io_t       io;
+    Runtime             *runtime;   /* optional; redrawn when a client asks for a resync */
+    menu_frame_reader_t  reader;
+    uint32_t            *hashes;
+    uint8_t              capacity;
+    uint8_t              rows;      /* rows in the last committed frame */
+    uint8_t              rendered;  /* rows rendered so far in this frame */
+    uint8_t              changed;
+    uint16_t             frame;
+    uint8_t              full;
+
+    /* Handles resync requests from the client; call it alongside runtime.service(). */
+    void service(void) {
+        for (;;) {
+            int const ch = menu_byte_io_read(io);
+            if (ch < 0) { return; }
+            if (menu_frame_feed(reader, static_cast<uint8_t>(ch)) == MENU_FRAME_READY &&
+                reader.type == MENU_FRAME_DISPLAY_SYNC) {
+                resync();
+            }
+        }
+    }
+
+    void resync(void) {
+        full = 1;
+        if (runtime) { runtime->request_redraw(); }
+    }
+
+    void clear(void) {
+        rendered = 0;
+        changed = 0;
+    }
+
+    void render(menu_render_line_t const &line) {
+        uint32_t const hash = menu_display_row_hash(line);
+        if (line.row >= rendered) { rendered = static_cast<uint8_t>(line.row + 1); }
+        if (line.row < capacity) {
+            if (!full && line.row < rows && hashes[line.row] == hash) { return; }
+            hashes[line.row] = hash;
+        }
+        char const *text = line.text ? line.text : "";
+        uint8_t len = 0;
+        while (len < MENU_MAX_LINE - 1 && text[len]) { ++len; }
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, MENU_FRAME_DISPLAY_ROW, static_cast<uint16_t>(6 + len));
+        menu_frame_put_u8(w, line.row);
+        menu_frame_put_u8(w, line.kind);
+        menu_frame_put_u8(w, line.flags);
+        menu_frame_put_u8(w, line.item_index);
+        menu_frame_put_u8(w, line.entry_type);
+        menu_frame_put_u8(w, len);
+        menu_frame_put(w, reinterpret_cast<uint8_t const *>(text), len);
+        menu_frame_end(w);
+        if (changed < 0xFFU) { ++changed; }
+    }
+
+    void flush(void) {
+        if (!changed && rendered == rows && !full) { return; }
+        ++frame;
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, MENU_FRAME_DISPLAY_END, 4);
+        menu_frame_put_u16(w, frame);
+        menu_frame_put_u8(w, rendered);
+        menu_frame_put_u8(w, changed);
+        menu_frame_end(w);
+        rows = rendered;
+        full = 0;
+    }
+
+    static void clear_cb(void *ctx) { static_cast<basic_menu_display_stream_t *>(ctx)->clear(); }
+    static void render_line_cb(void *ctx, menu_render_line_t const *line) {
+        if (line) { static_cast<basic_menu_display_stream_t *>(ctx)->render(*line); }
+    }
+    static void flush_cb(void *ctx) { static_cast<basic_menu_display_stream_t *>(ctx)->flush(); }
+    static display_ops_t const ops;
+};
+template<typename Runtime>
+display_ops_t const basic_menu_display_stream_t<Runtime>::ops = {
+    &basic_menu_display_stream_t<Runtime>::clear_cb, 0,
+    &basic_menu_display_stream_t<Runtime>::flush_cb,
+    &basic_menu_display_stream_t<Runtime>::render_line_cb
+};
+typedef basic_menu_display_stream_t<menu_runtime_t> menu_display_stream_t;
+
+/* hashes holds one entry per display row; the first frame is always sent in full. */
+template<typename Runtime>
+static inline display_t menu_display_stream_begin(basic_menu_display_stream_t<Runtime> &s, menu_byte_io_t io,
+                                                  uint32_t *hashes, uint8_t capacity,
+                                                  uint8_t width, uint8_t height) {
+    s.io = io;
+    s.runtime = 0;
+    menu_frame_reader_init(s.reader, 0, 0);
+    s.hashes = hashes;
+    s.capacity = hashes ? capacity : 0;
+    s.rows = 0;
+    s.rendered = 0;
+    s.changed = 0;
+    s.frame = 0;
+    s.full = 1;
+    return make_display(width, height, &s, &basic_menu_display_stream_t<Runtime>::ops);
+}
+
+struct menu_display_shadow_row_t {
+    uint8_t  kind;
+    uint8_t  flags;
+    uint8_t  item_index;
+    uint8_t  entry_type;
+    uint16_t changed;   /* frame that last changed this row */
+    char     text[MENU_MAX_LINE];
+};
+
+struct menu_display_shadow_t {
+    menu_byte_io_t             io;
+    menu_frame_reader_t        reader;
+    menu_display_shadow_row_t *rows;
+    uint8_t                    capacity;
+    uint8_t                    count;     /* rows in the current frame */
+    uint16_t                   frame;     /* sender's number for the last committed frame */
+    uint16_t                   committed; /* frames applied since begin */
+    uint8_t                    received;  /* row frames since the last 'f' */
+    uint8_t                    damaged;   /* rows may be missing until a frame resends them all */
+
+    /* Applies waiting row frames; returns true as soon as a frame is committed. A frame that
+       fails its CRC, or an 'f' whose changed count does not match the rows that arrived, makes
+       the shadow ask the sender for every row again. Until a frame brings every row, no 'f' is
+       committed, so a renderer never paints rows next to ones that were lost. */
+    bool service(void) {
+        for (;;) {
+            int const ch = menu_byte_io_read(io);
+            if (ch < 0) { return false; }
+            uint8_t const result = menu_frame_feed(reader, static_cast<uint8_t>(ch));
+            if (result == MENU_FRAME_PENDING) { continue; }
+            if (result != MENU_FRAME_READY) { mark_damaged(); continue; }
+            if (reader.type == MENU_FRAME_DISPLAY_ROW) {
+                if (!apply_row(reader.buffer, reader.length)) { mark_damaged(); }
+                if (received < 0xFFU) { ++received; }
+                continue;
+            }
+            if (reader.type != MENU_FRAME_DISPLAY_END) { continue; }
+            if (reader.length != 4) { mark_damaged(); continue; }
+            uint8_t const rows_sent = reader.buffer[2];
+            uint8_t const changed = reader.buffer[3];
+            bool const complete = received == changed && (!damaged || changed >= rows_sent);
+            received = 0;
+            if (!complete) { damaged = 1; request_sync(); continue; }
+            damaged = 0;
+            frame = menu_frame_get_u16(reader.buffer);
+            count = rows_sent < capacity ? rows_sent : capacity;
+            ++committed;
+            return true;
+        }
+    }
+
+    void mark_damaged(void) {
+        if (!damaged) { request_sync(); }
+        damaged = 1;
+    }
+
+    void request_sync(void) {
+        menu_frame_writer_t w;
+        menu_frame_begin(w, io, MENU_FRAME_DISPLAY_SYNC, 0);
+        menu_frame_end(w);
+    }
+
+    /* Rows past capacity are skipped; false only for a malformed frame. */
+    bool apply_row(uint8_t const *p, uint16_t length) {
+        if (length < 6 || length != static_cast<uint16_t>(6 + p[5])) { return false; }
+        if (p[0] >= capacity) { return true; }
+        menu_display_shadow_row_t &row = rows[p[0]];
+        row.kind = p[1];
+        row.flags = p[2];
+        row.item_index = p[3];
+        row.entry_type = p[4];
+        row.changed = static_cast<uint16_t>(committed + 1);
+        uint8_t const len = p[5] < MENU_MAX_LINE - 1 ? p[5] : static_cast<uint8_t>(MENU_MAX_LINE - 1);
+        for (uint8_t i = 0; i < len; ++i) { row.text[i] = static_cast<char>(p[6 + i]); }
+        row.text[len] = '\0';
+        return true;
+    }
+};
+
+/* buffer must hold the largest row frame: 6 + MENU_MAX_LINE bytes. */
+static inline void menu_display_shadow_begin(menu_display_shadow_t &s, menu_byte_io_t io,
+                                             uint8_t *buffer, uint16_t buffer_capacity,
+                                             menu_display_shadow_row_t *rows, uint8_t capacity) {
+    s.io = io;
+    menu_frame_reader_init(s.reader, buffer, buffer_capacity);
+    s.rows = rows;
+    s.capacity = rows ? capacity : 0;
+    s.count = 0;
+    s.frame = 0;
+    s.committed = 0;
+    s.received = 0;
+    s.damaged = 1;  /* the first commit must be a frame that carries every row */
+    for (uint8_t i = 0; i < s.capacity; ++i) {
+        rows[i].kind = MENU_RENDER_BLANK;
+        rows[i].flags = 0;
+        rows[i].item_index = 255;
+        rows[i].entry_type = 0;
+        rows[i].changed = 0;
+        rows[i].text[0] = '\0';
+    }
+}
+
 /* =========================== Built-in Input: Serial ====================== */
 #ifdef ARDUINO
 struct stream_keymap_t {
@@ -1,73 +1,87 @@
 #include "WebMenuCapture.h"
 
-struct captured_row_t {
-    uint8_t row;
-    uint8_t item_index;
-    uint8_t kind;
-    uint8_t entry_type;
-    uint8_t flags;
-    uint8_t editable;
-    char text[MENU_MAX_LINE];
+static_assert(WEB_MENU_ROW_TABLE_ROWS > 0 && WEB_MENU_ROW_TABLE_ROWS <= 32, "change masks are 32 bits wide");
+static_assert(sizeof(web_menu_row_record_t) == 12 + ((MENU_MAX_LINE + 3) & ~3), "row record layout is shared with JS");
+static_assert(sizeof(web_menu_row_table_t) == 16 + WEB_MENU_ROW_TABLE_ROWS * sizeof(web_menu_row_record_t),
+              "row table layout is shared with JS");
+
+static web_menu_row_table_t table = {
+    WEB_MENU_ROW_TABLE_VERSION,
+    16,
+    sizeof(web_menu_row_record_t),
+    0,
+    WEB_MENU_ROW_TABLE_ROWS,
+    0,
+    0,
+    0,
+    WEB_MENU_CAPTURE_WINDOW,
+    0,
+    {}
 };
 
-static captured_row_t rows[8];
-static uint8_t rowCount = 0;
-static uint8_t visibleTop = 0;
-static uint8_t visibleTotal = 0;
-static uint8_t visibleWindow = 5;
+/* Visibility depends only on the menu being drawn, so it is computed on the first item row of a frame. */
+static bool visibilityPending = true;
 
 static bool validIndex(int index) {
-    return index >= 0 && index < rowCount;
+    return index >= 0 && index < table.row_count;
 }
 
+/* Starts a frame. Row contents are kept so renderLine can tell which rows actually changed. */
 static void clearDisplay(void *) {
-    rowCount = 0;
-    visibleTop = 0;
-    visibleTotal = 0;
-    visibleWindow = 5;
-    for (uint8_t i = 0; i < 8; ++i) {
-        rows[i].editable = 0;
-        rows[i].text[0] = '\0';
-    }
+    table.row_count = 0;
+    table.visible_top = 0;
+    table.visible_total = 0;
+    table.visible_window = WEB_MENU_CAPTURE_WINDOW;
+    visibilityPending = true;
 }
 
 static void flushDisplay(void *) {
+    ++table.frame;
 }
 
 static void renderLine(void *ctx, menu_render_line_t const *line) {
-    if (!line || line->row >= 8) {
+    if (!line || line->row >= WEB_MENU_ROW_TABLE_ROWS) {
         return;
     }
     menu_runtime_t *rt = static_cast<menu_runtime_t *>(ctx);
-    menu_cursor_t const *cur = (rt && rt->depth < MENU_MAX_STACK) ? &rt->stack[rt->depth] : 0;
+    menu_cursor_t const *cur = (rt && rt->depth < MENU_MAX_STACK) ? &rt->top() : 0;
 
-    captured_row_t &row = rows[line->row];
+    uint8_t editable = 0;
+    if (cur && line->kind == MENU_RENDER_ITEM) {
+        if (visibilityPending) {
+            uint8_t total = menu_runtime_t::menu_count(*cur);
+            table.visible_total = menu_runtime_t::visible_count(*cur, total);
+            table.visible_window = table.visible_total < WEB_MENU_CAPTURE_WINDOW ? table.visible_total : WEB_MENU_CAPTURE_WINDOW;
+            table.visible_top = menu_runtime_t::raw_to_visible(*cur, total, line->item_index);
+            visibilityPending = false;
+        }
+        editable = menu_runtime_t::menu_int_has(*cur, line->item_index) ? 1 : 0;
+    }
+
+    web_menu_row_record_t &row = table.rows[line->row];
+    bool changed = row.row != line->row || row.item_index != line->item_index || row.kind != line->kind ||
+                   row.entry_type != line->entry_type || row.flags != line->flags || row.editable != editable;
     row.row = line->row;
     row.item_index = line->item_index;
     row.kind = line->kind;
     row.entry_type = line->entry_type;
     row.flags = line->flags;
-    row.editable = 0;
-
-    if (cur && line->kind == MENU_RENDER_ITEM) {
-        uint8_t total = menu_runtime_t::menu_count(*cur);
-        visibleTotal = menu_runtime_t::visible_count(*cur, total);
-        visibleWindow = visibleTotal < 5 ? visibleTotal : 5;
-        row.editable = menu_runtime_t::menu_int_has(*cur, line->item_index) ? 1 : 0;
-        if (line->row == 1) {
-            visibleTop = menu_runtime_t::raw_to_visible(*cur, total, line->item_index);
-        }
-    }
+    row.editable = editable;
 
     char const *src = line->text ? line->text : "";
     uint8_t i = 0;
     while (src[i] && i + 1 < MENU_MAX_LINE) {
+        changed = changed || row.text[i] != src[i];
         row.text[i] = src[i];
         ++i;
     }
+    changed = changed || row.text[i] != '\0';
     row.text[i] = '\0';
-    if (line->row + 1 > rowCount) {
-        rowCount = static_cast<uint8_t>(line->row + 1);
+    if (changed || row.generation == 0) {
+        row.generation = table.frame + 1;
+    }
+    if (line->row + 1 > table.row_count) {
+        table.row_count = static_cast<uint8_t>(line->row + 1);
     }
 }
 
@@ -83,41 +97,60 @@ display_t make_web_menu_capture_display(menu_runtime_t &runtime, uint8_t width,
 }
 
 uint8_t web_menu_capture_row_count(void) {
-    return rowCount;
+    return table.row_count;
 }
 
 uint8_t web_menu_capture_row_kind(int index) {
-    return validIndex(index) ? rows[index].kind : 0;
+    return validIndex(index) ? table.rows[index].kind : 0;
 }
 
 uint8_t web_menu_capture_row_flags(int index) {
-    return validIndex(index) ? rows[index].flags : 0;
+    return validIndex(index) ? table.rows[index].flags : 0;
 }
 
 uint8_t web_menu_capture_row_entry_type(int index) {
-    return validIndex(index) ? rows[index].entry_type : 0;
+    return validIndex(index) ? table.rows[index].entry_type : 0;
 }
 
 uint8_t web_menu_capture_row_item_index(int index) {
-    return validIndex(index) ? rows[index].item_index : 255;
+    return validIndex(index) ? table.rows[index].item_index : 255;
 }
 
 uint8_t web_menu_capture_row_editable(int index) {
-    return validIndex(index) ? rows[index].editable : 0;
+    return validIndex(index) ? table.rows[index].editable : 0;
 }
 
 char const *web_menu_capture_row_text(int index) {
-    return validIndex(index) ? rows[index].text : 0;
+    return validIndex(index) ? table.rows[index].text : 0;
 }
 
 uint8_t web_menu_capture_visible_top(void) {
-    return visibleTop;
+    return table.visible_top;
 }
 
 uint8_t web_menu_capture_visible_total(void) {
-    return visibleTotal;
+    return table.visible_total;
 }
 
 uint8_t web_menu_capture_visible_window(void) {
-    return visibleWindow;
+    return table.visible_window;
+}
+
+web_menu_row_table_t const *web_menu_capture_row_table(void) {
+    return &table;
+}
+
+uint32_t web_menu_capture_row_generation(int index) {
+    return validIndex(index) ? table.rows[index].generation : 0;
+}
+
+/* Bit i is set when row i changed after the given generation (a frame number from the table). */
+uint32_t web_menu_capture_changed_since(uint32_t generation) {
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < table.row_count; ++i) {
+        if (table.rows[i].generation > generation) {
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
 }
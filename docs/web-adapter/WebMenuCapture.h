@@ -8,6 +8,47 @@
 
 #include <stdint.h>
 
+/* Packed row table shared with JS through linear memory. JS reads the whole frame in one
+   pass with a DataView instead of calling one export per field; bump the version whenever
+   the layout changes. All multi-byte fields are little-endian, as wasm memory always is. */
+#define WEB_MENU_ROW_TABLE_VERSION 2
+
+/* Rows captured per frame (title, items, and blank fill); at most 32 so change masks fit a uint32_t. */
+#ifndef WEB_MENU_ROW_TABLE_ROWS
+#define WEB_MENU_ROW_TABLE_ROWS 8
+#endif
+
+/* Item rows the page shows at once; drives visible_window and the scrollbar. */
+#ifndef WEB_MENU_CAPTURE_WINDOW
+#define WEB_MENU_CAPTURE_WINDOW 5
+#endif
+
+struct web_menu_row_record_t {
+    uint8_t row;          /* +0 */
+    uint8_t item_index;   /* +1 */
+    uint8_t kind;         /* +2  menu_render_kind_t */
+    uint8_t entry_type;   /* +3  entry_t */
+    uint8_t flags;        /* +4  MENU_RENDER_* */
+    uint8_t editable;     /* +5 */
+    uint8_t reserved[2];  /* +6 */
+    uint32_t generation;  /* +8  frame that last changed this row */
+    char text[MENU_MAX_LINE]; /* +12 null-terminated UTF-8 */
+};
+
+struct web_menu_row_table_t {
+    uint16_t version;        /* +0  WEB_MENU_ROW_TABLE_VERSION */
+    uint16_t header_size;    /* +2  offset of rows[0] */
+    uint16_t record_size;    /* +4  stride between rows */
+    uint8_t row_count;       /* +6 */
+    uint8_t row_capacity;    /* +7 */
+    uint32_t frame;          /* +8  incremented after every rendered frame */
+    uint8_t visible_top;     /* +12 */
+    uint8_t visible_total;   /* +13 */
+    uint8_t visible_window;  /* +14 */
+    uint8_t reserved;        /* +15 */
+    web_menu_row_record_t rows[WEB_MENU_ROW_TABLE_ROWS];
+};
+
 display_t make_web_menu_capture_display(menu_runtime_t &runtime, uint8_t width, uint8_t height);
 
 uint8_t web_menu_capture_row_count(void);
@@ -21,3 +62,7 @@ char const *web_menu_capture_row_text(int index);
 uint8_t web_menu_capture_visible_top(void);
 uint8_t web_menu_capture_visible_total(void);
 uint8_t web_menu_capture_visible_window(void);
+
+web_menu_row_table_t const *web_menu_capture_row_table(void);
+uint32_t web_menu_capture_row_generation(int index);
+uint32_t web_menu_capture_changed_since(uint32_t generation);
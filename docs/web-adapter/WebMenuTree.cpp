@@ -0,0 +1,233 @@
+#include "WebMenuTree.h"
+
+static_assert(sizeof(web_menu_tree_header_t) == 16, "tree header layout is shared with JS");
+static_assert(sizeof(web_menu_tree_record_t) == 24, "tree record layout is shared with JS");
+static_assert(sizeof(web_menu_state_record_t) == 8 + ((MENU_MAX_LINE + 3) & ~3), "state record layout is shared with JS");
+
+static uint8_t treeBytes[WEB_MENU_TREE_BYTES] __attribute__((aligned(4)));
+static web_menu_state_t menuState;
+
+static bool findItem(menu_runtime_t &runtime, uint16_t id, menu_cursor_t &cur, uint8_t &idx) {
+    menu_tree_iter_t it;
+    if (!menu_tree_seek(it, runtime.root().menu_ptr, runtime.root().ops, id)) {
+        return false;
+    }
+    cur = it.path[it.depth];
+    idx = cur.selected;
+    return true;
+}
+
+/* Appends a null-terminated string to the pool; returns its offset or 0 when full. */
+static uint16_t putText(uint32_t &used, menu_text_t text) {
+    uint32_t const start = used;
+    for (uint8_t i = 0; i < MENU_MAX_LINE; ++i) {
+        char const ch = menu_text_char_at(text, i);
+        if (used >= WEB_MENU_TREE_BYTES) {
+            used = start;
+            return 0;
+        }
+        treeBytes[used++] = static_cast<uint8_t>(ch);
+        if (!ch) {
+            return static_cast<uint16_t>(start);
+        }
+    }
+    if (used < WEB_MENU_TREE_BYTES) {
+        treeBytes[used++] = 0;
+        return static_cast<uint16_t>(start);
+    }
+    used = start;
+    return 0;
+}
+
+/* Value text exactly as format_line() puts it after "label: ". */
+static bool formatValue(menu_cursor_t const &cur, uint8_t idx, char *out, uint8_t cap) {
+    out[0] = '\0';
+    entry_t const tp = menu_runtime_t::menu_type_at(cur, idx);
+    bool const custom = menu_runtime_t::menu_format_value(cur, idx, out, cap);
+    if (custom) {
+        return true;
+    }
+    if (tp == ENTRY_INT || tp == ENTRY_VALUE) {
+        if (!menu_runtime_t::menu_scalar_has(cur, idx)) {
+            return false;
+        }
+        char nb[12];
+        menu_runtime_t::append_capped(out, cap, menu_runtime_t::int_to_str(menu_runtime_t::menu_int_get(cur, idx), nb, sizeof(nb)));
+        return true;
+    }
+    if (tp == ENTRY_BOOL || tp == ENTRY_SELECT) {
+        uint8_t const count = menu_runtime_t::menu_value_count(cur, idx);
+        if (!count) {
+            return false;
+        }
+        uint8_t const pos = menu_runtime_t::menu_value_selected(cur, idx);
+        if (pos < count) {
+            menu_runtime_t::append_capped(out, cap, menu_runtime_t::menu_value_label_at(cur, idx, pos));
+        } else {
+            menu_runtime_t::append_capped(out, cap, "?");
+        }
+        return true;
+    }
+    return false;
+}
+
+uint8_t const *web_menu_tree_build(menu_runtime_t &runtime, uint8_t window) {
+    web_menu_tree_header_t header = { WEB_MENU_TREE_VERSION, sizeof(web_menu_tree_header_t), sizeof(web_menu_tree_record_t), 0, 0, window, 0, 0 };
+    void const *root_ptr = runtime.root().menu_ptr;
+    menu_ops_t const *root_ops = runtime.root().ops;
+
+    uint16_t count = 0;
+    menu_tree_iter_t it;
+    for (bool ok = menu_tree_begin(it, root_ptr, root_ops); ok; ok = menu_tree_next(it)) {
+        ++count;
+    }
+    uint32_t used = sizeof(header) + static_cast<uint32_t>(count) * sizeof(web_menu_tree_record_t);
+    if (used > WEB_MENU_TREE_BYTES) {
+        return 0;
+    }
+    menu_cursor_t root = { root_ptr, root_ops, 0, 0 };
+    header.root_title = putText(used, menu_runtime_t::menu_title(root));
+    if (!header.root_title) {
+        return 0;
+    }
+
+    uint16_t parents[MENU_MAX_STACK];
+    uint16_t id = 0;
+    for (bool ok = menu_tree_begin(it, root_ptr, root_ops); ok && id < count; ok = menu_tree_next(it), ++id) {
+        menu_cursor_t const &cur = it.path[it.depth];
+        uint8_t const idx = cur.selected;
+        if (idx >= WEB_MENU_TREE_MAX_CHILDREN) {
+            return 0;
+        }
+        parents[it.depth] = id;
+        web_menu_tree_record_t rec = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        rec.parent = it.depth ? parents[it.depth - 1] : static_cast<uint16_t>(WEB_MENU_TREE_ROOT);
+        rec.type = static_cast<uint8_t>(menu_runtime_t::menu_type_at(cur, idx));
+        rec.index = idx;
+        rec.label = putText(used, menu_runtime_t::menu_label_at(cur, idx));
+        if (!rec.label) {
+            return 0;
+        }
+        if (rec.type == ENTRY_MENU) {
+            menu_cursor_t child = { 0, 0, 0, 0 };
+            if (it.depth + 1 < MENU_MAX_STACK && menu_runtime_t::menu_child_at(cur, idx, &child.menu_ptr, &child.ops) &&
+                !menu_ops_is_list(child.ops) && menu_runtime_t::menu_cursor_valid(child)) {
+                rec.flags |= WEB_MENU_TREE_HAS_CHILD;
+                rec.title = putText(used, menu_runtime_t::menu_title(child));
+                if (!rec.title) {
+                    return 0;
+                }
+            }
+        } else if (rec.type == ENTRY_BOOL || rec.type == ENTRY_SELECT) {
+            rec.value_count = menu_runtime_t::menu_value_count(cur, idx);
+        }
+        if (menu_runtime_t::menu_int_has(cur, idx)) {
+            int mn = menu_runtime_t::menu_int_min(cur, idx);
+            int mx = menu_runtime_t::menu_int_max(cur, idx);
+            menu_runtime_t::normalize_range(mn, mx);
+            rec.flags |= WEB_MENU_TREE_WRITABLE;
+            rec.min = mn;
+            rec.max = mx;
+            rec.step = menu_runtime_t::menu_int_step(cur, idx);
+        }
+        char text[MENU_MAX_LINE];
+        if (formatValue(cur, idx, text, sizeof(text))) {
+            rec.flags |= WEB_MENU_TREE_HAS_VALUE;
+        }
+        memcpy(treeBytes + sizeof(header) + static_cast<uint32_t>(id) * sizeof(rec), &rec, sizeof(rec));
+    }
+    header.item_count = count;
+    header.size = used;
+    memcpy(treeBytes, &header, sizeof(header));
+    return treeBytes;
+}
+
+web_menu_state_t const *web_menu_tree_menu_state(menu_runtime_t &runtime, uint16_t menu_id) {
+    menuState.version = WEB_MENU_TREE_VERSION;
+    menuState.record_size = sizeof(web_menu_state_record_t);
+    menuState.count = 0;
+
+    /* Children are consecutive in pre-order apart from the subtrees of MENU rows, which the
+       walk skips by stepping until it is back at the children's level. */
+    menu_tree_iter_t it;
+    if (!menu_tree_begin(it, runtime.root().menu_ptr, runtime.root().ops)) {
+        return &menuState;
+    }
+    if (menu_id != WEB_MENU_TREE_ROOT) {
+        if (!menu_tree_seek(it, runtime.root().menu_ptr, runtime.root().ops, menu_id)) {
+            return &menuState;
+        }
+        uint8_t const parent_depth = it.depth;
+        menu_cursor_t const &parent = it.path[parent_depth];
+        if (menu_runtime_t::menu_type_at(parent, parent.selected) != ENTRY_MENU || !menu_tree_next(it) ||
+            it.depth != parent_depth + 1) {
+            return &menuState;
+        }
+    }
+    menu_cursor_t const menu = it.path[it.depth];
+    uint8_t const level = it.depth;
+    uint8_t const total = menu_runtime_t::menu_count(menu);
+    for (uint8_t idx = 0; idx < total && menuState.count < WEB_MENU_TREE_MAX_CHILDREN; ++idx) {
+        while (it.valid && it.depth > level) {
+            menu_tree_next(it);
+        }
+        if (!it.valid || it.depth != level) {
+            break;
+        }
+        web_menu_state_record_t &rec = menuState.items[menuState.count++];
+        long value = 0;
+        rec.id = it.id;
+        rec.flags = static_cast<uint8_t>((menu_runtime_t::menu_hidden(menu, idx) ? WEB_MENU_STATE_HIDDEN : 0) |
+                                         (menu_runtime_t::menu_disabled(menu, idx) ? WEB_MENU_STATE_DISABLED : 0));
+        rec.reserved = 0;
+        rec.value = menu_runtime_t::menu_value_read(menu, idx, &value) ? static_cast<int32_t>(value) : 0;
+        formatValue(menu, idx, rec.text, sizeof(rec.text));
+        menu_tree_next(it);
+    }
+    return &menuState;
+}
+
+uint8_t web_menu_tree_set(menu_runtime_t &runtime, uint16_t id, long value) {
+    menu_cursor_t cur = { 0, 0, 0, 0 };
+    uint8_t idx = 0;
+    if (!findItem(runtime, id, cur, idx)) {
+        return MENU_VALUE_NOT_FOUND;
+    }
+    if (!menu_runtime_t::menu_selectable(cur, idx)) {
+        return MENU_VALUE_READ_ONLY;
+    }
+    return runtime.set_value(cur, idx, value);
+}
+
+bool web_menu_tree_edit(menu_runtime_t &runtime, uint16_t id, int value) {
+    menu_cursor_t cur = { 0, 0, 0, 0 };
+    uint8_t idx = 0;
+    if (!findItem(runtime, id, cur, idx) || !menu_runtime_t::menu_int_has(cur, idx)) {
+        return false;
+    }
+    menu_runtime_t::menu_int_set(cur, idx, value);
+    return true;
+}
+
+bool web_menu_tree_commit(menu_runtime_t &runtime, uint16_t id, int original) {
+    menu_cursor_t cur = { 0, 0, 0, 0 };
+    uint8_t idx = 0;
+    if (!findItem(runtime, id, cur, idx) || !menu_runtime_t::menu_int_has(cur, idx)) {
+        return false;
+    }
+    if (menu_runtime_t::menu_int_get(cur, idx) != original) {
+        runtime.notify_value_change(cur, idx);
+    }
+    return true;
+}
+
+bool web_menu_tree_activate(menu_runtime_t &runtime, uint16_t id) {
+    menu_cursor_t cur = { 0, 0, 0, 0 };
+    uint8_t idx = 0;
+    if (!findItem(runtime, id, cur, idx) || menu_runtime_t::menu_type_at(cur, idx) != ENTRY_FUNC ||
+        !menu_runtime_t::menu_selectable(cur, idx)) {
+        return false;
+    }
+    menu_runtime_t::menu_call_func(cur, idx);
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "WebMenuCapture.h"
+
+#include <stdint.h>
+
+/* Static tree metadata and per-menu state for browser-side navigation.
+
+   The tree table is built once and lists every item in pre-order (the ids used by
+   menu_tree_iter_t), so JS can move the highlight, scroll, and enter or leave submenus
+   without calling into wasm. Only value writes, actions, and predicate/value refreshes
+   cross the boundary. All multi-byte fields are little-endian. */
+#define WEB_MENU_TREE_VERSION 1
+
+#ifndef WEB_MENU_TREE_BYTES
+#define WEB_MENU_TREE_BYTES 4096
+#endif
+
+/* Most children one menu_state() call reports; trees with a larger menu are not exported. */
+#ifndef WEB_MENU_TREE_MAX_CHILDREN
+#define WEB_MENU_TREE_MAX_CHILDREN 24
+#endif
+
+#define WEB_MENU_TREE_ROOT 0xFFFFU
+
+enum web_menu_tree_flags_t {
+    WEB_MENU_TREE_HAS_CHILD = 1 << 0,   /* MENU row with a reachable submenu; never an ITEM_LIST */
+    WEB_MENU_TREE_WRITABLE  = 1 << 1,   /* INT/VALUE row with a setter: edited with min/max/step */
+    WEB_MENU_TREE_HAS_VALUE = 1 << 2    /* row shows a value after its label */
+};
+
+struct web_menu_tree_header_t {
+    uint16_t version;       /* +0  WEB_MENU_TREE_VERSION */
+    uint16_t header_size;   /* +2  offset of the first record */
+    uint16_t record_size;   /* +4 */
+    uint16_t item_count;    /* +6 */
+    uint16_t root_title;    /* +8  string offset of the root menu title */
+    uint8_t window;         /* +10 item rows shown at once */
+    uint8_t reserved;       /* +11 */
+    uint32_t size;          /* +12 bytes used, strings included */
+};
+
+struct web_menu_tree_record_t {
+    uint16_t parent;        /* +0  parent MENU item id, or WEB_MENU_TREE_ROOT */
+    uint8_t type;           /* +2  entry_t */
+    uint8_t flags;          /* +3  web_menu_tree_flags_t */
+    uint8_t value_count;    /* +4  BOOL/SELECT choices */
+    uint8_t index;          /* +5  row within the parent menu */
+    uint16_t label;         /* +6  string offset from the table start */
+    int32_t min;            /* +8 */
+    int32_t max;            /* +12 */
+    int32_t step;           /* +16 */
+    uint16_t title;         /* +20 submenu title string offset, or 0 */
+    uint16_t reserved;      /* +22 */
+};
+
+/* Returned by web_menu_tree_menu_state(): one record per child of the requested menu. */
+enum web_menu_state_flags_t {
+    WEB_MENU_STATE_HIDDEN   = 1 << 0,
+    WEB_MENU_STATE_DISABLED = 1 << 1
+};
+
+struct web_menu_state_record_t {
+    uint16_t id;            /* +0 */
+    uint8_t flags;          /* +2  web_menu_state_flags_t */
+    uint8_t reserved;       /* +3 */
+    int32_t value;          /* +4  INT/VALUE integer, BOOL/SELECT choice position */
+    char text[MENU_MAX_LINE]; /* +8  value text as the row shows it, or empty */
+};
+
+struct web_menu_state_t {
+    uint16_t version;       /* +0  WEB_MENU_TREE_VERSION */
+    uint16_t record_size;   /* +2 */
+    uint16_t count;         /* +4 */
+    uint16_t reserved;      /* +6 */
+    web_menu_state_record_t items[WEB_MENU_TREE_MAX_CHILDREN];
+};
+
+/* Returns 0 when the table would not fit WEB_MENU_TREE_BYTES or a menu has more than
+   WEB_MENU_TREE_MAX_CHILDREN rows; the adapter then keeps driving the runtime by rows. */
+uint8_t const *web_menu_tree_build(menu_runtime_t &runtime, uint8_t window);
+web_menu_state_t const *web_menu_tree_menu_state(menu_runtime_t &runtime, uint16_t menu_id);
+
+/* Validated write with change and persistence hooks (BOOL/SELECT cycling, direct sets). */
+uint8_t web_menu_tree_set(menu_runtime_t &runtime, uint16_t id, long value);
+/* In-progress edit: stores without hooks so the row can show the formatted value. */
+bool web_menu_tree_edit(menu_runtime_t &runtime, uint16_t id, int value);
+/* Ends an edit; runs the change hooks when the value differs from original. */
+bool web_menu_tree_commit(menu_runtime_t &runtime, uint16_t id, int original);
+bool web_menu_tree_activate(menu_runtime_t &runtime, uint16_t id);
@@ -1,8 +1,41 @@
 #include "WebMenuCapture.h"
+#include "WebMenuTree.h"
 
 #include <stddef.h>
 #include <stdint.h>
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+/* The module links with -nostdlib, so it supplies the few libc routines the runtime uses.
+   The simd profile (PROFILE=simd ./build.sh) compiles with -mbulk-memory -msimd128: copies
+   and fills become single memory.copy/memory.fill instructions and strlen scans 16 bytes at
+   a time. The default profile keeps the byte loops for engines without those features. */
+
+#if defined(__wasm_simd128__)
+extern "C" size_t strlen(char const *s) {
+    if (!s) {
+        return 0;
+    }
+    char const *p = s;
+    while (reinterpret_cast<uintptr_t>(p) & 15U) {
+        if (!*p) {
+            return static_cast<size_t>(p - s);
+        }
+        ++p;
+    }
+    /* Aligned 16-byte loads never cross a page, so reading past the terminator stays in bounds. */
+    for (;;) {
+        v128_t const chunk = wasm_v128_load(p);
+        uint32_t const zeros = wasm_i8x16_bitmask(wasm_i8x16_eq(chunk, wasm_i8x16_splat(0)));
+        if (zeros) {
+            return static_cast<size_t>(p - s) + static_cast<size_t>(__builtin_ctz(zeros));
+        }
+        p += 16;
+    }
+}
+#else
 extern "C" size_t strlen(char const *s) {
     size_t n = 0;
     while (s && s[n]) {
@@ -10,7 +43,21 @@ extern "C" size_t strlen(char const *s) {
     }
     return n;
 }
+#endif
 
+#if defined(__wasm_bulk_memory__)
+extern "C" void *memcpy(void *dst, void const *src, size_t n) {
+    return __builtin_memcpy(dst, src, n);
+}
+
+extern "C" void *memmove(void *dst, void const *src, size_t n) {
+    return __builtin_memmove(dst, src, n);
+}
+
+extern "C" void *memset(void *dst, int value, size_t n) {
+    return __builtin_memset(dst, value, n);
+}
+#else
 extern "C" void *memcpy(void *dst, void const *src, size_t n) {
     char *d = static_cast<char *>(dst);
     char const *s = static_cast<char const *>(src);
@@ -42,9 +89,17 @@ extern "C" void *memset(void *dst, int value, size_t n) {
     }
     return dst;
 }
+#endif
+
+static_assert(sizeof(menu_event_t) == 8, "JS packs menu_event_t as u32 choice, u8 row, i8 delta, u8 flags, pad");
 
 static menu_runtime_t runtime;
-static menu_event_t pendingEvent = menu_event(Choice_Invalid);
+static uint8_t const *treeTable = 0;
+
+/* Events written by JS into linear memory; bm_send_events() drains them through the queued input. */
+static menu_event_t eventBuffer[32];
+static menu_event_t const *queuedEvents = 0;
+static int queuedCount = 0;
 
 static int driveMode = 1;
 static int maxSpeedPct = 65;
@@ -239,9 +294,23 @@ static void formatUptime(void *ctx, char *out, uint8_t cap) {
 }
 
 static menu_event_t readEvent(void *) {
-    menu_event_t event = pendingEvent;
-    pendingEvent = menu_event(Choice_Invalid);
-    return event;
+    if (queuedCount <= 0) {
+        return menu_event(Choice_Invalid);
+    }
+    --queuedCount;
+    return *queuedEvents++;
+}
+
+/* One service() per event with rendering off, then a single render of the final state. */
+static void runQueued(menu_event_t const *events, int count) {
+    queuedEvents = events;
+    queuedCount = count;
+    runtime.set_headless(true);
+    while (queuedCount > 0) {
+        runtime.service();
+    }
+    runtime.set_headless(false);
+    runtime.service();
 }
 
 static input_ops_t const WEB_INPUT_OPS = {
@@ -312,25 +381,39 @@ extern "C" __attribute__((export_name("bm_init"))) void bm_init(void) {
             ITEM_MENU("System", systemMenu)
         );
 
-    display_t webDisplay = make_web_menu_capture_display(runtime, 60, 6);
+    display_t webDisplay = make_web_menu_capture_display(runtime, 60, WEB_MENU_CAPTURE_WINDOW + 1);
     runtime = menu_runtime_t::make(rootMenu, webDisplay, webInput, false);
     runtime.set_show_title(true);
     runtime.set_show_breadcrumbs(true);
     runtime.set_show_affordances(false);
     runtime.begin();
     runtime.service();
+    treeTable = web_menu_tree_build(runtime, WEB_MENU_CAPTURE_WINDOW);
 }
 
 extern "C" __attribute__((export_name("bm_send_choice"))) void bm_send_choice(int choice) {
-    pendingEvent = menu_event(static_cast<choice_t>(choice));
-    runtime.service();
-    runtime.service();
+    menu_event_t const event = menu_event(static_cast<choice_t>(choice));
+    runQueued(&event, 1);
 }
 
 extern "C" __attribute__((export_name("bm_send_row"))) void bm_send_row(int row, int activate) {
-    pendingEvent = menu_row_event(static_cast<uint8_t>(row), activate != 0);
-    runtime.service();
-    runtime.service();
+    menu_event_t const event = menu_row_event(static_cast<uint8_t>(row), activate != 0);
+    runQueued(&event, 1);
+}
+
+extern "C" __attribute__((export_name("bm_event_buffer"))) int bm_event_buffer(void) {
+    return static_cast<int>(reinterpret_cast<uintptr_t>(eventBuffer));
+}
+
+extern "C" __attribute__((export_name("bm_event_capacity"))) int bm_event_capacity(void) {
+    return static_cast<int>(sizeof(eventBuffer) / sizeof(eventBuffer[0]));
+}
+
+extern "C" __attribute__((export_name("bm_send_events"))) void bm_send_events(int ptr, int count) {
+    if (!ptr || count <= 0) {
+        return;
+    }
+    runQueued(reinterpret_cast<menu_event_t const *>(static_cast<uintptr_t>(ptr)), count);
 }
 
 extern "C" __attribute__((export_name("bm_row_count"))) int bm_row_count(void) {
@@ -362,6 +445,38 @@ extern "C" __attribute__((export_name("bm_row_text_ptr"))) int bm_row_text_ptr(i
     return text ? static_cast<int>(reinterpret_cast<uintptr_t>(text)) : 0;
 }
 
+extern "C" __attribute__((export_name("bm_row_table"))) int bm_row_table(void) {
+    return static_cast<int>(reinterpret_cast<uintptr_t>(web_menu_capture_row_table()));
+}
+
+extern "C" __attribute__((export_name("bm_rows_changed_since"))) int bm_rows_changed_since(int generation) {
+    return static_cast<int>(web_menu_capture_changed_since(static_cast<uint32_t>(generation)));
+}
+
+extern "C" __attribute__((export_name("bm_tree_table"))) int bm_tree_table(void) {
+    return static_cast<int>(reinterpret_cast<uintptr_t>(treeTable));
+}
+
+extern "C" __attribute__((export_name("bm_menu_state"))) int bm_menu_state(int menu_id) {
+    return static_cast<int>(reinterpret_cast<uintptr_t>(web_menu_tree_menu_state(runtime, static_cast<uint16_t>(menu_id))));
+}
+
+extern "C" __attribute__((export_name("bm_item_set"))) int bm_item_set(int id, int value) {
+    return web_menu_tree_set(runtime, static_cast<uint16_t>(id), value);
+}
+
+extern "C" __attribute__((export_name("bm_item_edit"))) int bm_item_edit(int id, int value) {
+    return web_menu_tree_edit(runtime, static_cast<uint16_t>(id), value) ? 1 : 0;
+}
+
+extern "C" __attribute__((export_name("bm_item_commit"))) int bm_item_commit(int id, int original) {
+    return web_menu_tree_commit(runtime, static_cast<uint16_t>(id), original) ? 1 : 0;
+}
+
+extern "C" __attribute__((export_name("bm_item_activate"))) int bm_item_activate(int id) {
+    return web_menu_tree_activate(runtime, static_cast<uint16_t>(id)) ? 1 : 0;
+}
+
 extern "C" __attribute__((export_name("bm_battery_centivolts"))) int bm_battery_centivolts(void) {
     return battCentiV;
 }
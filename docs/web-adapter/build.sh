@@ -7,6 +7,11 @@ usage() {
   cat <<'EOF'
 Builds bettermenu_demo.wasm from the WebAssembly adapter sources.
 
+Profiles:
+  scalar  (default) portable build -> bettermenu_demo.wasm
+  simd    bulk-memory + SIMD128 build -> bettermenu_demo_simd.wasm
+          The DOM adapter loads it only when the browser supports both features.
+
 Requirements:
   - A C++ compiler driver that supports --target=wasm32 and WebAssembly linking.
   - Optional: wasm-strip or llvm-strip to remove nonessential metadata.
@@ -15,6 +20,7 @@ Usage:
   ./build.sh
   CXX="<wasm-capable-c++>" ./build.sh
   CXX="<wasm-capable-c++>" WASM_STRIP="<wasm-strip-tool>" ./build.sh
+  PROFILE=simd ./build.sh
 
 If the default CXX=c++ cannot compile for wasm32, install a WebAssembly-capable
 C++ toolchain and set CXX to that compiler when running this script.
@@ -36,6 +42,23 @@ esac
 
 CXX="${CXX:-c++}"
 WASM_STRIP="${WASM_STRIP:-}"
+PROFILE="${PROFILE:-scalar}"
+
+case "$PROFILE" in
+  scalar)
+    OUTPUT=bettermenu_demo.wasm
+    FEATURE_FLAGS=""
+    ;;
+  simd)
+    OUTPUT=bettermenu_demo_simd.wasm
+    FEATURE_FLAGS="-mbulk-memory -msimd128"
+    ;;
+  *)
+    echo "error: unknown PROFILE: $PROFILE" >&2
+    usage >&2
+    exit 2
+    ;;
+esac
 
 if ! command -v "$CXX" >/dev/null 2>&1; then
   echo "error: CXX does not name an executable compiler: $CXX" >&2
@@ -48,6 +71,7 @@ fi
   --target=wasm32 \
   -std=c++11 \
   -Os \
+  $FEATURE_FLAGS \
   -Iwasm-shim \
   -fno-exceptions \
   -fno-rtti \
@@ -58,6 +82,9 @@ fi
   -Wl,--export=bm_init \
   -Wl,--export=bm_send_choice \
   -Wl,--export=bm_send_row \
+  -Wl,--export=bm_send_events \
+  -Wl,--export=bm_event_buffer \
+  -Wl,--export=bm_event_capacity \
   -Wl,--export=bm_row_count \
   -Wl,--export=bm_row_kind \
   -Wl,--export=bm_row_flags \
@@ -65,20 +92,29 @@ fi
   -Wl,--export=bm_row_item_index \
   -Wl,--export=bm_row_editable \
   -Wl,--export=bm_row_text_ptr \
+  -Wl,--export=bm_row_table \
+  -Wl,--export=bm_rows_changed_since \
+  -Wl,--export=bm_tree_table \
+  -Wl,--export=bm_menu_state \
+  -Wl,--export=bm_item_set \
+  -Wl,--export=bm_item_edit \
+  -Wl,--export=bm_item_commit \
+  -Wl,--export=bm_item_activate \
   -Wl,--export=bm_battery_centivolts \
   -Wl,--export=bm_battery_percent \
   -Wl,--export=bm_armed \
   -Wl,--export=bm_visible_top \
   -Wl,--export=bm_visible_total \
   -Wl,--export=bm_visible_window \
-  -o bettermenu_demo.wasm \
+  -o "$OUTPUT" \
   bettermenu_wasm.cpp \
-  WebMenuCapture.cpp
+  WebMenuCapture.cpp \
+  WebMenuTree.cpp
 
 if [ -n "$WASM_STRIP" ]; then
-  "$WASM_STRIP" bettermenu_demo.wasm
+  "$WASM_STRIP" "$OUTPUT"
 elif command -v wasm-strip >/dev/null 2>&1; then
-  wasm-strip bettermenu_demo.wasm
+  wasm-strip "$OUTPUT"
 elif command -v llvm-strip >/dev/null 2>&1; then
-  llvm-strip bettermenu_demo.wasm
+  llvm-strip "$OUTPUT"
 fi
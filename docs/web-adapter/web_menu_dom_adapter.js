@@ -4,9 +4,13 @@ const Choice = {
   Up: 3,
   Down: 4,
   Select: 5,
-  Cancel: 6
+  Cancel: 6,
+  Row: 7
 };
 
+const EventActivate = 1 << 0;
+const EventSize = 8; // menu_event_t: u32 choice, u8 row, i8 delta, u8 flags, pad
+
 const Kind = {
   Title: 1,
   Item: 2,
@@ -39,9 +43,99 @@ let bodyElement;
 let content = {};
 let icons = {};
 let wasmPath = "./bettermenu_demo.wasm";
+let simdWasmPath = "";
 let wasm;
 let memory;
 let resizeFrame = 0;
+let lastFrame = -1;
+let pendingEvents = [];
+let eventFrame = 0;
+// Title row of the last rendered frame; row clicks record it to tell menus apart.
+let frameMenu = "";
+
+// Keyed reconciliation state: row nodes are keyed by BetterMenu item index and patched in place.
+const rowNodes = new Map();
+let headerNode = null;
+let headerKey = "";
+let scrollbarNode = null;
+let scrollbarKey = "";
+let contentKey = null;
+
+const decoder = new TextDecoder();
+
+// Smallest modules that use a SIMD128 instruction and memory.copy; validate() rejects them
+// on engines without the feature, which selects the scalar build.
+const SimdProbe = new Uint8Array([0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11]);
+const BulkMemoryProbe = new Uint8Array([0, 97, 115, 109, 1, 0, 0, 0, 1, 4, 1, 96, 0, 0, 3, 2, 1, 0, 5, 3, 1, 0, 1, 10, 14, 1, 12, 0, 65, 0, 65, 0, 65, 0, 252, 10, 0, 0, 11]);
+
+// Layout of the row table returned by bm_row_table(); see WebMenuCapture.h.
+const RowTable = {
+  Version: 0,
+  HeaderSize: 2,
+  RecordSize: 4,
+  RowCount: 6,
+  Frame: 8,
+  VisibleTop: 12,
+  VisibleTotal: 13,
+  VisibleWindow: 14,
+  RecordItemIndex: 1,
+  RecordKind: 2,
+  RecordType: 3,
+  RecordFlags: 4,
+  RecordEditable: 5,
+  RecordGeneration: 8,
+  RecordText: 12
+};
+const RowTableVersion = 2;
+// Decoded rows by display row; reused while the row's generation is unchanged.
+let rowCache = [];
+
+// Layout of the tree table from bm_tree_table() and the state from bm_menu_state(); see WebMenuTree.h.
+const TreeTable = {
+  Version: 0,
+  HeaderSize: 2,
+  RecordSize: 4,
+  ItemCount: 6,
+  RootTitle: 8,
+  Window: 10,
+  RecordParent: 0,
+  RecordType: 2,
+  RecordFlags: 3,
+  RecordValueCount: 4,
+  RecordLabel: 6,
+  RecordMin: 8,
+  RecordMax: 12,
+  RecordStep: 16,
+  RecordTitle: 20
+};
+const TreeVersion = 1;
+const TreeRoot = 0xffff;
+const TreeFlags = {
+  HasChild: 1 << 0,
+  Writable: 1 << 1,
+  HasValue: 1 << 2
+};
+const MenuState = {
+  RecordSize: 2,
+  Count: 4,
+  Records: 8,
+  RecordId: 0,
+  RecordFlags: 2,
+  RecordValue: 4,
+  RecordText: 8
+};
+const StateFlags = {
+  Hidden: 1 << 0,
+  Disabled: 1 << 1
+};
+
+// Local navigation state, used when the module exports its tree: the highlight, scroll
+// position, and submenu stack live in JS, and wasm is called only to read or write values
+// and run actions.
+let tree = null;
+const nav = { stack: [], editing: null, frame: 0 };
+const stateCache = new Map();
+let status = null;
 
 function iconUrl(name) {
   return `url("./icons/${name}.svg")`;
@@ -65,7 +159,7 @@ function batteryTone(percent) {
   return "low";
 }
 
-function renderHeader(text, flags) {
+function renderHeader(text, flags, armed, percent) {
   const header = document.createElement("div");
   header.className = "menu-header";
   if (flags & Flags.BackAvailable) header.classList.add("has-back");
@@ -100,12 +194,10 @@ function renderHeader(text, flags) {
   const stateGroup = document.createElement("div");
   stateGroup.className = "header-state-group";
 
-  const armed = wasm.bm_armed() !== 0;
   const chip = document.createElement("span");
   chip.className = `state-chip ${armed ? "armed" : "ready"}`;
   chip.innerHTML = `<span aria-hidden="true"></span>${armed ? "ARMED" : "READY"}`;
 
-  const percent = wasm.bm_battery_percent();
   const battery = document.createElement("span");
   battery.className = `battery-meter ${batteryTone(percent)}`;
   battery.setAttribute("aria-label", `Battery ${percent}%`);
@@ -127,12 +219,87 @@ function renderHeader(text, flags) {
   return header;
 }
 
-function sendChoice(choice) {
+// Input is queued and handed to the runtime once per animation frame, so key repeat or
+// rapid clicks cost one wasm call and one render instead of one per event.
+function queueEvent(choice, row = 0, flags = 0, target = null) {
   if (!wasm) return;
-  wasm.bm_send_choice(choice);
+  pendingEvents.push({ choice, row, flags, target });
+  if (!eventFrame) eventFrame = requestAnimationFrame(flushEvents);
+}
+
+// A click names the item it landed on, not only its display row: a key press queued
+// before it in the same frame may scroll the window or open another menu.
+function queueRowEvent(record) {
+  if (!record.source) return;
+  queueEvent(Choice.Row, record.displayRow, EventActivate, { item: record.source.itemIndex, menu: frameMenu });
+}
+
+function sendEvents(events) {
+  if (!events.length) return;
+  if (wasm.bm_send_events && wasm.bm_event_buffer) {
+    const ptr = wasm.bm_event_buffer();
+    const capacity = wasm.bm_event_capacity();
+    for (let start = 0; start < events.length; start += capacity) {
+      const batch = events.slice(start, start + capacity);
+      const view = new DataView(memory.buffer, ptr, batch.length * EventSize);
+      batch.forEach(({ choice, row, flags }, i) => {
+        const offset = i * EventSize;
+        view.setUint32(offset, choice, true);
+        view.setUint8(offset + 4, row);
+        view.setInt8(offset + 5, 0);
+        view.setUint8(offset + 6, flags);
+        view.setUint8(offset + 7, 0);
+      });
+      wasm.bm_send_events(ptr, batch.length);
+    }
+  } else {
+    // Modules built before bm_send_events take one event per call.
+    events.forEach(({ choice, row, flags }) => {
+      if (choice === Choice.Row) wasm.bm_send_row(row, flags & EventActivate);
+      else wasm.bm_send_choice(choice);
+    });
+  }
+}
+
+// Display row showing a clicked item in the runtime's current frame, or -1 once that
+// item has scrolled away or its menu has closed.
+function currentRow({ item, menu }) {
+  const rows = readFrame().rows;
+  const title = rows.find((row) => row.kind === Kind.Title);
+  if ((title ? title.text : "") !== menu) return -1;
+  return rows.findIndex((row) => row.kind === Kind.Item && row.itemIndex === item);
+}
+
+function flushEvents() {
+  eventFrame = 0;
+  const events = pendingEvents;
+  pendingEvents = [];
+  if (!events.length) return;
+
+  if (tree) {
+    events.forEach(handleLocalEvent);
+  } else {
+    // Events before a click are sent first, so the click resolves against the frame they leave.
+    let batch = [];
+    events.forEach((event) => {
+      if (event.target) {
+        sendEvents(batch);
+        batch = [];
+        const row = currentRow(event.target);
+        if (row < 0) return;
+        event = { ...event, row };
+      }
+      batch.push(event);
+    });
+    sendEvents(batch);
+  }
   render();
 }
 
+function sendChoice(choice) {
+  queueEvent(choice);
+}
+
 function editButton(choice, iconName, label) {
   const button = document.createElement("button");
   button.className = "edit-button";
@@ -160,33 +327,320 @@ function editControls(valueText) {
   return controls;
 }
 
-function renderScrollbar() {
-  const total = wasm.bm_visible_total();
-  const windowSize = wasm.bm_visible_window();
-  if (total <= windowSize || windowSize <= 0) return null;
-
-  const track = document.createElement("div");
-  track.className = "menu-scrollbar";
-  track.setAttribute("aria-hidden", "true");
+function renderScrollbar(frame) {
+  const total = frame.visibleTotal;
+  const windowSize = frame.visibleWindow;
+  if (total <= windowSize || windowSize <= 0) {
+    scrollbarNode = null;
+    scrollbarKey = "";
+    return null;
+  }
 
-  const thumb = document.createElement("span");
   const thumbHeight = Math.max(18, Math.round((windowSize / total) * 100));
   const denom = Math.max(1, total - windowSize);
-  const top = Math.round(((100 - thumbHeight) * wasm.bm_visible_top()) / denom);
+  const top = Math.round(((100 - thumbHeight) * frame.visibleTop) / denom);
+  const key = `${thumbHeight}|${top}`;
+  if (scrollbarNode && key === scrollbarKey) return scrollbarNode;
+
+  if (!scrollbarNode) {
+    scrollbarNode = document.createElement("div");
+    scrollbarNode.className = "menu-scrollbar";
+    scrollbarNode.setAttribute("aria-hidden", "true");
+    scrollbarNode.append(document.createElement("span"));
+  }
+  const thumb = scrollbarNode.firstElementChild;
   thumb.style.height = `${thumbHeight}%`;
   thumb.style.top = `${top}%`;
-  track.append(thumb);
-  return track;
+  scrollbarKey = key;
+  return scrollbarNode;
 }
 
-function readCString(ptr) {
+function readCString(ptr, bytes = new Uint8Array(memory.buffer)) {
   if (!ptr) return "";
-  const bytes = new Uint8Array(memory.buffer);
   let end = ptr;
   while (bytes[end] !== 0) {
     end += 1;
   }
-  return new TextDecoder().decode(bytes.subarray(ptr, end));
+  return decoder.decode(bytes.subarray(ptr, end));
+}
+
+// Reads the whole captured frame from the shared row table in one pass. Modules built
+// before bm_row_table existed fall back to one export call per field.
+function readFrame() {
+  const tablePtr = wasm.bm_row_table ? wasm.bm_row_table() : 0;
+  const view = tablePtr ? new DataView(memory.buffer, tablePtr) : null;
+  if (view && view.getUint16(RowTable.Version, true) === RowTableVersion) {
+    const bytes = new Uint8Array(memory.buffer);
+    const headerSize = view.getUint16(RowTable.HeaderSize, true);
+    const recordSize = view.getUint16(RowTable.RecordSize, true);
+    const rows = [];
+    const count = view.getUint8(RowTable.RowCount);
+    for (let i = 0; i < count; i += 1) {
+      const record = headerSize + i * recordSize;
+      const generation = view.getUint32(record + RowTable.RecordGeneration, true);
+      if (rowCache[i] && rowCache[i].generation === generation) {
+        rows.push(rowCache[i]);
+        continue;
+      }
+      const row = {
+        generation,
+        itemIndex: view.getUint8(record + RowTable.RecordItemIndex),
+        kind: view.getUint8(record + RowTable.RecordKind),
+        flags: view.getUint8(record + RowTable.RecordFlags),
+        type: view.getUint8(record + RowTable.RecordType),
+        editable: view.getUint8(record + RowTable.RecordEditable) !== 0,
+        text: readCString(tablePtr + record + RowTable.RecordText, bytes)
+      };
+      rowCache[i] = row;
+      rows.push(row);
+    }
+    return {
+      frame: view.getUint32(RowTable.Frame, true),
+      visibleTop: view.getUint8(RowTable.VisibleTop),
+      visibleTotal: view.getUint8(RowTable.VisibleTotal),
+      visibleWindow: view.getUint8(RowTable.VisibleWindow),
+      rows
+    };
+  }
+
+  const rows = [];
+  const count = wasm.bm_row_count();
+  for (let i = 0; i < count; i += 1) {
+    rows.push({
+      itemIndex: wasm.bm_row_item_index(i),
+      kind: wasm.bm_row_kind(i),
+      flags: wasm.bm_row_flags(i),
+      type: wasm.bm_row_entry_type(i),
+      editable: wasm.bm_row_editable(i) !== 0,
+      text: readCString(wasm.bm_row_text_ptr(i))
+    });
+  }
+  return {
+    frame: -1,
+    visibleTop: wasm.bm_visible_top(),
+    visibleTotal: wasm.bm_visible_total(),
+    visibleWindow: wasm.bm_visible_window(),
+    rows
+  };
+}
+
+// Reads the static tree once after bm_init(). Returns null for modules built without it and
+// for trees too large to export, which keep sending input to the runtime.
+function readTree() {
+  const ptr = wasm.bm_tree_table && wasm.bm_menu_state ? wasm.bm_tree_table() : 0;
+  if (!ptr) return null;
+  const view = new DataView(memory.buffer, ptr);
+  if (view.getUint16(TreeTable.Version, true) !== TreeVersion) return null;
+  const bytes = new Uint8Array(memory.buffer);
+  const string = (offset) => (offset ? readCString(ptr + offset, bytes) : "");
+
+  const headerSize = view.getUint16(TreeTable.HeaderSize, true);
+  const recordSize = view.getUint16(TreeTable.RecordSize, true);
+  const count = view.getUint16(TreeTable.ItemCount, true);
+  if (!count) return null;
+  const items = [];
+  const children = new Map([[TreeRoot, []]]);
+  for (let id = 0; id < count; id += 1) {
+    const record = headerSize + id * recordSize;
+    const item = {
+      id,
+      parent: view.getUint16(record + TreeTable.RecordParent, true),
+      type: view.getUint8(record + TreeTable.RecordType),
+      flags: view.getUint8(record + TreeTable.RecordFlags),
+      valueCount: view.getUint8(record + TreeTable.RecordValueCount),
+      label: string(view.getUint16(record + TreeTable.RecordLabel, true)),
+      min: view.getInt32(record + TreeTable.RecordMin, true),
+      max: view.getInt32(record + TreeTable.RecordMax, true),
+      step: view.getInt32(record + TreeTable.RecordStep, true),
+      title: string(view.getUint16(record + TreeTable.RecordTitle, true))
+    };
+    items.push(item);
+    if (!children.has(item.parent)) children.set(item.parent, []);
+    children.get(item.parent).push(id);
+  }
+  return {
+    items,
+    children,
+    rootTitle: string(view.getUint16(TreeTable.RootTitle, true)),
+    window: view.getUint8(TreeTable.Window)
+  };
+}
+
+// Visibility, enablement, and value text for one menu's children; one wasm call per menu
+// until the next write invalidates it.
+function menuState(menu) {
+  let state = stateCache.get(menu);
+  if (state) return state;
+  state = new Map();
+  const ptr = wasm.bm_menu_state(menu);
+  if (ptr) {
+    const view = new DataView(memory.buffer, ptr);
+    const bytes = new Uint8Array(memory.buffer);
+    const recordSize = view.getUint16(MenuState.RecordSize, true);
+    const count = view.getUint16(MenuState.Count, true);
+    for (let i = 0; i < count; i += 1) {
+      const record = MenuState.Records + i * recordSize;
+      const flags = view.getUint8(record + MenuState.RecordFlags);
+      state.set(view.getUint16(record + MenuState.RecordId, true), {
+        hidden: (flags & StateFlags.Hidden) !== 0,
+        disabled: (flags & StateFlags.Disabled) !== 0,
+        value: view.getInt32(record + MenuState.RecordValue, true),
+        text: readCString(ptr + record + MenuState.RecordText, bytes)
+      });
+    }
+  }
+  stateCache.set(menu, state);
+  return state;
+}
+
+function invalidateState() {
+  stateCache.clear();
+  status = null;
+}
+
+function currentLevel() {
+  return nav.stack[nav.stack.length - 1];
+}
+
+// Shown children of the current menu, in display order.
+function visibleItems(level) {
+  const state = menuState(level.menu);
+  return (tree.children.get(level.menu) || []).filter((id) => !(state.get(id) || {}).hidden);
+}
+
+function selectable(level, id) {
+  const entry = menuState(level.menu).get(id);
+  return Boolean(entry) && !entry.hidden && !entry.disabled;
+}
+
+function enterMenu(menu) {
+  const level = { menu, selected: -1, top: 0 };
+  nav.stack.push(level);
+  level.selected = visibleItems(level).find((id) => selectable(level, id)) ?? -1;
+}
+
+// Keeps the highlight inside the scroll window, as the runtime does.
+function scrollToSelection(level, visible) {
+  const pos = visible.indexOf(level.selected);
+  if (pos < 0) return;
+  if (pos < level.top) level.top = pos;
+  if (pos >= level.top + tree.window) level.top = pos - tree.window + 1;
+}
+
+function moveSelection(level, dir) {
+  const visible = visibleItems(level);
+  let pos = visible.indexOf(level.selected);
+  for (let next = pos + dir; next >= 0 && next < visible.length; next += dir) {
+    if (selectable(level, visible[next])) {
+      pos = next;
+      break;
+    }
+  }
+  if (pos >= 0) level.selected = visible[pos];
+  scrollToSelection(level, visible);
+}
+
+function activateSelection(level) {
+  if (!selectable(level, level.selected)) return;
+  const item = tree.items[level.selected];
+  const value = menuState(level.menu).get(item.id).value;
+  if (item.type === Type.Menu) {
+    if (item.flags & TreeFlags.HasChild) enterMenu(item.id);
+  } else if (item.flags & TreeFlags.Writable) {
+    nav.editing = { id: item.id, original: value, value: Math.min(item.max, Math.max(item.min, value)) };
+    if (nav.editing.value !== value) wasm.bm_item_edit(item.id, nav.editing.value);
+    invalidateState();
+  } else if ((item.type === Type.Bool || item.type === Type.Select) && item.valueCount) {
+    wasm.bm_item_set(item.id, (value + 1) % item.valueCount);
+    invalidateState();
+  } else if (item.type === Type.Func) {
+    wasm.bm_item_activate(item.id);
+    invalidateState();
+  }
+}
+
+function handleEditEvent(choice) {
+  const editing = nav.editing;
+  const item = tree.items[editing.id];
+  if (choice === Choice.Up || choice === Choice.Right) {
+    editing.value = Math.min(item.max, editing.value + item.step);
+  } else if (choice === Choice.Down || choice === Choice.Left) {
+    editing.value = Math.max(item.min, editing.value - item.step);
+  } else if (choice === Choice.Select) {
+    wasm.bm_item_commit(editing.id, editing.original);
+    nav.editing = null;
+    invalidateState();
+    return;
+  } else if (choice === Choice.Cancel) {
+    wasm.bm_item_edit(editing.id, editing.original);
+    nav.editing = null;
+    invalidateState();
+    return;
+  } else {
+    return;
+  }
+  wasm.bm_item_edit(editing.id, editing.value);
+  invalidateState();
+}
+
+function handleLocalEvent({ choice, row, flags, target }) {
+  nav.frame += 1;
+  if (nav.editing) {
+    handleEditEvent(choice);
+    return;
+  }
+  const level = currentLevel();
+  if (choice === Choice.Up) moveSelection(level, -1);
+  else if (choice === Choice.Down) moveSelection(level, 1);
+  else if (choice === Choice.Right || choice === Choice.Select) activateSelection(level);
+  else if ((choice === Choice.Left || choice === Choice.Cancel) && nav.stack.length > 1) nav.stack.pop();
+  else if (choice === Choice.Row) {
+    const visible = visibleItems(level);
+    const id = target ? target.item : visible[level.top + row - 1];
+    if (id === undefined || !visible.includes(id) || !selectable(level, id)) return;
+    level.selected = id;
+    if (flags & EventActivate) activateSelection(level);
+  }
+}
+
+// Builds the same rows the capture display would produce, from the tree and cached state.
+function localFrame() {
+  const level = currentLevel();
+  const state = menuState(level.menu);
+  const visible = visibleItems(level);
+  const titles = nav.stack.slice(1).map(({ menu }) => tree.items[menu].title || tree.items[menu].label);
+  const rows = [
+    {
+      kind: Kind.Title,
+      itemIndex: TreeRoot,
+      flags: nav.stack.length > 1 ? Flags.BackAvailable : 0,
+      type: 0,
+      editable: false,
+      text: [tree.rootTitle, ...titles].join("/")
+    }
+  ];
+  visible.slice(level.top, level.top + tree.window).forEach((id) => {
+    const item = tree.items[id];
+    const entry = state.get(id);
+    const selected = id === level.selected && !entry.disabled;
+    const editing = Boolean(nav.editing) && nav.editing.id === id;
+    let flags = 0;
+    if (selected) flags |= Flags.Selected;
+    if (editing) flags |= Flags.Editing;
+    if (entry.disabled) flags |= Flags.Disabled;
+    if (item.flags & TreeFlags.HasChild) flags |= Flags.HasChild;
+    let text = `${selected ? ">" : " "}${item.label}`;
+    if (item.flags & TreeFlags.HasValue) text += `: ${entry.text}`;
+    if (editing) text += "  (edit)";
+    rows.push({ kind: Kind.Item, itemIndex: id, flags, type: item.type, editable: (item.flags & TreeFlags.Writable) !== 0, text });
+  });
+  return {
+    frame: nav.frame,
+    visibleTop: level.top,
+    visibleTotal: visible.length,
+    visibleWindow: tree.window,
+    rows
+  };
 }
 
 function parseLine(text) {
@@ -206,6 +660,8 @@ function selectedLabel(rows) {
 
 function updateContent(rows) {
   const label = selectedLabel(rows);
+  if (label === contentKey) return;
+  contentKey = label;
   const entry = content[label] || [
     label || "BetterMenu",
     "This content pane is ordinary HTML keyed from the row currently selected by the C++ BetterMenu runtime."
@@ -247,87 +703,181 @@ function reserveContentPanelHeight() {
   }
 }
 
-function render() {
-  const rows = [];
-  const count = wasm.bm_row_count();
-  menuElement.textContent = "";
+function setClass(record, name, on) {
+  if (Boolean(record.classes[name]) === on) return;
+  record.classes[name] = on;
+  record.element.classList.toggle(name, on);
+}
 
-  for (let i = 0; i < count; i += 1) {
-    const kind = wasm.bm_row_kind(i);
-    const flags = wasm.bm_row_flags(i);
-    const type = wasm.bm_row_entry_type(i);
-    const editable = wasm.bm_row_editable(i) !== 0;
-    const text = readCString(wasm.bm_row_text_ptr(i));
-    rows.push({ kind, flags, type, text, editable });
-
-    if (kind === Kind.Blank) continue;
-    if (kind === Kind.Title) {
-      menuElement.append(renderHeader(text, flags));
-      continue;
-    }
+function createRowNode() {
+  const element = document.createElement("div");
+  element.className = "row";
+  const icon = document.createElement("span");
+  icon.className = "row-icon";
+  icon.setAttribute("aria-hidden", "true");
+  const label = document.createElement("span");
+  label.className = "label";
+  element.append(icon, label);
+
+  const record = { element, icon, label, value: null, classes: {}, iconName: "", labelText: null, valueKey: "", editValue: null, displayRow: 0, source: null };
+  element.addEventListener("click", () => {
+    queueRowEvent(record);
+  });
+  return record;
+}
+
+// Rebuilds the value cell only when what it shows changes; while editing, only the number is patched.
+function patchValue(record, flags, type, valueText) {
+  const isMenu = type === Type.Menu || (flags & Flags.HasChild) !== 0;
+  const editing = (flags & Flags.Editing) !== 0 && valueText !== "";
+  const locked = (flags & Flags.Disabled) !== 0;
+  const key = editing ? "edit" : isMenu ? "menu" : `text|${locked}|${valueText}`;
+  if (key === record.valueKey) {
+    if (editing && record.editValue.textContent !== valueText) record.editValue.textContent = valueText;
+    return;
+  }
+  record.valueKey = key;
 
-    const row = document.createElement("div");
-    row.className = "row";
-    if (flags & Flags.Selected) row.classList.add("selected");
-    if (flags & Flags.Editing) row.classList.add("editing");
-    if (flags & Flags.Disabled) row.classList.add("disabled");
-    if (type === Type.Menu || flags & Flags.HasChild) row.classList.add("menu");
-    if (editable) row.classList.add("editable");
-    if (!editable && type === Type.Value) row.classList.add("readonly");
-    if (type === Type.Bool || type === Type.Select) row.classList.add("choice");
-
-    const parsed = parseLine(text);
-    if (parsed.label === "E-STOP") row.classList.add("alert");
-    row.append(maskedIcon(icons[parsed.label] || "dot", "row-icon"));
-
-    const label = document.createElement("span");
-    label.className = "label";
-    label.textContent = parsed.label;
-    row.append(label);
-
-    if (flags & Flags.Editing && parsed.value) {
-      row.append(editControls(parsed.value));
+  let value;
+  if (editing) {
+    value = editControls(valueText);
+    record.editValue = value.querySelector(".edit-value");
+  } else {
+    value = document.createElement("span");
+    value.className = "value";
+    record.editValue = null;
+    if (isMenu) {
+      value.classList.add("value-icon");
+      applyIcon(value, "chevron-right");
     } else {
-      const value = document.createElement("span");
-      value.className = "value";
-      if (type === Type.Menu || flags & Flags.HasChild) {
-        value.classList.add("value-icon");
-        applyIcon(value, "chevron-right");
-      } else {
-        value.textContent = parsed.value;
-        if (flags & Flags.Disabled) {
-          value.append(maskedIcon("lock", "value-lock"));
-        }
-      }
-      row.append(value);
+      value.textContent = valueText;
+      if (locked) value.append(maskedIcon("lock", "value-lock"));
     }
+  }
+  if (record.value) record.value.replaceWith(value);
+  else record.element.append(value);
+  record.value = value;
+}
 
-    row.addEventListener("click", () => {
-      wasm.bm_send_row(i, 1);
-      render();
-    });
-
-    menuElement.append(row);
+function patchRow(record, { flags, type, text, editable }) {
+  const parsed = parseLine(text);
+  setClass(record, "selected", (flags & Flags.Selected) !== 0);
+  setClass(record, "editing", (flags & Flags.Editing) !== 0);
+  setClass(record, "disabled", (flags & Flags.Disabled) !== 0);
+  setClass(record, "menu", type === Type.Menu || (flags & Flags.HasChild) !== 0);
+  setClass(record, "editable", editable);
+  setClass(record, "readonly", !editable && type === Type.Value);
+  setClass(record, "choice", type === Type.Bool || type === Type.Select);
+  setClass(record, "alert", parsed.label === "E-STOP");
+
+  const iconName = icons[parsed.label] || "dot";
+  if (iconName !== record.iconName) {
+    record.iconName = iconName;
+    applyIcon(record.icon, iconName);
+  }
+  if (parsed.label !== record.labelText) {
+    record.labelText = parsed.label;
+    record.label.textContent = parsed.label;
   }
+  patchValue(record, flags, type, parsed.value);
+}
 
-  const scrollbar = renderScrollbar();
-  if (scrollbar) menuElement.append(scrollbar);
+// Drops nodes that left the frame, then inserts or moves only the nodes that are out of place.
+function reconcileChildren(nodes) {
+  const keep = new Set(nodes);
+  [...menuElement.children].forEach((child) => {
+    if (!keep.has(child)) child.remove();
+  });
+  nodes.forEach((node, i) => {
+    const current = menuElement.children[i];
+    if (current !== node) menuElement.insertBefore(node, current || null);
+  });
+}
+
+// Runs inside requestAnimationFrame so all DOM writes for a frame land together.
+function render() {
+  const frame = tree ? localFrame() : readFrame();
+  if (frame.frame >= 0 && frame.frame === lastFrame) return;
+  lastFrame = frame.frame;
+
+  const rows = frame.rows;
+  const nodes = [];
+  const seen = new Set();
+  const title = rows.find((row) => row.kind === Kind.Title);
+  frameMenu = title ? title.text : "";
+
+  rows.forEach((row, i) => {
+    if (row.kind === Kind.Blank) return;
+    if (row.kind === Kind.Title) {
+      if (!status) status = { armed: wasm.bm_armed() !== 0, percent: wasm.bm_battery_percent() };
+      const { armed, percent } = status;
+      const key = `${row.text}|${row.flags & Flags.BackAvailable}|${armed}|${percent}`;
+      if (!headerNode || key !== headerKey) {
+        const header = renderHeader(row.text, row.flags, armed, percent);
+        if (headerNode && headerNode.parentNode === menuElement) headerNode.replaceWith(header);
+        headerNode = header;
+        headerKey = key;
+      }
+      nodes.push(headerNode);
+      return;
+    }
+
+    let record = rowNodes.get(row.itemIndex);
+    if (!record) {
+      record = createRowNode();
+      rowNodes.set(row.itemIndex, record);
+    }
+    record.displayRow = i;
+    if (record.source !== row) {
+      record.source = row;
+      patchRow(record, row);
+    }
+    seen.add(row.itemIndex);
+    nodes.push(record.element);
+  });
+
+  const scrollbar = renderScrollbar(frame);
+  if (scrollbar) nodes.push(scrollbar);
+  reconcileChildren(nodes);
+  rowNodes.forEach((_, key) => {
+    if (!seen.has(key)) rowNodes.delete(key);
+  });
   updateContent(rows);
 }
 
-async function init() {
-  const response = await fetch(wasmPath);
-  let result;
+function supportsSimdBuild() {
+  try {
+    return WebAssembly.validate(SimdProbe) && WebAssembly.validate(BulkMemoryProbe);
+  } catch {
+    return false;
+  }
+}
+
+async function loadModule(path) {
+  const response = await fetch(path);
+  if (!response.ok) throw new Error(`Could not load ${path}`);
   try {
-    result = await WebAssembly.instantiateStreaming(Promise.resolve(response.clone()), {});
+    return (await WebAssembly.instantiateStreaming(Promise.resolve(response.clone()), {})).instance.exports;
   } catch {
-    result = await WebAssembly.instantiate(await response.arrayBuffer(), {});
+    return (await WebAssembly.instantiate(await response.arrayBuffer(), {})).instance.exports;
+  }
+}
+
+async function init() {
+  if (simdWasmPath && supportsSimdBuild()) {
+    try {
+      wasm = await loadModule(simdWasmPath);
+    } catch (error) {
+      console.warn("SIMD build unavailable, using the scalar build.", error);
+    }
   }
-  wasm = result.instance.exports;
+  if (!wasm) wasm = await loadModule(wasmPath);
   memory = wasm.memory;
   wasm.bm_init();
+  tree = readTree();
+  if (tree) enterMenu(TreeRoot);
   reserveContentPanelHeight();
-  render();
+  requestAnimationFrame(render);
 }
 
 function onResize() {
@@ -356,6 +906,7 @@ export function initWebMenuDomAdapter(options = {}) {
   content = options.content || {};
   icons = options.icons || {};
   wasmPath = options.wasmPath || wasmPath;
+  simdWasmPath = options.simdWasmPath || "";
   menuElement = document.querySelector(options.menuSelector || "#menu");
   contentPanel = document.querySelector(options.contentPanelSelector || ".content-panel");
   titleElement = document.querySelector(options.titleSelector || "#content-title");
@@ -245,7 +245,7 @@ static void cydRenderLine(void *raw, menu_render_line_t const *line) {
     }
     rover_console_display_ctx_t *displayCtx = static_cast<rover_console_display_ctx_t *>(raw);
     menu_runtime_t *rt = displayCtx ? displayCtx->runtime : 0;
-    menu_cursor_t const *cur = (rt && rt->depth < MENU_MAX_STACK) ? &rt->stack[rt->depth] : 0;
+    menu_cursor_t const *cur = (rt && rt->depth < MENU_MAX_STACK) ? &rt->top() : 0;
 
     const uint16_t ACCENT = rgb(47, 211, 190);
     const uint16_t STEEL = rgb(150, 166, 182);
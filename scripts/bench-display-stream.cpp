@@ -0,0 +1,208 @@
+// Measures display streaming with the menu and the panel renderer in two processes on one
+// machine: menu_display_stream_t in the parent, menu_display_shadow_t in a forked child.
+//
+//   c++ -O2 -std=c++11 -I. scripts/bench-display-stream.cpp -o /tmp/bench-display-stream
+//   /tmp/bench-display-stream [frames] [pipe|unix]
+//
+// Throughput: the parent renders frames back to back and the child applies them as they
+// arrive. Latency: the parent renders one frame and waits until the child acknowledges that
+// it committed it, so each sample is render + transfer + apply + one wakeup back.
+
+#include "BetterMenu.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+struct fd_io_ctx_t {
+    int     read_fd;
+    int     write_fd;
+    uint8_t in[4096];
+    size_t  in_len;
+    size_t  in_pos;
+    uint8_t out[4096];
+    size_t  out_len;
+    size_t  bytes_out;
+};
+
+static void write_all(int fd, uint8_t const *data, size_t len) {
+    while (len) {
+        ssize_t const n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n <= 0) { perror("write"); exit(1); }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+static void fd_io_flush(fd_io_ctx_t &io) {
+    write_all(io.write_fd, io.out, io.out_len);
+    io.out_len = 0;
+}
+
+// Blocking reads: the child has nothing else to do while it waits for the next frame.
+static int fd_io_read(void *ctx) {
+    fd_io_ctx_t &io = *static_cast<fd_io_ctx_t *>(ctx);
+    if (io.in_pos == io.in_len) {
+        ssize_t n = 0;
+        do { n = read(io.read_fd, io.in, sizeof io.in); } while (n < 0 && errno == EINTR);
+        if (n <= 0) { return -1; }
+        io.in_len = static_cast<size_t>(n);
+        io.in_pos = 0;
+    }
+    return io.in[io.in_pos++];
+}
+
+// Frame writes arrive a few bytes at a time; they are batched and written once per service().
+static void fd_io_write(void *ctx, uint8_t const *data, uint16_t len) {
+    fd_io_ctx_t &io = *static_cast<fd_io_ctx_t *>(ctx);
+    io.bytes_out += len;
+    if (io.out_len + len > sizeof io.out) { fd_io_flush(io); }
+    memcpy(io.out + io.out_len, data, len);
+    io.out_len += len;
+}
+
+static menu_byte_io_ops_t const FD_IO_OPS = { &fd_io_read, &fd_io_write };
+
+static double now_us() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static unsigned step = 0;
+static int ticks = 0;
+
+// Sweeps the highlight down and back up so frames mix highlight moves and scrolls.
+static choice_t sweep_input(char const *) {
+    ++step;
+    return (step / 14) % 2 == 0 ? Choice_Down : Choice_Up;
+}
+
+static int ticks_get(void *) { return ticks; }
+
+static void run_client(int const fds[2], unsigned frames, bool ack) {
+    static fd_io_ctx_t io;
+    io.read_fd = fds[0];
+    io.write_fd = fds[1];
+    static uint8_t buffer[6 + MENU_MAX_LINE];
+    static menu_display_shadow_row_t rows[8];
+    menu_display_shadow_t shadow;
+    menu_display_shadow_begin(shadow, make_byte_io(&io, &FD_IO_OPS), buffer, sizeof buffer, rows, 8);
+    uint8_t const done = 1;
+    for (unsigned i = 0; i < frames; ++i) {
+        if (!shadow.service()) { fprintf(stderr, "client: stream ended after %u frames\n", i); exit(1); }
+        if (ack) { write_all(io.write_fd, &done, 1); }
+    }
+    if (!ack) { write_all(io.write_fd, &done, 1); }
+}
+
+static void open_link(bool unix_socket, int server[2], int client[2]) {
+    if (unix_socket) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) { perror("socketpair"); exit(1); }
+        server[0] = server[1] = pair[0];
+        client[0] = client[1] = pair[1];
+        return;
+    }
+    int down[2];
+    int up[2];
+    if (pipe(down) != 0 || pipe(up) != 0) { perror("pipe"); exit(1); }
+    server[0] = up[0];
+    server[1] = down[1];
+    client[0] = down[0];
+    client[1] = up[1];
+}
+
+// Returns per-frame times in microseconds; ack selects latency (true) or throughput mode.
+static std::vector<double> run(bool unix_socket, unsigned frames, bool ack, size_t &bytes) {
+    auto root_menu =
+        MENU("Rover",
+            ITEM_VALUE("Ticks", ticks_get, 0),
+            ITEM_FUNC("Arm", 0), ITEM_FUNC("Disarm", 0), ITEM_FUNC("Home", 0),
+            ITEM_FUNC("Calibrate IMU", 0), ITEM_FUNC("Zero encoders", 0), ITEM_FUNC("Log start", 0),
+            ITEM_FUNC("Log stop", 0), ITEM_FUNC("Headlights", 0), ITEM_FUNC("Horn", 0),
+            ITEM_FUNC("Dock", 0), ITEM_FUNC("Undock", 0), ITEM_FUNC("Reboot", 0),
+            ITEM_FUNC("Shutdown", 0), ITEM_FUNC("About", 0)
+        );
+    int server[2];
+    int client[2];
+    open_link(unix_socket, server, client);
+    pid_t const pid = fork();
+    if (pid == 0) {
+        run_client(client, frames + 1, ack);
+        _exit(0);
+    }
+
+    static fd_io_ctx_t io;
+    memset(&io, 0, sizeof io);
+    io.read_fd = server[0];
+    io.write_fd = server[1];
+    static uint32_t hashes[8];
+    menu_display_stream_t stream;
+    display_t const display = menu_display_stream_begin(stream, make_byte_io(&io, &FD_IO_OPS), hashes, 8, 32, 8);
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, display, &sweep_input, false);
+    stream.runtime = &runtime;
+
+    uint8_t reply = 0;
+    runtime.service();
+    fd_io_flush(io);
+    if (ack && read(server[0], &reply, 1) != 1) { exit(1); }
+
+    std::vector<double> samples;
+    samples.reserve(frames);
+    double const start = now_us();
+    for (unsigned i = 0; i < frames; ++i) {
+        double const t0 = now_us();
+        ++ticks;
+        runtime.request_redraw();
+        runtime.service();
+        fd_io_flush(io);
+        if (ack) {
+            if (read(server[0], &reply, 1) != 1) { exit(1); }
+            samples.push_back(now_us() - t0);
+        }
+    }
+    if (!ack) {
+        if (read(server[0], &reply, 1) != 1) { exit(1); }
+        samples.push_back(now_us() - start);
+    }
+    bytes = io.bytes_out;
+    waitpid(pid, 0, 0);
+    close(server[0]);
+    close(client[0]);
+    if (!unix_socket) {
+        close(server[1]);
+        close(client[1]);
+    }
+    return samples;
+}
+
+int main(int argc, char **argv) {
+    unsigned const frames = argc > 1 ? static_cast<unsigned>(atoi(argv[1])) : 20000;
+    bool const unix_socket = argc > 2 && strcmp(argv[2], "unix") == 0;
+    char const *transport = unix_socket ? "unix" : "pipe";
+
+    size_t bytes = 0;
+    std::vector<double> total = run(unix_socket, frames, false, bytes);
+    double const seconds = total[0] / 1e6;
+    printf("%s throughput  %.0f frames/s  %.2f MB/s  %.1f bytes/frame  (%u frames)\n", transport,
+           frames / seconds, bytes / seconds / 1e6, static_cast<double>(bytes) / (frames + 1), frames);
+
+    std::vector<double> samples = run(unix_socket, frames, true, bytes);
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (size_t i = 0; i < samples.size(); ++i) { sum += samples[i]; }
+    printf("%s latency     median %.2f us  p95 %.2f us  p99 %.2f us  mean %.2f us\n", transport,
+           samples[samples.size() / 2], samples[samples.size() * 95 / 100], samples[samples.size() * 99 / 100],
+           sum / samples.size());
+    return 0;
+}
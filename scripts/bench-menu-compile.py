@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Measures how long large single-declaration menus take to compile, and how big they get.
+
+    scripts/bench-menu-compile.py [items ...]
+
+Each size (default 50, 100 and 255) becomes one synthetic root menu that cycles through
+ITEM_INT, ITEM_BOOL, ITEM_FUNC, a three-choice ITEM_SELECT and a two-item ITEM_MENU. The
+translation unit drives the tree through both the RAM and the flash ops tables. It is
+compiled twice with the host compiler: at -O0 -g, where debug symbols dominate the object,
+and at -Os, where the text size is what a product ships. Compile times are the best of
+RUNS attempts (default 3). CXXFLAGS is added to both builds, for example to move the
+MENU_SHARED_DISPATCH_ITEMS threshold.
+
+    CXX=clang++ RUNS=5 scripts/bench-menu-compile.py 100 200
+    CXXFLAGS=-DMENU_SHARED_DISPATCH_ITEMS=1 scripts/bench-menu-compile.py 17
+"""
+
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+CXX = os.environ.get("CXX", "c++")
+RUNS = int(os.environ.get("RUNS", "3"))
+EXTRA = shlex.split(os.environ.get("CXXFLAGS", ""))
+BUILDS = [("debug", ["-O0", "-g"]), ("size", ["-Os"])]
+
+
+def item(i):
+    kind = i % 5
+    if kind == 0:
+        return 'ITEM_INT("Int %d", &g_int, 0, 100)' % i
+    if kind == 1:
+        return 'ITEM_BOOL("Bool %d", &g_bool)' % i
+    if kind == 2:
+        return 'ITEM_FUNC("Func %d", &action)' % i
+    if kind == 3:
+        return ('ITEM_SELECT("Select %d", &g_mode, MENU_CHOICE("A", 1), MENU_CHOICE("B", 2), '
+                'MENU_CHOICE("C", 3))' % i)
+    return ('ITEM_MENU("Menu %d", MENU("Menu %d", ITEM_INT("Int", &g_int, 0, 9), '
+            'ITEM_FUNC("Func", &action)))' % (i, i))
+
+
+def source(items):
+    body = ",\n        ".join(item(i) for i in range(items))
+    return """#include "BetterMenu.h"
+
+static int g_int = 0;
+static bool g_bool = false;
+static int g_mode = 1;
+static void action() { }
+
+static const auto tree =
+    MENU("Bench",
+        %s
+    );
+static const auto flash_tree = menu_progmem(tree);
+
+int main() {
+    menu_runtime_t ram = menu_runtime_t::make_headless(tree);
+    menu_runtime_t flash = menu_runtime_t::make_headless(flash_tree);
+    ram.service();
+    flash.service();
+    return ram.depth + flash.depth;
+}
+""" % body
+
+
+def text_size(path):
+    try:
+        out = subprocess.check_output(["size", path], universal_newlines=True)
+    except (OSError, subprocess.CalledProcessError):
+        return None
+    return int(out.splitlines()[1].split()[0])
+
+
+def measure(work, items, flags):
+    src = os.path.join(work, "bench_%d.cpp" % items)
+    obj = os.path.join(work, "bench_%d.o" % items)
+    with open(src, "w") as handle:
+        handle.write(source(items))
+    cmd = [CXX, "-std=c++11", "-I" + ROOT, "-c", src, "-o", obj] + flags + EXTRA
+    best = None
+    for _ in range(RUNS):
+        start = time.time()
+        subprocess.check_call(cmd)
+        elapsed = time.time() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best, os.path.getsize(obj), text_size(obj)
+
+
+def main(argv):
+    sizes = [int(arg) for arg in argv[1:]] or [50, 100, 255]
+    work = tempfile.mkdtemp()
+    print("%5s  %-6s %9s %12s %10s" % ("items", "build", "seconds", "object B", "text B"))
+    for items in sizes:
+        for name, flags in BUILDS:
+            seconds, obj, text = measure(work, items, flags)
+            print("%5d  %-6s %9.2f %12d %10s" % (items, name, seconds, obj, text if text is not None else "-"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
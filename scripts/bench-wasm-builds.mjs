@@ -0,0 +1,56 @@
+#!/usr/bin/env node
+// Compares frame times of the scalar and bulk-memory/SIMD128 WebAssembly builds.
+//
+//   (cd docs/web-adapter && ./build.sh && PROFILE=simd ./build.sh)
+//   node scripts/bench-wasm-builds.mjs [frames]
+//
+// Each frame is one bm_send_choice() call: the runtime handles the event and renders every
+// row through the capture display, which is where the string copies and scans happen.
+
+import { existsSync, readFileSync } from "node:fs";
+import { dirname, join } from "node:path";
+import { fileURLToPath } from "node:url";
+
+const adapterDir = join(dirname(fileURLToPath(import.meta.url)), "..", "docs", "web-adapter");
+const frames = Number(process.argv[2] || 20000);
+const builds = [
+  ["scalar", "bettermenu_demo.wasm"],
+  ["simd", "bettermenu_demo_simd.wasm"]
+];
+
+const Choice = { Up: 3, Down: 4 };
+
+async function measure(file) {
+  const { instance } = await WebAssembly.instantiate(readFileSync(file), {});
+  const wasm = instance.exports;
+  wasm.bm_init();
+  const samples = new Float64Array(frames);
+  for (let i = 0; i < frames; i += 1) {
+    const choice = Math.floor(i / 8) % 2 === 0 ? Choice.Down : Choice.Up;
+    const start = process.hrtime.bigint();
+    wasm.bm_send_choice(choice);
+    samples[i] = Number(process.hrtime.bigint() - start) / 1000;
+  }
+  samples.sort();
+  return {
+    median: samples[Math.floor(frames / 2)],
+    p95: samples[Math.floor(frames * 0.95)],
+    mean: samples.reduce((sum, value) => sum + value, 0) / frames
+  };
+}
+
+const results = {};
+for (const [name, fileName] of builds) {
+  const file = join(adapterDir, fileName);
+  if (!existsSync(file)) {
+    console.log(`${name.padEnd(7)} missing ${fileName}; build it with ${name === "simd" ? "PROFILE=simd " : ""}./build.sh`);
+    continue;
+  }
+  results[name] = await measure(file);
+  const { median, p95, mean } = results[name];
+  console.log(`${name.padEnd(7)} median ${median.toFixed(2)} us  p95 ${p95.toFixed(2)} us  mean ${mean.toFixed(2)} us  (${frames} frames)`);
+}
+
+if (results.scalar && results.simd) {
+  console.log(`simd/scalar median ratio ${(results.simd.median / results.scalar.median).toFixed(3)}`);
+}
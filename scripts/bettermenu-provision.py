@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Encode BetterMenu bulk provisioning frames and optionally send them to a device.
+
+Records are item ids from the pre-order tree walk (see docs/remote-interfaces.md) paired with
+integer values. INT/VALUE items take the integer itself; BOOL/SELECT items take the choice
+position.
+
+Examples:
+  scripts/bettermenu-provision.py 0=42 2=1 3=2 > settings.bin
+  scripts/bettermenu-provision.py --file unit-17.txt --device /dev/ttyACM0 --baud 115200
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+FRAME_PROVISION = ord("P")
+FRAME_PROVISION_STATUS = ord("p")
+STATUS_NAMES = {
+    0: "ok",
+    1: "bad crc",
+    2: "too large",
+    3: "malformed",
+    4: "unknown item",
+    5: "read only",
+    6: "out of range",
+}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode_frame(frame_type, payload):
+    body = struct.pack("<BH", frame_type, len(payload)) + payload
+    return b"\xA5\x5A" + body + struct.pack("<H", crc16(body))
+
+
+def parse_record(text):
+    ident, _, value = text.replace("=", " ").partition(" ")
+    return int(ident, 0), int(value.strip(), 0)
+
+
+def read_records(args):
+    records = [parse_record(r) for r in args.records]
+    if args.file:
+        with open(args.file, encoding="utf-8") as handle:
+            for line in handle:
+                line = line.split("#", 1)[0].strip()
+                if line:
+                    records.append(parse_record(line))
+    return records
+
+
+def read_status(fd, timeout):
+    deadline = time.monotonic() + timeout
+    buffer = b""
+    while time.monotonic() < deadline:
+        try:
+            chunk = os.read(fd, 64)
+        except BlockingIOError:
+            chunk = b""
+        buffer += chunk
+        start = buffer.find(b"\xA5\x5A")
+        if start >= 0 and len(buffer) >= start + 14:
+            frame = buffer[start + 2:start + 14]
+            frame_type, length = struct.unpack_from("<BH", frame)
+            if frame_type == FRAME_PROVISION_STATUS and length == 7:
+                if struct.unpack_from("<H", frame, 10)[0] != crc16(frame[:10]):
+                    raise SystemExit("status frame failed CRC check")
+                return struct.unpack_from("<BHHH", frame, 3)
+            buffer = buffer[start + 2:]
+        if not chunk:
+            time.sleep(0.01)
+    raise SystemExit("no status frame received")
+
+
+def configure_tty(fd, baud):
+    import termios
+    import tty
+    tty.setraw(fd)
+    speed = getattr(termios, "B%d" % baud)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("records", nargs="*", help="ID=VALUE pairs")
+    parser.add_argument("--file", help="text file with one 'ID VALUE' or 'ID=VALUE' record per line")
+    parser.add_argument("--device", help="serial device or pipe to send the frame to and read the status from")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=2.0)
+    args = parser.parse_args()
+
+    records = read_records(args)
+    payload = b"".join(struct.pack("<Hi", ident, value) for ident, value in records)
+    frame = encode_frame(FRAME_PROVISION, payload)
+
+    if not args.device:
+        sys.stdout.buffer.write(frame)
+        return 0
+
+    fd = os.open(args.device, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    try:
+        if os.isatty(fd):
+            configure_tty(fd, args.baud)
+        os.write(fd, frame)
+        status, applied, record, ident = read_status(fd, args.timeout)
+    finally:
+        os.close(fd)
+
+    if status != 0:
+        print("rejected: %s at record %d (item %d)" % (STATUS_NAMES.get(status, status), record, ident), file=sys.stderr)
+        return 1
+    print("applied %d record(s)" % applied)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,71 @@
+#!/usr/bin/env sh
+# Builds and runs the host tests with each MENU_FEATURE_* switch turned off on its
+# own and with MENU_PROFILE_MINIMAL, then prints the text size of a small
+# ops-driven runtime in the full and minimal profiles.
+#
+#   scripts/check-feature-profiles.sh
+#   CXX=clang++ scripts/check-feature-profiles.sh
+set -eu
+
+cxx="${CXX:-c++}"
+root="$(pwd)"
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+
+status=0
+for profile in \
+    MENU_FEATURE_LEGACY_INPUT=0 \
+    MENU_FEATURE_LEGACY_DISPLAY=0 \
+    MENU_FEATURE_BREADCRUMBS=0 \
+    MENU_FEATURE_NUMBERING=0 \
+    MENU_FEATURE_VISIBILITY=0 \
+    MENU_FEATURE_FORMAT=0 \
+    MENU_FEATURE_POINTER_EVENTS=0 \
+    MENU_PROFILE_MINIMAL=1
+do
+    if $cxx -std=c++11 -Wall -Wextra -pedantic -Werror -D"$profile" \
+            "$root/tests/host_tests.cpp" "$root/tests/host_tests_walk.cpp" -o "$work/host_tests" &&
+        (cd "$work" && ./host_tests); then
+        echo "ok   $profile"
+    else
+        echo "FAIL $profile"
+        status=1
+    fi
+done
+
+cat > "$work/driver.cpp" <<'EOF'
+#include "BetterMenu.h"
+
+static int speed = 3;
+static bool lamp = false;
+
+static void clear(void *) { }
+static void write_line(void *, uint8_t, char const *) { }
+static display_ops_t const OPS = { &clear, &write_line, 0, 0 };
+static choice_t idle(void *) { return Choice_Invalid; }
+static input_event_ctx_t events;
+
+static const auto root_menu =
+    MENU("Root",
+        ITEM_INT("Speed", &speed, 0, 9),
+        ITEM_BOOL("Lamp", &lamp),
+        ITEM_MENU("More", MENU("More", ITEM_INT("Speed", &speed, 0, 9)))
+    );
+
+int main() {
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, make_display(20, 4, 0, &OPS), make_event_input(events, 0, &idle), true);
+    runtime.service();
+    return 0;
+}
+EOF
+
+# Prints the text size of the driver built with the given -D flag.
+text_size() {
+    $cxx -std=c++11 -Os -D"$1" -I"$root" -c "$work/driver.cpp" -o "$work/driver.o"
+    size "$work/driver.o" | awk 'NR == 2 { print $1 }'
+}
+
+if command -v size >/dev/null 2>&1; then
+    echo "driver text bytes: full $(text_size MENU_PROFILE_MINIMAL=0), minimal $(text_size MENU_PROFILE_MINIMAL=1)"
+fi
+exit $status
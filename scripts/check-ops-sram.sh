@@ -0,0 +1,61 @@
+#!/usr/bin/env sh
+# Reports what the generated menu ops tables of tests/avr/ops_sram (21 tables) cost. On the
+# host it prints their size at host pointer width. With arduino-cli and the arduino:avr core
+# it also builds the sketch with and without MENU_PROGMEM_OPS, and fails unless flash
+# placement frees every table's bytes of SRAM. Without arduino-cli the AVR build is skipped,
+# or fails when REQUIRE_AVR=1.
+#
+#   scripts/check-ops-sram.sh
+#   REQUIRE_AVR=1 FQBN=arduino:avr:mega scripts/check-ops-sram.sh
+set -eu
+
+cxx="${CXX:-c++}"
+fqbn="${FQBN:-arduino:avr:uno}"
+root="$(pwd)"
+sketch="$root/tests/avr/ops_sram"
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+
+cat > "$work/host.cpp" <<'CPP'
+#include "ops_sram.ino"
+#include <stdio.h>
+
+int main() {
+    setup();
+    loop();
+    printf("%u %u %u\n", static_cast<unsigned>(menu_footprint<decltype(rootMenu)>::ops_tables),
+           static_cast<unsigned>(sizeof(menu_ops_t) / sizeof(menu_func_fptr_t)), static_cast<unsigned>(sizeof(menu_ops_t)));
+    return 0;
+}
+CPP
+$cxx -std=c++11 -Wall -Wextra -I"$root" -I"$sketch" "$work/host.cpp" -o "$work/host"
+set -- $("$work/host")
+tables=$1
+slots=$2
+echo "host: $tables ops tables x $3 bytes = $(($1 * $3)) bytes of const data"
+
+if ! command -v arduino-cli >/dev/null 2>&1; then
+    if [ "${REQUIRE_AVR:-0}" = 1 ]; then
+        echo "arduino-cli not found"
+        exit 1
+    fi
+    echo "arduino-cli not found; skipping the AVR build"
+    exit 0
+fi
+
+# Prints the "Global variables use N bytes" figure for one build.
+globals() {
+    arduino-cli compile --fqbn "$fqbn" --library "$root" --build-path "$work/avr$2" \
+        --build-property "compiler.cpp.extra_flags=$1" "$sketch" |
+        sed -n 's/^Global variables use \([0-9][0-9]*\) bytes.*/\1/p'
+}
+
+ram=$(globals "-DMENU_PROGMEM_OPS=0" 0)
+flash=$(globals "-DMENU_PROGMEM_OPS=1" 1)
+expected=$((tables * slots * 2))
+echo "$fqbn: globals $ram bytes with RAM tables, $flash bytes with MENU_PROGMEM_OPS=1"
+echo "$fqbn: saved $((ram - flash)) bytes; $tables tables x $slots pointers x 2 bytes = $expected"
+if [ $((ram - flash)) -lt "$expected" ]; then
+    echo "MENU_PROGMEM_OPS did not move every ops table out of SRAM"
+    exit 1
+fi
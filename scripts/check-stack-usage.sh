@@ -0,0 +1,93 @@
+#!/usr/bin/env sh
+# Reports the stack frames on the service() -> render() -> format_line() path from
+# -fstack-usage, with and without MENU_RENDER_ARENA, at two MENU_MAX_LINE sizes. render()
+# calls modified_rows() instead of format_line() at the deepest point when the modified
+# marker is on, so the chain counts the larger of the two.
+# Fails if the arena build's frames still grow with MENU_MAX_LINE, or if its chain
+# exceeds STACK_BUDGET bytes (default 640).
+#
+#   scripts/check-stack-usage.sh
+#   CXX=clang++ CXXFLAGS=-Os STACK_BUDGET=512 scripts/check-stack-usage.sh
+set -eu
+
+cxx="${CXX:-c++}"
+flags="${CXXFLAGS:--O2}"
+budget="${STACK_BUDGET:-640}"
+root="$(pwd)"
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+
+cat > "$work/driver.cpp" <<'EOF'
+#include "BetterMenu.h"
+
+static int speed = 3;
+static int level = 5;
+static int mode = 1;
+static bool lamp = false;
+
+static void clear(void *) { }
+static void write_line(void *, uint8_t, char const *) { }
+static void flush(void *) { }
+static display_ops_t const OPS = { &clear, &write_line, &flush, 0 };
+
+static void format_level(void *, char *out, uint8_t cap) {
+    if (cap > 2) { out[0] = static_cast<char>('0' + level % 10); out[1] = '%'; out[2] = '\0'; }
+}
+static choice_t idle(char const *) { return Choice_Invalid; }
+
+static const auto root_menu =
+    MENU("Root",
+        ITEM_INT("Speed", &speed, 0, 9),
+        ITEM_BOOL("Lamp", &lamp),
+        ITEM_SELECT("Mode", &mode, MENU_CHOICE("Eco", 1), MENU_CHOICE("Boost", 2)),
+        ITEM_FORMAT(ITEM_INT("Level", &level, 0, 100), &format_level, 0),
+        ITEM_MENU("More", MENU("More", ITEM_INT("Speed", &speed, 0, 9)))
+    );
+
+menu_runtime_t runtime = menu_runtime_t::make(root_menu, make_display(40, 8, 0, &OPS), &idle, true);
+
+int main() {
+    runtime.request_redraw();
+    runtime.service();
+    return 0;
+}
+EOF
+
+# Prints "service render format_line modified_rows" frame sizes for one configuration.
+frames() {
+    (cd "$work" && $cxx -std=c++11 $flags -fstack-usage -DMENU_RENDER_ARENA="$1" -DMENU_MAX_LINE="$2" \
+        -I"$root" -c driver.cpp -o driver.o)
+    awk -F'\t' '
+        /basic_menu_runtime_t<Display, Input, Config>::service\(\)/   { s = $2 }
+        /basic_menu_runtime_t<Display, Input, Config>::render\(/      { r = $2 }
+        /basic_menu_runtime_t<Display, Input, Config>::format_line\(/ { f = $2 }
+        /basic_menu_runtime_t<Display, Input, Config>::modified_rows\(/ { m = $2 }
+        END { print s + 0, r + 0, f + 0, m + 0 }
+    ' "$work/driver.su"
+}
+
+status=0
+echo "MENU_RENDER_ARENA MENU_MAX_LINE  service  render  format_line  modified_rows  chain"
+for arena in 0 1; do
+    for line in 64 192; do
+        set -- $(frames "$arena" "$line")
+        deepest=$3
+        if [ "$4" -gt "$deepest" ]; then deepest=$4; fi
+        chain=$(($1 + $2 + deepest))
+        printf '%17s %13s %8s %7s %12s %14s %6s\n' "$arena" "$line" "$1" "$2" "$3" "$4" "$chain"
+        if [ "$arena" = 1 ]; then
+            if [ "$line" = 64 ]; then
+                arena_chain=$chain
+            elif [ "$chain" != "$arena_chain" ]; then
+                echo "arena build still grows with MENU_MAX_LINE ($arena_chain -> $chain bytes)"
+                status=1
+            fi
+            if [ "$chain" -gt "$budget" ]; then
+                echo "arena chain of $chain bytes exceeds STACK_BUDGET=$budget"
+                status=1
+            fi
+        fi
+    done
+done
+echo "Frames that inline into their caller report 0. Format callbacks and display ops run on top of the chain."
+exit $status
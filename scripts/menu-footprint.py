@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Prints menu_footprint<> for every menu tree declared in the example sketches.
+
+    scripts/menu-footprint.py [sketch.ino ...]
+
+Each `auto name = MENU(...)` declaration is copied into a host translation unit and
+measured with menu_footprint<decltype(...)>. Only the tree's type matters, so the
+variables and callbacks a sketch binds are replaced by one stub that converts to any
+pointer or value. Byte counts come from the host compiler and use its pointer size.
+"""
+
+import glob
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+CXX = os.environ.get("CXX", "c++")
+
+DECL = re.compile(r"\bauto\s+(\w+)(?:\s+PROGMEM)?\s*=\s*(?=MENU\s*\()")
+STRING = re.compile(r'"(?:\\.|[^"\\])*"|\'(?:\\.|[^\'\\])*\'')
+IDENT = re.compile(r"(?<![\w.>])([A-Za-z_]\w*)\b")
+KNOWN = re.compile(r"^(MENU|MENU_CHOICE|ITEM_\w+|F|menu_\w+|make_\w+|static_cast|reinterpret_cast|const_cast|"
+                   r"void|int|bool|char|unsigned|long|short|const|true|false|nullptr|NULL|u?int\d+_t)$")
+
+FIELDS = ["bytes", "items", "menus", "depth", "max_items", "ops_tables", "texts",
+          "ints", "bools", "selects", "choices", "values", "funcs", "decorators"]
+
+
+def width(field):
+    return max(6, len(field))
+
+
+def call_extent(text, start):
+    """Returns the index just past the parenthesised call that starts at text[start]."""
+    depth = 0
+    i = start
+    while i < len(text):
+        match = STRING.match(text, i)
+        if match:
+            i = match.end()
+            continue
+        if text[i] == "(":
+            depth += 1
+        elif text[i] == ")":
+            depth -= 1
+            if depth == 0:
+                return i + 1
+        i += 1
+    raise ValueError("unbalanced MENU(...) declaration")
+
+
+def trees(path):
+    with open(path) as handle:
+        text = handle.read()
+    for match in DECL.finditer(text):
+        yield match.group(1), text[match.end():call_extent(text, match.end())]
+
+
+def translation_unit(declared):
+    names = set(name for name, _ in declared)
+    stubs = set()
+    for _, expr in declared:
+        for ident in IDENT.findall(STRING.sub('""', expr)):
+            if ident not in names and not KNOWN.match(ident):
+                stubs.add(ident)
+    lines = [
+        '#include "BetterMenu.h"',
+        "#include <stdio.h>",
+        "#define F(text) (text)",
+        "struct menu_stub_t {",
+        "    template<typename T> operator T() const;",
+        "    menu_stub_t operator&() const;",
+        "};",
+    ]
+    lines += ["extern menu_stub_t const %s;" % stub for stub in sorted(stubs)]
+    for name, expr in declared:
+        lines.append("typedef decltype(%s) %s_tree_t;" % (expr, name))
+        lines.append("extern %s_tree_t const %s;" % (name, name))
+    lines.append("template<typename Tree> static void report(char const *name) {")
+    lines.append("    typedef menu_footprint<Tree> fp;")
+    lines.append('    printf("  %-16s' + "".join(" %%%du" % width(field) for field in FIELDS) + '\\n", name' +
+                 "".join(", static_cast<unsigned>(fp::%s)" % field for field in FIELDS) + ");")
+    lines.append("}")
+    lines.append("int main() {")
+    lines += ['    report<%s_tree_t>("%s");' % (name, name) for name, _ in declared]
+    lines.append("    return 0;")
+    lines.append("}")
+    return "\n".join(lines) + "\n"
+
+
+def main(argv):
+    sketches = argv or sorted(glob.glob(os.path.join(ROOT, "examples", "*", "*.ino")))
+    header = "  %-16s" % "tree" + "".join(" %*s" % (width(field), field) for field in FIELDS)
+    status = 0
+    with tempfile.TemporaryDirectory() as work:
+        for sketch in sketches:
+            declared = list(trees(sketch))
+            if not declared:
+                continue
+            print(os.path.relpath(sketch, ROOT))
+            source = os.path.join(work, "footprint.cpp")
+            binary = os.path.join(work, "footprint")
+            with open(source, "w") as handle:
+                handle.write(translation_unit(declared))
+            build = subprocess.run([CXX, "-std=c++11", "-I" + ROOT, source, "-o", binary],
+                                   capture_output=True, text=True)
+            if build.returncode != 0:
+                print("  could not measure this sketch:\n" + build.stderr)
+                status = 1
+                continue
+            print(header)
+            sys.stdout.flush()
+            subprocess.run([binary], check=True)
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
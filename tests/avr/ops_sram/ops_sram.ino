@@ -0,0 +1,49 @@
+// Size probe for scripts/check-ops-sram.sh. The root menu holds 20 submenus of distinct
+// types, so the build carries 21 generated ops tables and nothing else of note.
+#include <BetterMenu.h>
+
+static int value;
+static bool flag;
+static void act() { }
+
+#define I ITEM_INT("I", &value, 0, 9)
+#define B ITEM_BOOL("B", &flag)
+#define F ITEM_FUNC("F", act)
+
+static const auto rootMenu =
+    MENU("Ops",
+        ITEM_MENU("1", MENU("1", I)),
+        ITEM_MENU("2", MENU("2", B)),
+        ITEM_MENU("3", MENU("3", F)),
+        ITEM_MENU("4", MENU("4", I, I)),
+        ITEM_MENU("5", MENU("5", I, B)),
+        ITEM_MENU("6", MENU("6", I, F)),
+        ITEM_MENU("7", MENU("7", B, I)),
+        ITEM_MENU("8", MENU("8", B, B)),
+        ITEM_MENU("9", MENU("9", B, F)),
+        ITEM_MENU("10", MENU("10", F, I)),
+        ITEM_MENU("11", MENU("11", F, B)),
+        ITEM_MENU("12", MENU("12", F, F)),
+        ITEM_MENU("13", MENU("13", I, I, I)),
+        ITEM_MENU("14", MENU("14", I, I, B)),
+        ITEM_MENU("15", MENU("15", I, I, F)),
+        ITEM_MENU("16", MENU("16", I, B, I)),
+        ITEM_MENU("17", MENU("17", I, B, B)),
+        ITEM_MENU("18", MENU("18", I, B, F)),
+        ITEM_MENU("19", MENU("19", I, F, I)),
+        ITEM_MENU("20", MENU("20", I, F, B))
+    );
+
+static_assert(menu_footprint<decltype(rootMenu)>::ops_tables == 21, "one ops table per menu type");
+
+static menu_runtime_t runtime = menu_runtime_t::make_headless(rootMenu);
+
+void setup() {
+    runtime.begin();
+}
+
+void loop() {
+    long v = 0;
+    runtime.get_path("4/I", &v);
+    runtime.set_path("4/I", (v + 1) % 10);
+}
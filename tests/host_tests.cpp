@@ -1,9 +1,18 @@
+/* The shallow-stack builds open trees deeper than their cursor stack on purpose, to cover
+   the runtime's depth guards. */
+#if defined(MENU_MAX_STACK) && MENU_MAX_STACK < 4 && !defined(MENU_DEPTH_CHECK)
+#define MENU_DEPTH_CHECK 0
+#endif
 #include "../BetterMenu.h"
 
 #include <assert.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <termios.h>
+#include <unistd.h>
 
 template<typename T, unsigned N>
 static unsigned array_count(T const (&)[N]) {
@@ -150,12 +159,15 @@ static input_source_t script_input(script_ctx_t &ctx) {
     return src;
 }
 
+#if MENU_FEATURE_POINTER_EVENTS
 static menu_event_t read_event_script(void *ctx) {
     event_script_ctx_t &s = *static_cast<event_script_ctx_t *>(ctx);
     return (s.pos < s.count) ? s.events[s.pos++] : menu_event(Choice_Invalid);
 }
+#endif
 
-static void run_until_idle(menu_runtime_t &runtime, script_ctx_t const &script) {
+template<typename Runtime>
+static void run_until_idle(Runtime &runtime, script_ctx_t const &script) {
     unsigned guard = 0;
     while (script.pos < script.count || runtime.dirty) {
         runtime.service();
@@ -189,6 +201,7 @@ static choice_t read_script_event(void *ctx) {
     return (s.pos < s.count) ? s.choices[s.pos++] : Choice_Invalid;
 }
 
+#if MENU_FEATURE_LEGACY_DISPLAY
 static char g_legacy_lines[4][128];
 static unsigned g_legacy_write_count;
 static unsigned g_legacy_prompt_count;
@@ -214,12 +227,14 @@ static void legacy_write_line(uint8_t row, char const *text) {
 static void legacy_flush() {
 }
 
+#if MENU_FEATURE_LEGACY_INPUT
 static choice_t legacy_input(char const *prompt) {
     if (prompt && prompt[0]) {
         ++g_legacy_prompt_count;
     }
     return (g_legacy_choice_pos < g_legacy_choice_count) ? g_legacy_choices[g_legacy_choice_pos++] : Choice_Invalid;
 }
+#endif
 
 static void reset_legacy_io(choice_t const *choices, unsigned count) {
     g_legacy_write_count = 0;
@@ -230,6 +245,7 @@ static void reset_legacy_io(choice_t const *choices, unsigned count) {
     legacy_clear();
 }
 
+#if MENU_FEATURE_LEGACY_INPUT
 static void run_legacy_until_idle(menu_runtime_t &runtime) {
     unsigned guard = 0;
     while (g_legacy_choice_pos < g_legacy_choice_count || runtime.dirty) {
@@ -238,6 +254,8 @@ static void run_legacy_until_idle(menu_runtime_t &runtime) {
         assert(guard < 64);
     }
 }
+#endif
+#endif
 
 static int test_single_declaration_navigation() {
     int volume = 5;
@@ -290,6 +308,7 @@ static int test_single_declaration_navigation() {
     return 0;
 }
 
+#if MENU_FEATURE_LEGACY_INPUT && MENU_FEATURE_LEGACY_DISPLAY
 static int test_legacy_callbacks_still_work() {
     int value = 1;
     auto root_menu =
@@ -315,7 +334,9 @@ static int test_legacy_callbacks_still_work() {
     assert(strcmp(g_legacy_lines[0], ">Value: 2") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_LEGACY_INPUT && MENU_FEATURE_LEGACY_DISPLAY
 static int test_manual_legacy_display_initialization_is_safe() {
     int value = 1;
     auto root_menu =
@@ -349,6 +370,7 @@ static int test_manual_legacy_display_initialization_is_safe() {
     assert(braced_display.clear == &legacy_clear);
     return 0;
 }
+#endif
 
 static int test_null_int_item_is_safe() {
     int ok = 1;
@@ -559,6 +581,46 @@ static int test_clamp_view_uses_non_wrapping_window_math() {
     return 0;
 }
 
+/* Hand-written menu ops for fake menus. Slots after value_select stay empty, so the tables
+   build with every feature switch. */
+static menu_ops_t test_menu_ops(decltype(menu_ops_t::count) count,
+                                decltype(menu_ops_t::label_at) label_at = 0,
+                                decltype(menu_ops_t::type_at) type_at = 0,
+                                decltype(menu_ops_t::int_has) int_has = 0,
+                                decltype(menu_ops_t::scalar_has) scalar_has = 0,
+                                decltype(menu_ops_t::int_get) int_get = 0,
+                                decltype(menu_ops_t::int_set) int_set = 0,
+                                decltype(menu_ops_t::int_min) int_min = 0,
+                                decltype(menu_ops_t::int_max) int_max = 0,
+                                decltype(menu_ops_t::int_step) int_step = 0,
+                                decltype(menu_ops_t::child_at) child_at = 0,
+                                decltype(menu_ops_t::call_func) call_func = 0,
+                                decltype(menu_ops_t::title) title = 0,
+                                decltype(menu_ops_t::value_count) value_count = 0,
+                                decltype(menu_ops_t::value_label_at) value_label_at = 0,
+                                decltype(menu_ops_t::value_selected) value_selected = 0,
+                                decltype(menu_ops_t::value_select) value_select = 0) {
+    menu_ops_t ops = menu_ops_t();
+    ops.count = count;
+    ops.label_at = label_at;
+    ops.type_at = type_at;
+    ops.int_has = int_has;
+    ops.scalar_has = scalar_has;
+    ops.int_get = int_get;
+    ops.int_set = int_set;
+    ops.int_min = int_min;
+    ops.int_max = int_max;
+    ops.int_step = int_step;
+    ops.child_at = child_at;
+    ops.call_func = call_func;
+    ops.title = title;
+    ops.value_count = value_count;
+    ops.value_label_at = value_label_at;
+    ops.value_selected = value_selected;
+    ops.value_select = value_select;
+    return ops;
+}
+
 static uint8_t fake_count(void const *) { return 250; }
 static menu_text_t fake_label_at(void const *, uint8_t) { return menu_text("Item"); }
 static entry_t fake_type_at(void const *, uint8_t) { return ENTRY_FUNC; }
@@ -573,7 +635,7 @@ static bool fake_child_at(void const *, uint8_t, void const **, menu_ops_t const
 static void fake_call_func(void const *, uint8_t) { }
 static menu_text_t fake_title(void const *) { return menu_text("Fake"); }
 
-static menu_ops_t const FAKE_LARGE_MENU_OPS = {
+static menu_ops_t const FAKE_LARGE_MENU_OPS = test_menu_ops(
     &fake_count,
     &fake_label_at,
     &fake_type_at,
@@ -586,24 +648,16 @@ static menu_ops_t const FAKE_LARGE_MENU_OPS = {
     &fake_int_step,
     &fake_child_at,
     &fake_call_func,
-    &fake_title,
-    0,
-    0,
-    0,
-    0,
-    0,
-    0,
-    0,
-    0
-};
+    &fake_title
+);
 
 static int test_render_stops_before_item_index_wraparound() {
     int fake_menu = 0;
     menu_runtime_t runtime = menu_runtime_t::base_init(&fake_menu, &FAKE_LARGE_MENU_OPS, test_display(32, 20), true);
-    runtime.stack[0].selected = 249;
-    runtime.stack[0].top = 240;
+    runtime.top().selected = 249;
+    runtime.top().top = 240;
 
-    runtime.render(runtime.stack[0]);
+    runtime.render(runtime.top());
 
     assert(g_display_ctx.write_count == 20);
     return 0;
@@ -629,7 +683,7 @@ static int test_navigation_clamps_by_default() {
     run_until_idle(runtime, script);
 
     assert(runtime.navigation_wrap == 0);
-    assert(runtime.stack[0].selected == 2);
+    assert(runtime.top().selected == 2);
     assert(strcmp(g_display_ctx.lines[2], ">Three") == 0);
     return 0;
 }
@@ -652,7 +706,7 @@ static int test_navigation_wraps_when_enabled() {
     run_until_idle(runtime, script);
 
     assert(runtime.navigation_wrap == 1);
-    assert(runtime.stack[0].selected == 2);
+    assert(runtime.top().selected == 2);
     assert(strcmp(g_display_ctx.lines[2], ">Three") == 0);
     return 0;
 }
@@ -660,19 +714,19 @@ static int test_navigation_wraps_when_enabled() {
 static int test_service_clamps_large_menu_to_full_window() {
     int fake_menu = 0;
     menu_runtime_t runtime = menu_runtime_t::base_init(&fake_menu, &FAKE_LARGE_MENU_OPS, test_display(32, 20), true);
-    runtime.stack[0].selected = 249;
-    runtime.stack[0].top = 240;
+    runtime.top().selected = 249;
+    runtime.top().top = 240;
 
     runtime.service();
 
-    assert(runtime.stack[0].top == 230);
+    assert(runtime.top().top == 230);
     assert(g_display_ctx.write_count == 20);
     return 0;
 }
 
 static uint8_t max_count(void const *) { return 255; }
 
-static menu_ops_t const FAKE_MAX_MENU_OPS = {
+static menu_ops_t const FAKE_MAX_MENU_OPS = test_menu_ops(
     &max_count,
     &fake_label_at,
     &fake_type_at,
@@ -685,24 +739,16 @@ static menu_ops_t const FAKE_MAX_MENU_OPS = {
     &fake_int_step,
     &fake_child_at,
     &fake_call_func,
-    &fake_title,
-    0,
-    0,
-    0,
-    0,
-    0,
-    0,
-    0,
-    0
-};
+    &fake_title
+);
 
 static int test_render_handles_maximum_menu_count() {
     int fake_menu = 0;
     menu_runtime_t runtime = menu_runtime_t::base_init(&fake_menu, &FAKE_MAX_MENU_OPS, test_display(32, 0), true);
-    runtime.stack[0].selected = 254;
-    runtime.stack[0].top = 0;
+    runtime.top().selected = 254;
+    runtime.top().top = 0;
 
-    runtime.render(runtime.stack[0]);
+    runtime.render(runtime.top());
 
     assert(g_display_ctx.write_count == 255);
     return 0;
@@ -719,7 +765,7 @@ static menu_text_t max_value_value_label_at(void const *, uint8_t, uint8_t value
 static uint8_t max_value_selected(void const *, uint8_t) { return static_cast<uint8_t>(g_fake_selected_value); }
 static void max_value_select(void const *, uint8_t, uint8_t value_idx) { g_fake_selected_value = value_idx; }
 
-static menu_ops_t const FAKE_MAX_VALUE_MENU_OPS = {
+static menu_ops_t const FAKE_MAX_VALUE_MENU_OPS = test_menu_ops(
     &max_value_count,
     &max_value_label_at,
     &max_value_type_at,
@@ -736,12 +782,8 @@ static menu_ops_t const FAKE_MAX_VALUE_MENU_OPS = {
     &max_value_value_count,
     &max_value_value_label_at,
     &max_value_selected,
-    &max_value_select,
-    0,
-    0,
-    0,
-    0
-};
+    &max_value_select
+);
 
 static int test_select_wraps_at_maximum_value_count() {
     int fake_menu = 0;
@@ -763,11 +805,7 @@ static int test_select_wraps_at_maximum_value_count() {
 
 static uint8_t partial_count(void const *) { return 1; }
 
-static menu_ops_t const PARTIAL_MENU_OPS = {
-    &partial_count,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+static menu_ops_t const PARTIAL_MENU_OPS = test_menu_ops(&partial_count);
 
 static unsigned g_trap_count_calls;
 static uint8_t trap_count(void const *) {
@@ -775,11 +813,7 @@ static uint8_t trap_count(void const *) {
     return 1;
 }
 
-static menu_ops_t const TRAP_MENU_OPS = {
-    &trap_count,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+static menu_ops_t const TRAP_MENU_OPS = test_menu_ops(&trap_count);
 
 static uint8_t null_child_count(void const *) { return 1; }
 static menu_text_t null_child_label_at(void const *, uint8_t) { return menu_text("Broken Child"); }
@@ -790,14 +824,13 @@ static bool null_child_at(void const *, uint8_t, void const **out_child, menu_op
     return true;
 }
 
-static menu_ops_t const NULL_CHILD_MENU_OPS = {
+static menu_ops_t const NULL_CHILD_MENU_OPS = test_menu_ops(
     &null_child_count,
     &null_child_label_at,
     &null_child_type_at,
     0, 0, 0, 0, 0, 0, 0,
-    &null_child_at,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+    &null_child_at
+);
 
 static int test_null_and_partial_menu_ops_are_safe() {
     menu_runtime_t null_runtime = menu_runtime_t::base_init(static_cast<void const *>(0), static_cast<menu_ops_t const *>(0), test_display(32, 2), true);
@@ -813,7 +846,11 @@ static int test_null_and_partial_menu_ops_are_safe() {
     partial_runtime.service();
     assert(g_display_ctx.clear_count == 1);
     assert(g_display_ctx.write_count == 2);
+#if MENU_FEATURE_NUMBERING
     assert(strcmp(g_display_ctx.lines[0], ">1 ") == 0);
+#else
+    assert(strcmp(g_display_ctx.lines[0], ">") == 0);
+#endif
     assert(strcmp(g_display_ctx.lines[1], "") == 0);
     return 0;
 }
@@ -935,12 +972,15 @@ static int test_public_adapter_construction_is_stable() {
     display_t default_display;
     assert(default_display.width == 0);
     assert(default_display.height == 0);
+#if MENU_FEATURE_LEGACY_DISPLAY
     assert(default_display.clear == 0);
     assert(default_display.write_line == 0);
     assert(default_display.flush == 0);
+#endif
     assert(default_display.ctx == 0);
     assert(default_display.ops == 0);
 
+#if MENU_FEATURE_LEGACY_DISPLAY
     display_t callback_display = { 16, 2, &legacy_clear, &legacy_write_line, &legacy_flush };
     assert(callback_display.width == 16);
     assert(callback_display.height == 2);
@@ -949,16 +989,20 @@ static int test_public_adapter_construction_is_stable() {
     assert(callback_display.flush == &legacy_flush);
     assert(callback_display.ctx == 0);
     assert(callback_display.ops == 0);
+#endif
 
     display_t context_display = { 16, 2, &g_display_ctx, &TEST_DISPLAY_OPS };
     assert(context_display.width == 16);
     assert(context_display.height == 2);
+#if MENU_FEATURE_LEGACY_DISPLAY
     assert(context_display.clear == 0);
     assert(context_display.write_line == 0);
     assert(context_display.flush == 0);
+#endif
     assert(context_display.ctx == &g_display_ctx);
     assert(context_display.ops == &TEST_DISPLAY_OPS);
 
+#if MENU_FEATURE_LEGACY_DISPLAY
     display_t full_display = { 16, 2, &legacy_clear, &legacy_write_line, &legacy_flush, &g_display_ctx, &TEST_DISPLAY_OPS };
     assert(full_display.width == 16);
     assert(full_display.height == 2);
@@ -967,6 +1011,7 @@ static int test_public_adapter_construction_is_stable() {
     assert(full_display.flush == &legacy_flush);
     assert(full_display.ctx == &g_display_ctx);
     assert(full_display.ops == &TEST_DISPLAY_OPS);
+#endif
 
     display_t helper_display = make_display(20, 4, &g_display_ctx, &TEST_DISPLAY_OPS);
     assert(helper_display.width == 20);
@@ -974,6 +1019,7 @@ static int test_public_adapter_construction_is_stable() {
     assert(helper_display.ctx == &g_display_ctx);
     assert(helper_display.ops == &TEST_DISPLAY_OPS);
 
+#if MENU_FEATURE_LEGACY_DISPLAY
     display_t helper_callback_display = make_callback_display(20, 4, &legacy_clear, &legacy_write_line, &legacy_flush);
     assert(helper_callback_display.width == 20);
     assert(helper_callback_display.height == 4);
@@ -982,9 +1028,11 @@ static int test_public_adapter_construction_is_stable() {
     assert(helper_callback_display.flush == &legacy_flush);
     assert(helper_callback_display.ctx == 0);
     assert(helper_callback_display.ops == 0);
+#endif
     return 0;
 }
 
+#if MENU_FEATURE_LEGACY_DISPLAY
 static display_ops_t const PARTIAL_DISPLAY_OPS = {
     &test_clear,
     0,
@@ -1021,20 +1069,20 @@ static int test_partial_display_ops_fall_back_to_legacy_callbacks() {
     assert(strcmp(g_legacy_lines[1], "") == 0);
     return 0;
 }
+#endif
 
 static uint8_t self_child_count(void const *) { return 1; }
 static menu_text_t self_child_label_at(void const *, uint8_t) { return menu_text("Loop"); }
 static entry_t self_child_type_at(void const *, uint8_t) { return ENTRY_MENU; }
 static bool self_child_at(void const *menu_ptr, uint8_t, void const **out_child, menu_ops_t const **out_ops);
 
-static menu_ops_t const SELF_CHILD_MENU_OPS = {
+static menu_ops_t const SELF_CHILD_MENU_OPS = test_menu_ops(
     &self_child_count,
     &self_child_label_at,
     &self_child_type_at,
     0, 0, 0, 0, 0, 0, 0,
-    &self_child_at,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+    &self_child_at
+);
 
 static bool self_child_at(void const *menu_ptr, uint8_t, void const **out_child, menu_ops_t const **out_ops) {
     *out_child = menu_ptr;
@@ -1070,7 +1118,7 @@ static int test_stack_limit_prevents_overflow() {
         expected_depth = static_cast<uint8_t>(array_count(choices));
     }
     assert(runtime.depth == expected_depth);
-    assert(runtime.stack[runtime.depth].menu_ptr == &fake_menu);
+    assert(runtime.top().menu_ptr == &fake_menu);
     return 0;
 }
 
@@ -1328,6 +1376,7 @@ static int generic_get(void *ctx) {
     return static_cast<generic_value_ctx_t *>(ctx)->value;
 }
 
+#if MENU_FEATURE_FORMAT
 static void generic_set(void *ctx, int value) {
     generic_value_ctx_t *v = static_cast<generic_value_ctx_t *>(ctx);
     v->value = value;
@@ -1346,6 +1395,7 @@ static void generic_format(void *ctx, char *out, uint8_t cap) {
     menu_runtime_t::append_capped(out, cap, nb);
     menu_runtime_t::append_capped(out, cap, " rpm");
 }
+#endif
 
 static void generic_changed(void *ctx) {
     ++static_cast<generic_value_ctx_t *>(ctx)->change_count;
@@ -1355,18 +1405,28 @@ static void generic_save(void *ctx) {
     ++static_cast<generic_value_ctx_t *>(ctx)->save_count;
 }
 
+#if MENU_FEATURE_FORMAT
 static void generic_load(void *ctx) {
     generic_value_ctx_t *v = static_cast<generic_value_ctx_t *>(ctx);
     ++v->load_count;
     v->value = 4;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY
 static bool predicate_true(void *) { return true; }
 
 static bool bool_predicate(void *ctx) {
     return ctx ? *static_cast<bool *>(ctx) : false;
 }
 
+/* Wraps the adapter tests' "locked" rows so they still build when visibility is compiled out. */
+#define TEST_LOCKED(item) ITEM_DISABLED(item, predicate_true, 0)
+#else
+#define TEST_LOCKED(item) item
+#endif
+
+#if MENU_FEATURE_FORMAT
 static int test_step_generic_value_format_change_and_persistence_hooks() {
     int stepped = 0;
     generic_value_ctx_t generic = { 10, 0, 0, 0, 0, 0 };
@@ -1407,7 +1467,9 @@ static int test_step_generic_value_format_change_and_persistence_hooks() {
     assert(strcmp(g_display_ctx.lines[2], ">Read: 42") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_FORMAT
 static int test_custom_formatters_render_without_backing_value_or_choices() {
     generic_value_ctx_t generic = { 77, 0, 0, 0, 0, 0 };
     int mode = 3;
@@ -1427,7 +1489,9 @@ static int test_custom_formatters_render_without_backing_value_or_choices() {
     assert(strcmp(g_display_ctx.lines[1], " Mode: 77 rpm") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY
 static int test_hidden_disabled_items_and_rich_render_flags() {
     int value = 1;
     auto root_menu =
@@ -1471,7 +1535,9 @@ static int test_hidden_disabled_items_and_rich_render_flags() {
     assert((g_display_ctx.render_lines[1].flags & MENU_RENDER_SCROLL_DOWN) == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY && MENU_FEATURE_NUMBERING
 static int test_hidden_items_do_not_leave_numbering_gaps() {
     int value = 1;
     auto root_menu =
@@ -1491,7 +1557,9 @@ static int test_hidden_items_do_not_leave_numbering_gaps() {
     assert(strcmp(g_display_ctx.lines[1], " 2 Run") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY
 static int test_editing_is_cleared_when_selected_item_becomes_hidden() {
     int first = 1;
     int second = 2;
@@ -1509,13 +1577,13 @@ static int test_editing_is_cleared_when_selected_item_becomes_hidden() {
     run_until_idle(runtime, enter_script);
 
     assert(runtime.editing == 1);
-    assert(runtime.stack[0].selected == 0);
+    assert(runtime.top().selected == 0);
 
     hide_first = true;
     runtime.service();
 
     assert(runtime.editing == 0);
-    assert(runtime.stack[0].selected == 1);
+    assert(runtime.top().selected == 1);
     assert(first == 1);
     assert(second == 2);
     assert(strcmp(g_display_ctx.lines[0], ">Second: 2") == 0);
@@ -1531,7 +1599,9 @@ static int test_editing_is_cleared_when_selected_item_becomes_hidden() {
     assert(runtime.editing == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY
 static int test_dynamic_visibility_redraws_when_selection_is_clamped() {
     int first = 1;
     int second = 2;
@@ -1549,7 +1619,7 @@ static int test_dynamic_visibility_redraws_when_selection_is_clamped() {
     runtime.service();
 
     assert(runtime.dirty == 0);
-    assert(runtime.stack[0].selected == 0);
+    assert(runtime.top().selected == 0);
     assert(strcmp(g_display_ctx.lines[0], ">First: 1") == 0);
     assert(strcmp(g_display_ctx.lines[1], " Second: 2") == 0);
 
@@ -1557,12 +1627,14 @@ static int test_dynamic_visibility_redraws_when_selection_is_clamped() {
     runtime.service();
 
     assert(runtime.dirty == 0);
-    assert(runtime.stack[0].selected == 1);
+    assert(runtime.top().selected == 1);
     assert(strcmp(g_display_ctx.lines[0], ">Second: 2") == 0);
     assert(strcmp(g_display_ctx.lines[1], "") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY
 static int test_request_redraw_updates_predicate_driven_rows() {
     int first = 1;
     int second = 2;
@@ -1580,7 +1652,7 @@ static int test_request_redraw_updates_predicate_driven_rows() {
     runtime.service();
 
     assert(runtime.dirty == 0);
-    assert(runtime.stack[0].selected == 0);
+    assert(runtime.top().selected == 0);
     assert(strcmp(g_display_ctx.lines[0], ">First: 1") == 0);
     assert(strcmp(g_display_ctx.lines[1], "") == 0);
 
@@ -1589,12 +1661,14 @@ static int test_request_redraw_updates_predicate_driven_rows() {
     runtime.service();
 
     assert(runtime.dirty == 0);
-    assert(runtime.stack[0].selected == 0);
+    assert(runtime.top().selected == 0);
     assert(strcmp(g_display_ctx.lines[0], ">First: 1") == 0);
     assert(strcmp(g_display_ctx.lines[1], " Second: 2") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY
 static int test_interrupted_edit_restores_original_value() {
     int first = 1;
     int second = 2;
@@ -1615,20 +1689,22 @@ static int test_interrupted_edit_restores_original_value() {
     run_until_idle(runtime, edit_script);
 
     assert(runtime.editing == 1);
-    assert(runtime.stack[0].selected == 0);
+    assert(runtime.top().selected == 0);
     assert(first == 2);
 
     hide_first = true;
     runtime.service();
 
     assert(runtime.editing == 0);
-    assert(runtime.stack[0].selected == 1);
+    assert(runtime.top().selected == 1);
     assert(first == 1);
     assert(second == 2);
     assert(strcmp(g_display_ctx.lines[0], ">Second: 2") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_VISIBILITY
 static int test_interrupted_edit_on_disabled_item_restores_original_value() {
     int value = 1;
     bool disable_value = false;
@@ -1653,12 +1729,14 @@ static int test_interrupted_edit_on_disabled_item_restores_original_value() {
     runtime.service();
 
     assert(runtime.editing == 0);
-    assert(runtime.stack[0].selected == 0);
+    assert(runtime.top().selected == 0);
     assert(value == 1);
     assert(strcmp(g_display_ctx.lines[0], " Value: 1") == 0);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_POINTER_EVENTS
 static int test_row_and_encoder_events_drive_menu_without_button_polling() {
     int first = 0;
     int second = 0;
@@ -1694,7 +1772,9 @@ static int test_row_and_encoder_events_drive_menu_without_button_polling() {
     assert(g_action_count == 1);
     return 0;
 }
+#endif
 
+#if MENU_FEATURE_BREADCRUMBS
 static int test_breadcrumb_title_and_affordance_rendering() {
     auto root_menu =
         MENU("Root",
@@ -1725,6 +1805,7 @@ static int test_breadcrumb_title_and_affordance_rendering() {
 #endif
     return 0;
 }
+#endif
 
 static int test_context_function_item_keeps_action_state_inline() {
     int value = 3;
@@ -1844,8 +1925,8 @@ static int test_title_reduces_item_window_for_scrolling() {
 
     run_until_idle(runtime, script);
 
-    assert(runtime.stack[0].selected == 2);
-    assert(runtime.stack[0].top == 2);
+    assert(runtime.top().selected == 2);
+    assert(runtime.top().top == 2);
     assert(strcmp(g_display_ctx.lines[0], "Root") == 0);
     assert(strcmp(g_display_ctx.lines[1], ">Three") == 0);
     return 0;
@@ -1887,8 +1968,8 @@ static int test_reset_navigation_returns_to_root_and_clears_editing() {
 
     assert(runtime.depth == 0);
     assert(runtime.editing == 0);
-    assert(runtime.stack[0].selected == 0);
-    assert(runtime.stack[0].top == 0);
+    assert(runtime.top().selected == 0);
+    assert(runtime.top().top == 0);
     assert(runtime.dirty == 1);
 
     runtime.service();
@@ -1943,11 +2024,1643 @@ static int test_default_runtime_is_inert() {
     return 0;
 }
 
+struct pipe_io_ctx_t {
+    int read_fd;
+    int write_fd;
+};
+
+static int pipe_io_read(void *ctx) {
+    pipe_io_ctx_t *p = static_cast<pipe_io_ctx_t *>(ctx);
+    uint8_t byte = 0;
+    return (read(p->read_fd, &byte, 1) == 1) ? byte : -1;
+}
+
+static void pipe_io_write(void *ctx, uint8_t const *data, uint16_t len) {
+    pipe_io_ctx_t *p = static_cast<pipe_io_ctx_t *>(ctx);
+    while (len) {
+        ssize_t written = write(p->write_fd, data, len);
+        assert(written > 0);
+        data += written;
+        len = static_cast<uint16_t>(len - written);
+    }
+}
+
+static menu_byte_io_ops_t const PIPE_IO_OPS = {
+    &pipe_io_read, &pipe_io_write
+};
+
+/* Two pipes: host writes requests into the device side, device answers back. */
+struct pipe_link_t {
+    int to_device[2];
+    int to_host[2];
+    pipe_io_ctx_t device;
+    pipe_io_ctx_t host;
+};
+
+static void pipe_link_open(pipe_link_t &link) {
+    assert(pipe(link.to_device) == 0);
+    assert(pipe(link.to_host) == 0);
+    fcntl(link.to_device[0], F_SETFL, O_NONBLOCK);
+    fcntl(link.to_host[0], F_SETFL, O_NONBLOCK);
+    link.device.read_fd = link.to_device[0];
+    link.device.write_fd = link.to_host[1];
+    link.host.read_fd = link.to_host[0];
+    link.host.write_fd = link.to_device[1];
+}
+
+static void pipe_link_close(pipe_link_t &link) {
+    close(link.to_device[0]);
+    close(link.to_device[1]);
+    close(link.to_host[0]);
+    close(link.to_host[1]);
+}
+
+struct provision_record_t {
+    uint16_t id;
+    long value;
+};
+
+static void send_provision(pipe_link_t &link, provision_record_t const *records, unsigned count) {
+    menu_frame_writer_t w;
+    menu_frame_begin(w, make_byte_io(&link.host, &PIPE_IO_OPS), MENU_FRAME_PROVISION,
+                     static_cast<uint16_t>(count * MENU_PROVISION_RECORD_SIZE));
+    for (unsigned i = 0; i < count; ++i) {
+        menu_frame_put_u16(w, records[i].id);
+        menu_frame_put_i32(w, records[i].value);
+    }
+    menu_frame_end(w);
+}
+
+struct provision_reply_t {
+    uint8_t status;
+    uint16_t applied;
+    uint16_t record;
+    uint16_t id;
+};
+
+static provision_reply_t read_provision_reply(pipe_link_t &link) {
+    uint8_t payload[16];
+    menu_frame_reader_t reader;
+    menu_frame_reader_init(reader, payload, sizeof(payload));
+    menu_byte_io_t io = make_byte_io(&link.host, &PIPE_IO_OPS);
+    for (;;) {
+        int ch = menu_byte_io_read(io);
+        assert(ch >= 0);
+        uint8_t result = menu_frame_feed(reader, static_cast<uint8_t>(ch));
+        if (result == MENU_FRAME_PENDING) { continue; }
+        assert(result == MENU_FRAME_READY);
+        assert(reader.type == MENU_FRAME_PROVISION_STATUS);
+        assert(reader.length == 7);
+        provision_reply_t reply = { payload[0], menu_frame_get_u16(payload + 1), menu_frame_get_u16(payload + 3), menu_frame_get_u16(payload + 5) };
+        return reply;
+    }
+}
+
+static int test_provisioning_applies_validated_batch_over_pipe() {
+    int speed = 10;
+    bool enabled = false;
+    int mode = 10;
+    generic_value_ctx_t changes = { 0, 0, 0, 0, 0, 0 };
+    generic_value_ctx_t readonly = { 5, 0, 0, 0, 0, 0 };
+    auto root_menu =
+        MENU("Root",
+            ITEM_ON_CHANGE(ITEM_INT("Speed", &speed, 0, 100), generic_changed, &changes),
+            ITEM_MENU("Setup",
+                MENU("Setup",
+                    ITEM_BOOL("Enabled", &enabled),
+                    ITEM_SELECT("Mode", &mode,
+                        MENU_CHOICE("A", 10),
+                        MENU_CHOICE("B", 20),
+                        MENU_CHOICE("C", 30)
+                    ),
+                    ITEM_VALUE("Read", generic_get, &readonly)
+                )
+            ),
+            ITEM_FUNC("Run", test_action)
+        );
+
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, test_display(32, 2), make_input_source(0, 0), false);
+    runtime.set_persistence(0, &generic_save, &changes);
+    runtime.service();
+    assert(g_display_ctx.clear_count == 1);
+
+    pipe_link_t link;
+    pipe_link_open(link);
+    static uint8_t buffer[64];
+    menu_provision_t provision;
+    menu_provision_begin(provision, runtime, make_byte_io(&link.device, &PIPE_IO_OPS), buffer, sizeof(buffer));
+
+#if MENU_MAX_STACK < 2
+    provision_record_t const unreachable[] = { { 3, 1 } };
+    send_provision(link, unreachable, array_count(unreachable));
+    provision.service();
+    assert(read_provision_reply(link).status == MENU_PROVISION_UNKNOWN_ITEM);
+    pipe_link_close(link);
+    return 0;
+#else
+    provision_record_t const records[] = { { 0, 42 }, { 2, 1 }, { 3, 2 } };
+    send_provision(link, records, array_count(records));
+    provision.service();
+    provision_reply_t reply = read_provision_reply(link);
+    assert(reply.status == MENU_PROVISION_OK);
+    assert(reply.applied == 3);
+    assert(speed == 42);
+    assert(enabled == true);
+    assert(mode == 30);
+    assert(changes.change_count == 1);
+    assert(changes.save_count == 1);
+
+    runtime.service();
+    runtime.service();
+    assert(g_display_ctx.clear_count == 2);
+    assert(strcmp(g_display_ctx.lines[0], ">Speed: 42") == 0);
+
+    provision_record_t const read_only[] = { { 0, 50 }, { 4, 7 } };
+    send_provision(link, read_only, array_count(read_only));
+    provision.service();
+    reply = read_provision_reply(link);
+    assert(reply.status == MENU_PROVISION_READ_ONLY);
+    assert(reply.record == 1);
+    assert(reply.id == 4);
+    assert(speed == 42);
+
+    provision_record_t const out_of_range[] = { { 3, 3 } };
+    send_provision(link, out_of_range, array_count(out_of_range));
+    provision.service();
+    assert(read_provision_reply(link).status == MENU_PROVISION_OUT_OF_RANGE);
+
+    provision_record_t const unknown[] = { { 6, 1 } };
+    send_provision(link, unknown, array_count(unknown));
+    provision.service();
+    assert(read_provision_reply(link).status == MENU_PROVISION_UNKNOWN_ITEM);
+
+    provision_record_t const oversized[] = {
+        { 0, 1 }, { 0, 2 }, { 0, 3 }, { 0, 4 }, { 0, 5 }, { 0, 6 }, { 0, 7 }, { 0, 8 }, { 0, 9 }, { 0, 10 }, { 0, 11 }
+    };
+    send_provision(link, oversized, array_count(oversized));
+    provision.service();
+    assert(read_provision_reply(link).status == MENU_PROVISION_TOO_LARGE);
+
+    uint8_t const corrupt[] = { 0x00, MENU_FRAME_SYNC0, MENU_FRAME_SYNC1, MENU_FRAME_PROVISION, 6, 0, 0, 0, 1, 0, 0, 0, 0x12, 0x34 };
+    pipe_io_write(&link.host, corrupt, sizeof(corrupt));
+    provision.service();
+    assert(read_provision_reply(link).status == MENU_PROVISION_BAD_CRC);
+
+    menu_frame_writer_t w;
+    menu_frame_begin(w, make_byte_io(&link.host, &PIPE_IO_OPS), MENU_FRAME_PROVISION, 4);
+    menu_frame_put_i32(w, 0);
+    menu_frame_end(w);
+    provision.service();
+    assert(read_provision_reply(link).status == MENU_PROVISION_MALFORMED);
+
+    assert(speed == 42);
+    assert(changes.save_count == 1);
+    pipe_link_close(link);
+    return 0;
+#endif
+}
+
+static int g_provision_values[200];
+static uint8_t provision_count(void const *) { return 200; }
+static entry_t provision_type_at(void const *, uint8_t) { return ENTRY_INT; }
+static bool provision_int_has(void const *, uint8_t) { return true; }
+static int provision_int_get(void const *, uint8_t idx) { return g_provision_values[idx]; }
+static void provision_int_set(void const *, uint8_t idx, int value) { g_provision_values[idx] = value; }
+static int provision_int_max(void const *, uint8_t) { return 1000; }
+
+static menu_ops_t const PROVISION_MENU_OPS = test_menu_ops(
+    &provision_count,
+    &fake_label_at,
+    &provision_type_at,
+    &provision_int_has,
+    &provision_int_has,
+    &provision_int_get,
+    &provision_int_set,
+    &fake_int_min,
+    &provision_int_max,
+    &fake_int_step,
+    &fake_child_at,
+    &fake_call_func,
+    &fake_title
+);
+
+static int test_provisioning_configures_hundreds_of_values_in_one_transfer() {
+    int fake_menu = 0;
+    for (unsigned i = 0; i < array_count(g_provision_values); ++i) {
+        g_provision_values[i] = 0;
+    }
+    menu_runtime_t runtime = menu_runtime_t::base_init(&fake_menu, &PROVISION_MENU_OPS, test_display(32, 2), false);
+    runtime.service();
+
+    pipe_link_t link;
+    pipe_link_open(link);
+    static uint8_t buffer[200 * MENU_PROVISION_RECORD_SIZE];
+    menu_provision_t provision;
+    menu_provision_begin(provision, runtime, make_byte_io(&link.device, &PIPE_IO_OPS), buffer, sizeof(buffer));
+
+    static provision_record_t records[200];
+    for (unsigned i = 0; i < array_count(records); ++i) {
+        records[i].id = static_cast<uint16_t>(i);
+        records[i].value = static_cast<long>(i * 5);
+    }
+    records[0].id = 199;
+    records[0].value = 999;
+    records[199].id = 0;
+    records[199].value = 7;
+    send_provision(link, records, array_count(records));
+    provision.service();
+
+    provision_reply_t reply = read_provision_reply(link);
+    assert(reply.status == MENU_PROVISION_OK);
+    assert(reply.applied == 200);
+    assert(g_provision_values[0] == 7);
+    assert(g_provision_values[1] == 5);
+    assert(g_provision_values[150] == 750);
+    assert(g_provision_values[199] == 999);
+    assert(runtime.dirty == 1);
+    pipe_link_close(link);
+    return 0;
+}
+
+static int test_factory_defaults_capture_restore_and_modified_flags() {
+    int speed = 10;
+    int trim = 3;
+    bool enabled = false;
+    int mode = 10;
+    generic_value_ctx_t changes = { 0, 0, 0, 0, 0, 0 };
+    auto root_menu =
+        MENU("Root",
+            ITEM_ON_CHANGE(ITEM_INT("Speed", &speed, 0, 100), generic_changed, &changes),
+            ITEM_DEFAULT(ITEM_INT("Trim", &trim, -5, 5), 0),
+            ITEM_MENU("Setup",
+                MENU("Setup",
+                    ITEM_BOOL("Enabled", &enabled),
+                    ITEM_SELECT("Mode", &mode,
+                        MENU_CHOICE("A", 10),
+                        MENU_CHOICE("B", 20),
+                        MENU_CHOICE("C", 30)
+                    )
+                )
+            ),
+            ITEM_FUNC("Run", test_action)
+        );
+
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, rich_test_display(32, 4), make_input_source(0, 0), false);
+    int defaults[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    runtime.set_defaults(defaults, array_count(defaults));
+    runtime.set_persistence(0, &generic_save, &changes);
+    runtime.capture_defaults();
+    assert(defaults[0] == 10);
+    assert(!runtime.is_modified(0));
+    assert(runtime.is_modified(1));
+
+    runtime.set_show_modified(true);
+    runtime.service();
+    assert((g_display_ctx.render_lines[0].flags & MENU_RENDER_MODIFIED) == 0);
+    assert((g_display_ctx.render_lines[1].flags & MENU_RENDER_MODIFIED) != 0);
+    assert(strcmp(g_display_ctx.lines[1], " Trim: 3 *") == 0);
+
+    speed = 55;
+    enabled = true;
+    mode = 30;
+    runtime.request_redraw();
+    runtime.service();
+    assert((g_display_ctx.render_lines[0].flags & MENU_RENDER_MODIFIED) != 0);
+    assert((g_display_ctx.render_lines[2].flags & MENU_RENDER_MODIFIED) == 0);
+
+#if MENU_MAX_STACK >= 2
+    assert(runtime.is_modified(3));
+    assert(runtime.is_modified(4));
+    assert(runtime.restore_defaults(2));
+    assert(enabled == false);
+    assert(mode == 10);
+    assert(speed == 55);
+    assert(changes.save_count == 1);
+#endif
+
+    runtime.restore_defaults();
+    assert(speed == 10);
+    assert(trim == 0);
+    assert(changes.change_count == 1);
+    assert(!runtime.is_modified(0));
+    assert(!runtime.is_modified(1));
+    unsigned const saves = changes.save_count;
+    runtime.restore_defaults();
+    assert(changes.save_count == saves);
+    assert(!runtime.restore_defaults(99));
+
+    runtime.service();
+    assert((g_display_ctx.render_lines[0].flags & MENU_RENDER_MODIFIED) == 0);
+    assert(strcmp(g_display_ctx.lines[1], " Trim: 0") == 0);
+    return 0;
+}
+
+/* Pseudo-terminal: the device side behaves like a raw serial port, the host side like the PC. */
+struct pty_link_t {
+    int master;
+    int slave;
+    pipe_io_ctx_t device;
+    pipe_io_ctx_t host;
+};
+
+static bool pty_link_open(pty_link_t &link) {
+    link.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (link.master < 0) { return false; }
+    char const *name = (grantpt(link.master) == 0 && unlockpt(link.master) == 0) ? ptsname(link.master) : 0;
+    link.slave = name ? open(name, O_RDWR | O_NOCTTY) : -1;
+    if (link.slave < 0) {
+        close(link.master);
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(link.slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(link.slave, TCSANOW, &tio);
+    fcntl(link.master, F_SETFL, O_NONBLOCK);
+    fcntl(link.slave, F_SETFL, O_NONBLOCK);
+    link.device.read_fd = link.slave;
+    link.device.write_fd = link.slave;
+    link.host.read_fd = link.master;
+    link.host.write_fd = link.master;
+    return true;
+}
+
+static void pty_link_close(pty_link_t &link) {
+    close(link.slave);
+    close(link.master);
+}
+
+static void send_remote(pty_link_t &link, uint8_t type, uint8_t const *payload, uint16_t length) {
+    menu_frame_writer_t w;
+    menu_frame_begin(w, make_byte_io(&link.host, &PIPE_IO_OPS), type, length);
+    menu_frame_put(w, payload, length);
+    menu_frame_end(w);
+}
+
+/* Services the device until the host has a complete frame; returns its type. */
+static uint8_t next_remote_frame(pty_link_t &link, menu_remote_t &remote, menu_frame_reader_t &reader) {
+    menu_byte_io_t io = make_byte_io(&link.host, &PIPE_IO_OPS);
+    for (unsigned idle = 0; idle < 2000;) {
+        int ch = menu_byte_io_read(io);
+        if (ch < 0) {
+            remote.service();
+            usleep(500);
+            ++idle;
+            continue;
+        }
+        uint8_t result = menu_frame_feed(reader, static_cast<uint8_t>(ch));
+        if (result == MENU_FRAME_PENDING) { continue; }
+        assert(result == MENU_FRAME_READY);
+        return reader.type;
+    }
+    return 0;
+}
+
+static bool remote_stays_quiet(pty_link_t &link, menu_remote_t &remote) {
+    menu_byte_io_t io = make_byte_io(&link.host, &PIPE_IO_OPS);
+    for (unsigned i = 0; i < 20; ++i) {
+        remote.service();
+        usleep(500);
+        if (menu_byte_io_read(io) >= 0) { return false; }
+    }
+    return true;
+}
+
+static int test_remote_protocol_browses_and_edits_over_pty() {
+    pty_link_t link;
+    if (!pty_link_open(link)) {
+        fprintf(stderr, "remote: no pseudo-terminal available, skipped\n");
+        return 0;
+    }
+    int speed = 10;
+    bool enabled = false;
+    int mode = 10;
+    generic_value_ctx_t changes = { 0, 0, 0, 0, 0, 0 };
+    generic_value_ctx_t readonly = { 5, 0, 0, 0, 0, 0 };
+    auto root_menu =
+        MENU("Root",
+            ITEM_ON_CHANGE(ITEM_INT("Speed", &speed, 0, 100), generic_changed, &changes),
+            ITEM_MENU("Setup",
+                MENU("Setup",
+                    ITEM_BOOL("Enabled", &enabled),
+                    ITEM_SELECT("Mode", &mode,
+                        MENU_CHOICE("A", 10),
+                        MENU_CHOICE("B", 20),
+                        MENU_CHOICE("C", 30)
+                    ),
+                    ITEM_VALUE("Read", generic_get, &readonly)
+                )
+            ),
+            ITEM_FUNC("Run", test_action),
+            TEST_LOCKED(ITEM_FUNC("Locked", test_action))
+        );
+
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, test_display(32, 2), make_input_source(0, 0), false);
+    static uint8_t buffer[32];
+    static menu_remote_watch_t watches[2];
+    menu_remote_t remote;
+    menu_remote_begin(remote, runtime, make_byte_io(&link.device, &PIPE_IO_OPS), buffer, sizeof(buffer), watches, 2);
+
+    uint8_t payload[128];
+    menu_frame_reader_t reader;
+    menu_frame_reader_init(reader, payload, sizeof(payload));
+
+    uint8_t const root_path[] = { 0 };
+    send_remote(link, MENU_FRAME_LIST, root_path, sizeof(root_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_ROW);
+    assert(payload[0] == 0);
+    assert(payload[1] == ENTRY_INT);
+    assert(payload[2] == (MENU_REMOTE_ROW_READABLE | MENU_REMOTE_ROW_WRITABLE));
+    assert(menu_frame_get_i32(payload + 3) == 10);
+    assert(menu_frame_get_i32(payload + 11) == 100);
+    assert(payload[19] == 5 && memcmp(payload + 20, "Speed", 5) == 0);
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_ROW);
+    assert((payload[2] & MENU_REMOTE_ROW_HAS_CHILD) != 0);
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_ROW);
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_ROW);
+    assert(((payload[2] & MENU_REMOTE_ROW_DISABLED) != 0) == (MENU_FEATURE_VISIBILITY != 0));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_END);
+    assert(payload[0] == MENU_REMOTE_OK && payload[1] == 4);
+
+#if MENU_MAX_STACK >= 2
+    uint8_t const setup_path[] = { 1, 1 };
+    send_remote(link, MENU_FRAME_LIST, setup_path, sizeof(setup_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_ROW);
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_ROW);
+    assert(payload[1] == ENTRY_SELECT);
+    assert(menu_frame_get_i32(payload + 11) == 2);
+    assert(payload[19] == 4 && memcmp(payload + 20, "Mode", 4) == 0);
+    assert(payload[24] == 3);
+    assert(payload[25] == 1 && payload[26] == 'A');
+    assert(payload[29] == 1 && payload[30] == 'C');
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_ROW);
+    assert(payload[2] == MENU_REMOTE_ROW_READABLE);
+    assert(menu_frame_get_i32(payload + 3) == 5);
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_END);
+    assert(payload[1] == 3);
+
+    uint8_t const mode_set[] = { 2, 1, 1, 2, 0, 0, 0 };
+    send_remote(link, MENU_FRAME_SET, mode_set, sizeof(mode_set));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_SET_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && mode == 30);
+#else
+    send_remote(link, MENU_FRAME_LIST, root_path, 0);
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_LIST_END);
+    assert(payload[0] == MENU_REMOTE_MALFORMED);
+#endif
+
+    uint8_t const speed_path[] = { 1, 0 };
+    send_remote(link, MENU_FRAME_GET, speed_path, sizeof(speed_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_GET_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && menu_frame_get_i32(payload + 1) == 10);
+
+    uint8_t const speed_set[] = { 1, 0, 42, 0, 0, 0 };
+    send_remote(link, MENU_FRAME_SET, speed_set, sizeof(speed_set));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_SET_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && menu_frame_get_i32(payload + 1) == 42);
+    assert(speed == 42 && changes.change_count == 1);
+
+    uint8_t const speed_too_high[] = { 1, 0, 0xF4, 0x01, 0, 0 };
+    send_remote(link, MENU_FRAME_SET, speed_too_high, sizeof(speed_too_high));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_SET_REPLY);
+    assert(payload[0] == MENU_REMOTE_OUT_OF_RANGE && menu_frame_get_i32(payload + 1) == 42);
+
+    send_remote(link, MENU_FRAME_WATCH, speed_path, sizeof(speed_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_WATCH_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && payload[1] == 0);
+    speed = 7;
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_NOTIFY);
+    assert(payload[0] == 0 && menu_frame_get_i32(payload + 1) == 7);
+    assert(remote_stays_quiet(link, remote));
+
+#if MENU_MAX_STACK >= 2
+    /* Watching an item again returns its existing slot, even when an earlier slot is free. */
+    uint8_t const enabled_path[] = { 2, 1, 0 };
+    send_remote(link, MENU_FRAME_WATCH, enabled_path, sizeof(enabled_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_WATCH_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && payload[1] == 1);
+    uint8_t const first_slot[] = { 0 };
+    send_remote(link, MENU_FRAME_UNWATCH, first_slot, sizeof(first_slot));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_UNWATCH_REPLY);
+    send_remote(link, MENU_FRAME_WATCH, enabled_path, sizeof(enabled_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_WATCH_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && payload[1] == 1);
+    enabled = !enabled;
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_NOTIFY);
+    assert(payload[0] == 1);
+    assert(remote_stays_quiet(link, remote));
+    send_remote(link, MENU_FRAME_WATCH, speed_path, sizeof(speed_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_WATCH_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && payload[1] == 0);
+#endif
+
+    unsigned const actions = g_action_count;
+    uint8_t const run_path[] = { 1, 2 };
+    send_remote(link, MENU_FRAME_ACTIVATE, run_path, sizeof(run_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_ACTIVATE_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK && g_action_count == actions + 1);
+    uint8_t const locked_path[] = { 1, 3 };
+    send_remote(link, MENU_FRAME_ACTIVATE, locked_path, sizeof(locked_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_ACTIVATE_REPLY);
+#if MENU_FEATURE_VISIBILITY
+    assert(payload[0] == MENU_REMOTE_DISABLED && g_action_count == actions + 1);
+#else
+    assert(payload[0] == MENU_REMOTE_OK && g_action_count == actions + 2);
+#endif
+    send_remote(link, MENU_FRAME_ACTIVATE, speed_path, sizeof(speed_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_ACTIVATE_REPLY);
+    assert(payload[0] == MENU_REMOTE_READ_ONLY);
+
+    uint8_t const missing_path[] = { 1, 9 };
+    send_remote(link, MENU_FRAME_GET, missing_path, sizeof(missing_path));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_GET_REPLY);
+    assert(payload[0] == MENU_REMOTE_NOT_FOUND);
+
+    uint8_t const all_slots[] = { 0xFF };
+    send_remote(link, MENU_FRAME_UNWATCH, all_slots, sizeof(all_slots));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_UNWATCH_REPLY);
+    assert(payload[0] == MENU_REMOTE_OK);
+    speed = 8;
+    assert(remote_stays_quiet(link, remote));
+
+    uint8_t const corrupt[] = { MENU_FRAME_SYNC0, MENU_FRAME_SYNC1, MENU_FRAME_GET, 2, 0, 1, 0, 0x12, 0x34 };
+    pipe_io_write(&link.host, corrupt, sizeof(corrupt));
+    assert(next_remote_frame(link, remote, reader) == MENU_FRAME_ERROR);
+    assert(payload[0] == MENU_REMOTE_BAD_CRC);
+
+    pty_link_close(link);
+    return 0;
+}
+
+struct json_capture_t {
+    char text[1024];
+    unsigned length;
+    unsigned writes;
+    unsigned largest;
+};
+
+static void json_capture_write(void *ctx, uint8_t const *data, uint16_t len) {
+    json_capture_t &c = *static_cast<json_capture_t *>(ctx);
+    ++c.writes;
+    if (len > c.largest) { c.largest = len; }
+    for (uint16_t i = 0; i < len && c.length + 1 < sizeof(c.text); ++i) { c.text[c.length++] = static_cast<char>(data[i]); }
+    c.text[c.length] = '\0';
+}
+
+static menu_byte_io_ops_t const JSON_CAPTURE_OPS = {
+    0, &json_capture_write
+};
+
+#if MENU_FEATURE_VISIBILITY
+static void json_capture_reset(json_capture_t &c) {
+    c.text[0] = '\0';
+    c.length = 0;
+    c.writes = 0;
+    c.largest = 0;
+}
+
+static int test_json_stream_sends_snapshot_then_diffs_in_chunks() {
+    int speed = 10;
+    bool enabled = false;
+    int mode = 20;
+    bool run_hidden = false;
+    auto root_menu =
+        MENU("Root",
+            ITEM_INT("Speed", &speed, 0, 100, 5),
+            ITEM_MENU("Setup",
+                MENU("Setup",
+                    ITEM_BOOL("Enabled", &enabled),
+                    ITEM_SELECT("Mode \"x\"", &mode,
+                        MENU_CHOICE("A", 10),
+                        MENU_CHOICE("B", 20)
+                    )
+                )
+            ),
+            ITEM_HIDDEN(ITEM_FUNC("Run", test_action), bool_predicate, &run_hidden)
+        );
+
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, test_display(32, 2), make_input_source(0, 0), false);
+    json_capture_t capture;
+    json_capture_reset(capture);
+    uint8_t chunk[16];
+    menu_json_item_t seen[8];
+    menu_json_stream_t json;
+    menu_json_begin(json, runtime, make_byte_io(&capture, &JSON_CAPTURE_OPS), chunk, sizeof(chunk), seen, array_count(seen));
+
+    assert(json.diff());
+#if MENU_MAX_STACK >= 2
+    assert(strcmp(capture.text,
+        "{\"seq\":1,\"full\":true,\"items\":["
+        "{\"id\":0,\"label\":\"Speed\",\"type\":\"int\",\"value\":10,\"min\":0,\"max\":100,\"step\":5},"
+        "{\"id\":1,\"label\":\"Setup\",\"type\":\"menu\",\"items\":["
+        "{\"id\":2,\"label\":\"Enabled\",\"type\":\"bool\",\"value\":0,\"choices\":[\"Off\",\"On\"]},"
+        "{\"id\":3,\"label\":\"Mode \\\"x\\\"\",\"type\":\"select\",\"value\":1,\"choices\":[\"A\",\"B\"]}]},"
+        "{\"id\":4,\"label\":\"Run\",\"type\":\"func\"}]}\n") == 0);
+#else
+    assert(strstr(capture.text, "{\"id\":1,\"label\":\"Setup\",\"type\":\"menu\"},{\"id\":2,\"label\":\"Run\"") != 0);
+#endif
+    assert(capture.largest <= sizeof(chunk));
+    assert(capture.writes == (capture.length + sizeof(chunk) - 1) / sizeof(chunk));
+
+    json_capture_reset(capture);
+    assert(!json.diff());
+    assert(capture.length == 0);
+
+    speed = 45;
+    run_hidden = true;
+    assert(json.diff());
+#if MENU_MAX_STACK >= 2
+    assert(strcmp(capture.text, "{\"seq\":2,\"since\":1,\"changes\":[{\"id\":0,\"value\":45},{\"id\":4,\"hidden\":true}]}\n") == 0);
+#else
+    assert(strcmp(capture.text, "{\"seq\":2,\"since\":1,\"changes\":[{\"id\":0,\"value\":45},{\"id\":2,\"hidden\":true}]}\n") == 0);
+#endif
+
+#if MENU_MAX_STACK >= 2
+    json_capture_reset(capture);
+    mode = 10;
+    run_hidden = false;
+    assert(json.diff());
+    assert(strcmp(capture.text, "{\"seq\":3,\"since\":2,\"changes\":[{\"id\":3,\"value\":0},{\"id\":4,\"hidden\":false}]}\n") == 0);
+#endif
+
+    json_capture_reset(capture);
+    json.invalidate();
+    assert(json.diff());
+    assert(strncmp(capture.text, "{\"seq\":", 7) == 0);
+    assert(strstr(capture.text, "\"full\":true") != 0);
+    return 0;
+}
+#endif
+
+static int test_headless_path_api_reads_writes_and_lists_without_rendering() {
+    int max_speed = 50;
+    bool enabled = false;
+    generic_value_ctx_t changes = { 0, 0, 0, 0, 0, 0 };
+    generic_value_ctx_t readonly = { 7, 0, 0, 0, 0, 0 };
+    auto root_menu =
+        MENU("Root",
+            ITEM_MENU("Settings",
+                MENU("Settings",
+                    ITEM_MENU("Motor",
+                        MENU("Motor",
+                            ITEM_ON_CHANGE(ITEM_INT("Max Speed", &max_speed, 0, 100), generic_changed, &changes),
+                            ITEM_BOOL("Enabled", &enabled)
+                        )
+                    ),
+                    ITEM_VALUE("Uptime", generic_get, &readonly)
+                )
+            ),
+            ITEM_FUNC("Run", test_action)
+        );
+
+    menu_runtime_t headless = menu_runtime_t::make_headless(root_menu);
+    headless.service();
+    assert(headless.headless == 1);
+
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, test_display(32, 2), make_input_source(0, 0), false);
+    runtime.set_headless(true);
+    runtime.service();
+    runtime.request_redraw();
+    runtime.service();
+    assert(g_display_ctx.clear_count == 0);
+    assert(g_display_ctx.write_count == 0);
+
+    menu_cursor_t menu = { 0, 0, 0, 0 };
+    assert(headless.open_path("", menu));
+    assert(menu_runtime_t::menu_count(menu) == 2);
+    assert(!headless.open_path("Run", menu));
+    assert(!headless.open_path("Missing", menu));
+    long value = 0;
+    assert(headless.get_path("Run", &value) == MENU_VALUE_READ_ONLY);
+    assert(headless.get_path("Settings/Motor/Max Speedx", &value) == MENU_VALUE_NOT_FOUND);
+
+#if MENU_MAX_STACK >= 3
+    assert(headless.open_path("/Settings/Motor", menu));
+    assert(menu_runtime_t::menu_count(menu) == 2);
+    char label[16] = "";
+    menu_runtime_t::append_capped(label, sizeof(label), menu_runtime_t::menu_label_at(menu, 1));
+    assert(strcmp(label, "Enabled") == 0);
+
+    menu_cursor_t cur = { 0, 0, 0, 0 };
+    uint8_t idx = 0;
+    assert(headless.find_path("Settings/Motor/Enabled", cur, idx));
+    assert(cur.menu_ptr == menu.menu_ptr && idx == 1);
+
+    assert(headless.get_path("Settings/Motor/Max Speed", &value) == MENU_VALUE_OK && value == 50);
+    assert(headless.set_path("Settings/Motor/Max Speed", 80) == MENU_VALUE_OK);
+    assert(max_speed == 80);
+    assert(changes.change_count == 1);
+    assert(headless.set_path("Settings/Motor/Max Speed", 101) == MENU_VALUE_OUT_OF_RANGE);
+    assert(max_speed == 80);
+    assert(headless.set_path("Settings/Motor/Enabled", 1) == MENU_VALUE_OK && enabled);
+    assert(headless.set_path("Settings/Uptime", 3) == MENU_VALUE_READ_ONLY);
+    assert(headless.get_path("Settings/Uptime", &value) == MENU_VALUE_OK && value == 7);
+    assert(headless.set_path("Settings/Motor", 1) == MENU_VALUE_READ_ONLY);
+#else
+    assert(headless.get_path("Settings/Motor/Max Speed", &value) == MENU_VALUE_NOT_FOUND);
+#endif
+    return 0;
+}
+
+static void cli_type(pipe_link_t &link, char const *text) {
+    pipe_io_write(&link.host, reinterpret_cast<uint8_t const *>(text), static_cast<uint16_t>(strlen(text)));
+}
+
+/* Runs service() until the device goes quiet and returns everything it printed. */
+template<typename Cli>
+static char const *cli_run(Cli &cli, pipe_link_t &link, char *out, size_t capacity) {
+    size_t used = 0;
+    for (int pass = 0; pass < 8; ++pass) { cli.service(); }
+    for (;;) {
+        int ch = pipe_io_read(&link.host);
+        if (ch < 0) { break; }
+        if (used + 1 < capacity) { out[used++] = static_cast<char>(ch); }
+    }
+    out[used] = '\0';
+    return out;
+}
+
+static int test_cli_lists_navigates_and_edits_by_label_path() {
+    int speed = 40;
+    int max_speed = 50;
+    bool enabled = false;
+    int mode = 10;
+    generic_value_ctx_t changes = { 0, 0, 0, 0, 0, 0 };
+    generic_value_ctx_t readonly = { 7, 0, 0, 0, 0, 0 };
+    auto root_menu =
+        MENU("Root",
+            ITEM_ON_CHANGE(ITEM_INT("Speed", &speed, 0, 100), generic_changed, &changes),
+            ITEM_MENU("Settings",
+                MENU("Settings",
+                    ITEM_MENU("Motor",
+                        MENU("Motor",
+                            ITEM_INT("Max Speed", &max_speed, 0, 100),
+                            ITEM_BOOL("Enabled", &enabled),
+                            ITEM_SELECT("Mode", &mode,
+                                MENU_CHOICE("Slow", 10),
+                                MENU_CHOICE("Fast", 20)
+                            )
+                        )
+                    ),
+                    ITEM_VALUE("Uptime", generic_get, &readonly)
+                )
+            ),
+            ITEM_FUNC("Run", test_action),
+            TEST_LOCKED(ITEM_FUNC("Reset", test_action))
+        );
+    menu_runtime_t runtime = menu_runtime_t::make_headless(root_menu);
+    pipe_link_t link;
+    pipe_link_open(link);
+    char line[48];
+    char out[512];
+    menu_cli_t cli;
+    menu_cli_begin(cli, runtime, make_byte_io(&link.device, &PIPE_IO_OPS), line, sizeof(line));
+    assert(strcmp(cli_run(cli, link, out, sizeof(out)), "/> ") == 0);
+
+#if MENU_FEATURE_VISIBILITY
+    char const *const root_listing = "ls\r\nSpeed = 40\r\nSettings/\r\nRun()\r\nReset()  (disabled)\r\n/> ";
+#else
+    char const *const root_listing = "ls\r\nSpeed = 40\r\nSettings/\r\nRun()\r\nReset()\r\n/> ";
+#endif
+    cli_type(link, "ls\r\n");
+    assert(strcmp(cli_run(cli, link, out, sizeof(out)), root_listing) == 0);
+
+    cli_type(link, "set Speed 45\r");
+    assert(strcmp(cli_run(cli, link, out, sizeof(out)), "set Speed 45\r\nSpeed = 45\r\n/> ") == 0);
+    assert(speed == 45 && changes.change_count == 1);
+    cli_type(link, "set /Speed 101\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: out of range 0..100\r\n") != 0);
+    assert(speed == 45);
+    cli_type(link, "set Speed fast\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: bad value\r\n") != 0);
+
+    unsigned const before = g_action_count;
+    cli_type(link, "run Run\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "ok\r\n") != 0);
+    assert(g_action_count == before + 1U);
+#if MENU_FEATURE_VISIBILITY
+    cli_type(link, "run Reset\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: disabled\r\n") != 0);
+#endif
+    cli_type(link, "run Speed\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: not a function\r\n") != 0);
+    assert(g_action_count == before + 1U);
+    cli_type(link, "frobnicate\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: unknown command\r\n") != 0);
+
+    /* Backspace edits the line before it runs. */
+    cli_type(link, "get Spx\x7f" "eed\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "\r\nSpeed = 45\r\n") != 0);
+
+#if MENU_MAX_STACK >= 3
+    cli_type(link, "cd Se\t");
+    assert(strcmp(cli_run(cli, link, out, sizeof(out)), "cd Settings/") == 0);
+    cli_type(link, "M\t\r");
+    assert(strcmp(cli_run(cli, link, out, sizeof(out)), "Motor/\r\n/Settings/Motor> ") == 0);
+    cli_type(link, "ls\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "Max Speed = 50\r\nEnabled = Off\r\nMode = Slow\r\n") != 0);
+
+    /* Ambiguous prefix lists the candidates and reprints the line. */
+    cli_type(link, "get M\t");
+    assert(strcmp(cli_run(cli, link, out, sizeof(out)), "get M\r\nMax Speed  Mode  \r\n/Settings/Motor> get M") == 0);
+    cli_type(link, "\x7f\x7f\x7f\x7f\x7f\r");
+    cli_run(cli, link, out, sizeof(out));
+
+    cli_type(link, "set Max Speed 80\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "Max Speed = 80\r\n") != 0);
+    assert(max_speed == 80);
+    cli_type(link, "set Mode Fast\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "Mode = Fast\r\n") != 0);
+    assert(mode == 20);
+    cli_type(link, "set Enabled 1\r");
+    cli_run(cli, link, out, sizeof(out));
+    assert(enabled);
+    cli_type(link, "set ../Uptime 3\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: read only\r\n") != 0);
+    cli_type(link, "get ../Uptime\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "Uptime = 7\r\n") != 0);
+    cli_type(link, "get /Speed\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "Speed = 45\r\n") != 0);
+    cli_type(link, "cd ..\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "\r\n/Settings> ") != 0);
+    cli_type(link, "pwd\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "pwd\r\n/Settings\r\n") != 0);
+    cli_type(link, "cd Uptime\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: no such menu\r\n") != 0);
+    cli_type(link, "cd\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "\r\n/> ") != 0);
+    assert(cli.depth == 0);
+#else
+    cli_type(link, "get Settings/Motor/Mode\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "error: not found\r\n") != 0);
+#endif
+
+    pipe_link_close(link);
+    return 0;
+}
+
+static int test_display_stream_mirrors_frames_as_row_diffs() {
+    int speed = 10;
+    auto root_menu =
+        MENU("Rover",
+            ITEM_INT("Speed", &speed, 0, 100),
+            ITEM_FUNC("Run", test_action),
+            ITEM_FUNC("Stop", test_action),
+            ITEM_FUNC("Home", test_action)
+        );
+    pipe_link_t link;
+    pipe_link_open(link);
+    uint32_t hashes[4];
+    menu_display_stream_t stream;
+    display_t const display = menu_display_stream_begin(stream, make_byte_io(&link.device, &PIPE_IO_OPS), hashes, 4, 20, 4);
+    choice_t const choices[] = { Choice_Down };
+    script_ctx_t script = { choices, 0, 0, Choice_Invalid };
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, display, script_input(script), false);
+    stream.runtime = &runtime;
+
+    uint8_t buffer[6 + MENU_MAX_LINE];
+    menu_display_shadow_row_t rows[4];
+    menu_display_shadow_t shadow;
+    menu_display_shadow_begin(shadow, make_byte_io(&link.host, &PIPE_IO_OPS), buffer, sizeof buffer, rows, 4);
+
+    // The first frame carries every row.
+    run_until_idle(runtime, script);
+    assert(shadow.service());
+    assert(shadow.count == 4 && shadow.frame == 1);
+    assert(rows[0].kind == MENU_RENDER_ITEM && strcmp(rows[0].text, ">Speed: 10") == 0);
+    assert(rows[0].flags & MENU_RENDER_SELECTED);
+    assert(strcmp(rows[2].text, " Stop") == 0 && rows[2].item_index == 2 && rows[2].entry_type == ENTRY_FUNC);
+    for (uint8_t i = 0; i < 4; ++i) { assert(rows[i].changed == 1); }
+    assert(!shadow.service());
+
+    // Moving the highlight resends only the two rows it touched.
+    script.count = array_count(choices);
+    run_until_idle(runtime, script);
+    assert(shadow.service());
+    assert(shadow.frame == 2);
+    assert(strcmp(rows[0].text, " Speed: 10") == 0 && strcmp(rows[1].text, ">Run") == 0);
+    assert(rows[0].changed == 2 && rows[1].changed == 2 && rows[2].changed == 1 && rows[3].changed == 1);
+
+    // A redraw that changes nothing sends no bytes at all.
+    runtime.request_redraw();
+    runtime.service();
+    assert(!shadow.service());
+
+    // A value change reaches the shadow; a resync request resends every row.
+    speed = 11;
+    runtime.request_redraw();
+    runtime.service();
+    assert(shadow.service());
+    assert(strcmp(rows[0].text, " Speed: 11") == 0 && rows[0].changed == 3 && rows[1].changed == 2);
+    shadow.request_sync();
+    stream.service();
+    runtime.service();
+    assert(shadow.service());
+    assert(shadow.frame == 4);
+    for (uint8_t i = 0; i < 4; ++i) { assert(rows[i].changed == 4); }
+
+    // A damaged frame is dropped and answered with a resync request.
+    uint8_t const junk[] = { MENU_FRAME_SYNC0, MENU_FRAME_SYNC1, MENU_FRAME_DISPLAY_END, 4, 0, 9, 0, 4, 0, 0, 0 };
+    pipe_io_write(&link.device, junk, sizeof junk);
+    assert(!shadow.service());
+    stream.service();
+    runtime.service();
+    assert(shadow.service() && shadow.frame == 5);
+
+    // A row lost without a CRC error leaves the changed count short: its frame is not
+    // committed, and the resync that follows rewrites every row.
+    menu_byte_io_t const device = make_byte_io(&link.device, &PIPE_IO_OPS);
+    uint8_t const lost_row[] = { 0, MENU_RENDER_ITEM, 0, 0, ENTRY_INT, 4, 'L', 'o', 's', 't' };
+    menu_frame_writer_t w;
+    menu_frame_begin(w, device, MENU_FRAME_DISPLAY_ROW, sizeof lost_row);
+    menu_frame_put(w, lost_row, sizeof lost_row);
+    menu_frame_end(w);
+    menu_frame_begin(w, device, MENU_FRAME_DISPLAY_END, 4);
+    menu_frame_put_u16(w, 6);
+    menu_frame_put_u8(w, 4);
+    menu_frame_put_u8(w, 2);
+    menu_frame_end(w);
+    uint16_t const committed = shadow.committed;
+    assert(!shadow.service());
+    assert(shadow.committed == committed && shadow.frame == 5);
+    stream.service();
+    runtime.service();
+    assert(shadow.service() && shadow.frame == 6);
+    assert(strcmp(rows[0].text, " Speed: 11") == 0);
+    for (uint8_t i = 0; i < 4; ++i) { assert(rows[i].changed == shadow.committed); }
+    pipe_link_close(link);
+    return 0;
+}
+
+/* The flash and constexpr trees exercise every decorator, so they need the full feature set. */
+#if MENU_FEATURE_VISIBILITY && MENU_FEATURE_FORMAT
+static int g_pgm_speed = 2;
+static bool g_pgm_lamp = false;
+static int g_pgm_mode = 1;
+static int g_pgm_level = 40;
+static unsigned g_pgm_changes = 0;
+static int g_pgm_armed = 0;
+
+static int pgm_level_get(void *ctx) { return *static_cast<int *>(ctx); }
+static void pgm_level_set(void *ctx, int value) { *static_cast<int *>(ctx) = value; }
+static void pgm_count_change(void *) { ++g_pgm_changes; }
+static bool pgm_is_armed(void *ctx) { return *static_cast<int *>(ctx) != 0; }
+static void pgm_format_mode(void *, char *out, uint8_t cap) { snprintf(out, cap, "mode%d", g_pgm_mode); }
+static void pgm_arm(void *ctx) { *static_cast<int *>(ctx) = 1; }
+
+static char const pgm_title[] = "Flash";
+static char const pgm_speed_label[] = "Speed";
+
+/* The tree is constant-initialized, so on AVR the same declaration takes PROGMEM. */
+static const auto g_pgm_menu =
+    MENU(menu_flash_text(pgm_title),
+        ITEM_DEFAULT(ITEM_INT(menu_flash_text(pgm_speed_label), &g_pgm_speed, 0, 9), 2),
+        ITEM_ON_CHANGE(ITEM_BOOL("Lamp", &g_pgm_lamp), &pgm_count_change, 0),
+        ITEM_FORMAT(ITEM_SELECT("Mode", &g_pgm_mode, MENU_CHOICE("Eco", 1), MENU_CHOICE("Boost", 2)), &pgm_format_mode, 0),
+        ITEM_MENU("Tune",
+            MENU("Tune",
+                ITEM_VALUE("Level", &pgm_level_get, &pgm_level_set, &g_pgm_level, 0, 100, 5),
+                ITEM_HIDDEN(ITEM_FUNC("Hidden", test_action), &pgm_is_armed, &g_pgm_armed),
+                ITEM_FUNC_CTX("Arm", &pgm_arm, &g_pgm_armed)
+            )
+        ),
+        ITEM_DISABLED(ITEM_FUNC("Locked", test_action), &pgm_is_armed, &g_pgm_armed)
+    );
+static const auto g_pgm_root = menu_progmem(g_pgm_menu);
+
+static void reset_progmem_values() {
+    g_pgm_speed = 2;
+    g_pgm_lamp = false;
+    g_pgm_mode = 1;
+    g_pgm_level = 40;
+    g_pgm_changes = 0;
+    g_pgm_armed = 0;
+    g_action_count = 0;
+}
+
+static int test_progmem_tree_matches_ram_tree() {
+    choice_t const choices[] = {
+        Choice_Right, Choice_Up, Choice_Select, Choice_Down, Choice_Select, Choice_Down, Choice_Right,
+        Choice_Down, Choice_Select, Choice_Down, Choice_Right, Choice_Down, Choice_Right, Choice_Right,
+        Choice_Right, Choice_Up, Choice_Up, Choice_Right, Choice_Left, Choice_Down, Choice_Select, Choice_Left
+    };
+    for (unsigned steps = 0; steps <= array_count(choices); ++steps) {
+        char ram_lines[8][128];
+        reset_progmem_values();
+        script_ctx_t ram_script = { choices, steps, 0, Choice_Invalid };
+        menu_runtime_t ram = menu_runtime_t::make(g_pgm_menu, test_display(24, 4), script_input(ram_script), false);
+        run_until_idle(ram, ram_script);
+        memcpy(ram_lines, g_display_ctx.lines, sizeof ram_lines);
+        int const speed = g_pgm_speed;
+        bool const lamp = g_pgm_lamp;
+        int const mode = g_pgm_mode;
+        int const level = g_pgm_level;
+        unsigned const changes = g_pgm_changes;
+        int const armed = g_pgm_armed;
+        unsigned const actions = g_action_count;
+
+        reset_progmem_values();
+        script_ctx_t pgm_script = { choices, steps, 0, Choice_Invalid };
+        menu_runtime_t flash = menu_runtime_t::make(g_pgm_root, test_display(24, 4), script_input(pgm_script), false);
+        run_until_idle(flash, pgm_script);
+        assert(flash.depth == ram.depth);
+        assert(flash.top().selected == ram.top().selected);
+        assert(flash.editing == ram.editing);
+        for (unsigned row = 0; row < 4; ++row) {
+            assert(strcmp(g_display_ctx.lines[row], ram_lines[row]) == 0);
+        }
+        assert(g_pgm_speed == speed && g_pgm_lamp == lamp && g_pgm_mode == mode && g_pgm_level == level);
+        assert(g_pgm_changes == changes && g_pgm_armed == armed && g_action_count == actions);
+    }
+    assert(g_pgm_speed == 3 && g_pgm_lamp && g_pgm_changes == 1);
+#if MENU_MAX_STACK > 1
+    assert(g_pgm_mode == 2 && g_pgm_level == 30 && g_pgm_armed == 1);
+#endif
+
+    long value = 0;
+    menu_runtime_t flash = menu_runtime_t::make_headless(g_pgm_root);
+    assert(flash.get_path("Speed", &value) == MENU_VALUE_OK && value == g_pgm_speed);
+    assert(flash.root().ops->title(flash.root().menu_ptr).storage == MENU_TEXT_FLASH);
+    int fallback = 0;
+    assert(flash.root().ops->default_at(flash.root().menu_ptr, 0, &fallback) && fallback == 2);
+    char text[16];
+    char expected[16];
+    pgm_format_mode(0, expected, sizeof expected);
+    assert(flash.root().ops->format_value(flash.root().menu_ptr, 2, text, sizeof text) && strcmp(text, expected) == 0);
+    return 0;
+}
+
+/* Menus below MENU_SHARED_DISPATCH_ITEMS walk their pack once per ops slot and larger ones
+   share one walker; both must answer every slot alike, past the last item too. */
+static bool same_text(menu_text_t a, menu_text_t b) { return a.ptr == b.ptr && a.storage == b.storage; }
+
+template<template<typename> class Access, typename Menu>
+static void check_dispatch_paths_agree(Menu const &menu) {
+    typedef menu_item_ops_for<Menu, Access, false> per_slot;
+    typedef menu_item_ops_for<Menu, Access, true> shared;
+    void const *m = &menu;
+    for (uint8_t idx = 0; idx <= Menu::items_count; ++idx) {
+        assert(same_text(per_slot::_label_at(m, idx), shared::_label_at(m, idx)));
+        assert(per_slot::_type_at(m, idx) == shared::_type_at(m, idx));
+        assert(per_slot::_int_has(m, idx) == shared::_int_has(m, idx));
+        assert(per_slot::_scalar_has(m, idx) == shared::_scalar_has(m, idx));
+        assert(per_slot::_int_get(m, idx) == shared::_int_get(m, idx));
+        assert(per_slot::_int_min(m, idx) == shared::_int_min(m, idx));
+        assert(per_slot::_int_max(m, idx) == shared::_int_max(m, idx));
+        assert(per_slot::_int_step(m, idx) == shared::_int_step(m, idx));
+        assert(per_slot::_value_count(m, idx) == shared::_value_count(m, idx));
+        assert(per_slot::_value_selected(m, idx) == shared::_value_selected(m, idx));
+        assert(same_text(per_slot::_value_label_at(m, idx, 1), shared::_value_label_at(m, idx, 1)));
+        assert(per_slot::_hidden(m, idx) == shared::_hidden(m, idx));
+        assert(per_slot::_disabled(m, idx) == shared::_disabled(m, idx));
+        char a[16] = "";
+        char b[16] = "";
+        assert(per_slot::_format_value(m, idx, a, sizeof a) == shared::_format_value(m, idx, b, sizeof b));
+        assert(strcmp(a, b) == 0);
+        int da = -1;
+        int db = -1;
+        assert(per_slot::_default_at(m, idx, &da) == shared::_default_at(m, idx, &db) && da == db);
+        void const *ca = 0;
+        void const *cb = 0;
+        menu_ops_t const *oa = 0;
+        menu_ops_t const *ob = 0;
+        assert(per_slot::_child_at(m, idx, &ca, &oa) == shared::_child_at(m, idx, &cb, &ob));
+        assert(ca == cb && oa == ob);
+    }
+}
+
+static int test_item_dispatch_paths_agree() {
+    reset_progmem_values();
+    check_dispatch_paths_agree<menu_ram_item>(g_pgm_menu);
+    check_dispatch_paths_agree<menu_pgm_item>(g_pgm_menu);
+    check_dispatch_paths_agree<menu_ram_item>(g_pgm_menu.items.tail.tail.tail.head.child);
+    check_dispatch_paths_agree<menu_pgm_item>(g_pgm_menu.items.tail.tail.tail.head.child);
+
+    typedef decltype(g_pgm_menu) root_t;
+    menu_item_ops_for<root_t, menu_ram_item, false>::_int_set(&g_pgm_menu, 0, 5);
+    assert(g_pgm_speed == 5);
+    menu_item_ops_for<root_t, menu_pgm_item, true>::_int_set(&g_pgm_menu, 0, 6);
+    assert(g_pgm_speed == 6);
+    menu_item_ops_for<root_t, menu_ram_item, true>::_value_select(&g_pgm_menu, 2, 1);
+    assert(g_pgm_mode == 2);
+    menu_item_ops_for<root_t, menu_pgm_item, false>::_on_change(&g_pgm_menu, 1);
+    assert(g_pgm_changes == 1);
+    reset_progmem_values();
+    return 0;
+}
+
+/* Bytes a tree stops taking from SRAM once it is declared PROGMEM: one pack slot per item. */
+template<typename Item>
+static void report_item_size(char const *name) {
+    printf("  %-28s %3u bytes\n", name, static_cast<unsigned>(sizeof(pack_node<Item, pack_nil>)));
+}
+
+static int test_progmem_size_report() {
+    typedef item_select_t<select_choice_t, select_choice_t, select_choice_t> select3_t;
+    typedef menu_t<item_func_t, item_func_t> child_t;
+    printf("SRAM kept in flash per item (host sizeof, pointer size %u):\n", static_cast<unsigned>(sizeof(void *)));
+    report_item_size<item_int_t>("ITEM_INT");
+    report_item_size<item_bool_t>("ITEM_BOOL");
+    report_item_size<item_func_t>("ITEM_FUNC");
+    report_item_size<item_func_ctx_t>("ITEM_FUNC_CTX");
+    report_item_size<item_value_t>("ITEM_VALUE");
+    report_item_size<select3_t>("ITEM_SELECT (3 choices)");
+    report_item_size<item_menu_t<child_t> >("ITEM_MENU (2 funcs)");
+    report_item_size<item_meta_t<item_func_t> >("ITEM_HIDDEN(ITEM_FUNC)");
+    report_item_size<item_format_t<item_int_t> >("ITEM_FORMAT(ITEM_INT)");
+    report_item_size<item_change_t<item_int_t> >("ITEM_ON_CHANGE(ITEM_INT)");
+    report_item_size<item_default_t<item_int_t> >("ITEM_DEFAULT(ITEM_INT)");
+    printf("  %-28s %3u bytes\n", "sample tree (test progmem)", static_cast<unsigned>(sizeof g_pgm_menu));
+    return 0;
+}
+
+static int g_const_speed = 4;
+static bool g_const_lamp = true;
+static int g_const_mode = 2;
+
+static bool const_never(void *) { return false; }
+
+/* constexpr forces constant initialization: this fails to compile if any factory runs code. */
+static constexpr auto g_const_menu =
+    MENU("Const",
+        ITEM_DEFAULT(ITEM_INT("Speed", &g_const_speed, 0, 9, 3), 1),
+        ITEM_BOOL("Lamp", &g_const_lamp),
+        ITEM_SELECT("Mode", &g_const_mode, MENU_CHOICE("Eco", 1), MENU_CHOICE("Boost", 2)),
+        ITEM_MENU("More",
+            MENU("More",
+                ITEM_HIDDEN(ITEM_FUNC("Run", test_action), &const_never, 0),
+                ITEM_VALUE("Level", &pgm_level_get, &pgm_level_set, &g_pgm_level, 0, 100)
+            )
+        )
+    );
+
+static_assert(g_const_menu.items.head.item.maxv == 9 && g_const_menu.items.head.item.step == 3, "INT fields fold");
+static_assert(g_const_menu.items.head.value == 1, "decorator fields fold");
+static_assert(g_const_menu.items.tail.head.ptr == &g_const_lamp, "binding addresses fold");
+static_assert(g_const_menu.items.tail.tail.head.choices[1].value == 2, "choice tables fold");
+static_assert(g_const_menu.items.tail.tail.tail.head.child.items.tail.head.maxv == 100, "child menus fold");
+static_assert(g_const_menu.title.storage == MENU_TEXT_RAM, "titles fold");
+
+/* ITEM_MENU copies its child by value; from a separate constexpr submenu that copy folds too. */
+static constexpr auto g_const_sub = MENU("Sub", ITEM_INT("Trim", &g_const_speed, -5, 5));
+static constexpr auto g_const_parent = MENU("Parent", ITEM_MENU("Sub", g_const_sub), ITEM_FUNC("Run", test_action));
+static_assert(g_const_parent.items.head.child.items.head.minv == g_const_sub.items.head.minv, "submenu copies fold");
+static_assert(g_const_parent.items.head.child.items.head.ptr == &g_const_speed, "submenu bindings fold");
+
+static int test_constexpr_tree_runs() {
+    choice_t const choices[] = { Choice_Right, Choice_Right, Choice_Select, Choice_Down, Choice_Select };
+    script_ctx_t script = { choices, array_count(choices), 0, Choice_Invalid };
+    menu_runtime_t runtime = menu_runtime_t::make(g_const_menu, test_display(24, 4), script_input(script), false);
+    run_until_idle(runtime, script);
+    assert(g_const_speed == 7);
+    assert(!g_const_lamp);
+    assert(strstr(g_display_ctx.lines[1], "Lamp") != 0);
+    return 0;
+}
+#endif
+
+static int test_cursor_stack_restores_parent_levels() {
+    int value = 0;
+    auto root_menu =
+        MENU("Root",
+            ITEM_FUNC("A", test_action),
+            ITEM_FUNC("B", test_action),
+            ITEM_MENU("Outer",
+                MENU("Outer",
+                    ITEM_FUNC("C", test_action),
+                    ITEM_MENU("Inner",
+                        MENU("Inner",
+                            ITEM_INT("Value", &value, 0, 9)
+                        )
+                    )
+                )
+            )
+        );
+    choice_t const choices[] = { Choice_Down, Choice_Down, Choice_Right, Choice_Down, Choice_Right };
+    script_ctx_t script = { choices, array_count(choices), 0, Choice_Invalid };
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, test_display(24, 4), script_input(script), false);
+    runtime.set_show_title(true);
+#if MENU_FEATURE_BREADCRUMBS
+    runtime.set_show_breadcrumbs(true);
+#endif
+    run_until_idle(runtime, script);
+
+#if MENU_MAX_STACK > 2
+    assert(runtime.depth == 2);
+    assert(runtime.cursor_at(0).menu_ptr == &root_menu && runtime.cursor_at(0).selected == 2);
+    assert(runtime.cursor_at(1).menu_ptr == &root_menu.items.tail.tail.head.child && runtime.cursor_at(1).selected == 1);
+    assert(runtime.cursor_at(2).menu_ptr == runtime.top().menu_ptr);
+#if MENU_FEATURE_BREADCRUMBS
+    assert(strcmp(g_display_ctx.lines[0], "Root/Outer/Inner") == 0);
+#else
+    assert(strcmp(g_display_ctx.lines[0], "Inner") == 0);
+#endif
+    assert(runtime.pop());
+    assert(runtime.top().selected == 1);
+    assert(runtime.pop());
+    assert(runtime.top().menu_ptr == runtime.root().menu_ptr && runtime.top().selected == 2);
+#endif
+    assert(runtime.root().menu_ptr == &root_menu);
+    return 0;
+}
+
+#if MENU_FEATURE_VISIBILITY && MENU_FEATURE_FORMAT
+typedef menu_footprint<decltype(g_const_menu)> const_footprint_t;
+static_assert(const_footprint_t::bytes == sizeof(g_const_menu), "footprint bytes are the tree's size");
+static_assert(const_footprint_t::items == 6 && const_footprint_t::menus == 2, "footprint counts items at every level");
+static_assert(const_footprint_t::depth == 2 && const_footprint_t::max_items == 4, "footprint depth and widest menu");
+static_assert(const_footprint_t::ints == 1 && const_footprint_t::bools == 1 && const_footprint_t::selects == 1 &&
+              const_footprint_t::choices == 2 && const_footprint_t::values == 1 && const_footprint_t::funcs == 1,
+              "footprint counts each entry kind");
+static_assert(const_footprint_t::decorators == 2 && const_footprint_t::texts == 12, "footprint counts decorators and texts");
+static_assert(const_footprint_t::ops_tables == 2, "footprint counts one ops table per menu type");
+#endif
+
+static int test_menu_footprint_matches_tree_walk() {
+    int a = 0;
+    int b = 0;
+    auto twin =
+        MENU("Twin",
+            ITEM_MENU("Left", MENU("Side", ITEM_INT("A", &a, 0, 9))),
+            ITEM_MENU("Right", MENU("Side", ITEM_INT("B", &b, 0, 9))),
+            ITEM_MENU("Deep", MENU("Deep", ITEM_MENU("Deeper", MENU("Deeper", ITEM_FUNC("Go", test_action)))))
+        );
+    typedef menu_footprint<decltype(twin)> fp;
+    static_assert(fp::menus == 5 && fp::ops_tables == 4, "identical submenu types share one ops table");
+    static_assert(fp::depth == 3 && fp::max_items == 3, "depth counts menu levels");
+
+    uint16_t walked = 0;
+    menu_tree_iter_t it;
+    for (bool more = menu_tree_begin(it, &twin, &ops_for<decltype(twin)>::ops); more; more = menu_tree_next(it)) { ++walked; }
+#if MENU_MAX_STACK >= 3
+    assert(walked == fp::items);
+#else
+    assert(walked < fp::items);
+#endif
+    return 0;
+}
+
+static int test_sized_runtime_matches_tree_depth() {
+    int value = 0;
+    auto root_menu =
+        MENU("Root",
+            ITEM_FUNC("A", test_action),
+            ITEM_MENU("Outer",
+                MENU("Outer",
+                    ITEM_MENU("Inner",
+                        MENU("Inner",
+                            ITEM_INT("Value", &value, 0, 9)
+                        )
+                    )
+                )
+            )
+        );
+    typedef menu_runtime_for<decltype(root_menu)>::type sized_runtime_t;
+    static_assert(menu_tree_depth<decltype(root_menu)>::value == 3, "depth counts the root and each nested menu");
+    static_assert(menu_tree_depth<decltype(root_menu.items.tail.head.child)>::value == 2, "subtrees have their own depth");
+    static_assert(menu_is_same<sized_runtime_t, menu_sized_runtime_t<3> >::value, "runtime is sized to the tree");
+    static_assert(menu_is_same<menu_runtime_t, menu_sized_runtime_t<MENU_MAX_STACK> >::value, "default runtime");
+#if MENU_MAX_STACK > 3
+    static_assert(sizeof(sized_runtime_t) < sizeof(menu_runtime_t), "a shallow tree needs fewer cursor levels");
+#endif
+
+    choice_t const choices[] = { Choice_Down, Choice_Right, Choice_Right, Choice_Select, Choice_Up, Choice_Select };
+    script_ctx_t script = { choices, array_count(choices), 0, Choice_Invalid };
+    sized_runtime_t runtime = sized_runtime_t::make(root_menu, test_display(24, 4), script_input(script), false);
+    run_until_idle(runtime, script);
+    assert(runtime.depth == 2);
+    assert(runtime.top().menu_ptr == &root_menu.items.tail.head.child.items.head.child);
+    assert(value == 1);
+    assert(runtime.pop() && runtime.pop() && !runtime.pop());
+    return 0;
+}
+
+/* The test display and script input as concrete types, called without ops tables. */
+struct static_test_display_t : menu_display_base<static_test_display_t> {
+    test_display_ctx_t *ctx;
+
+    static_test_display_t() : ctx(0) { }
+    static_test_display_t(uint8_t w, uint8_t h) : menu_display_base<static_test_display_t>(w, h), ctx(&g_display_ctx) {
+        test_display(w, h);
+    }
+
+    void clear(void) { test_clear(ctx); }
+    void write_line(uint8_t row, char const *text) { test_write_line(ctx, row, text); }
+};
+
+struct static_script_input_t {
+    script_ctx_t *script;
+
+    menu_event_t read_event(void) {
+        if (!script || script->pos >= script->count) { return menu_event(Choice_Invalid); }
+        return menu_event(script->choices[script->pos++]);
+    }
+};
+
+static int test_static_adapters_match_type_erased_runtime() {
+    int speed = 2;
+    bool lamp = false;
+    auto root_menu =
+        MENU("Root",
+            ITEM_INT("Speed", &speed, 0, 9),
+            ITEM_BOOL("Lamp", &lamp),
+            ITEM_MENU("More",
+                MENU("More",
+                    ITEM_FUNC("Run", test_action)
+                )
+            )
+        );
+    typedef menu_runtime_for<decltype(root_menu)>::type erased_runtime_t;
+    typedef menu_runtime_for<decltype(root_menu), static_test_display_t, static_script_input_t>::type static_runtime_t;
+    static_assert(menu_is_same<static_runtime_t,
+                               basic_menu_runtime_t<static_test_display_t, static_script_input_t, menu_runtime_config<2> > >::value,
+                  "concrete adapters keep the tree-sized stack");
+    static_assert(sizeof(static_runtime_t) < sizeof(erased_runtime_t), "concrete adapters drop the ops pointers");
+
+    choice_t const choices[] = {
+        Choice_Select, Choice_Up, Choice_Select, Choice_Down, Choice_Select, Choice_Down, Choice_Right, Choice_Select, Choice_Left
+    };
+    for (unsigned steps = 0; steps <= array_count(choices); ++steps) {
+        char erased_lines[8][128];
+        speed = 2;
+        lamp = false;
+        g_action_count = 0;
+        script_ctx_t erased_script = { choices, steps, 0, Choice_Invalid };
+        erased_runtime_t erased = erased_runtime_t::make(root_menu, test_display(20, 3), script_input(erased_script), false);
+        run_until_idle(erased, erased_script);
+        memcpy(erased_lines, g_display_ctx.lines, sizeof erased_lines);
+        int const erased_speed = speed;
+        bool const erased_lamp = lamp;
+        unsigned const erased_actions = g_action_count;
+
+        speed = 2;
+        lamp = false;
+        g_action_count = 0;
+        script_ctx_t static_script = { choices, steps, 0, Choice_Invalid };
+        static_script_input_t input = { &static_script };
+        static_runtime_t runtime = static_runtime_t::make(root_menu, static_test_display_t(20, 3), input, false);
+        run_until_idle(runtime, static_script);
+        assert(runtime.depth == erased.depth && runtime.top().selected == erased.top().selected);
+        assert(runtime.editing == erased.editing);
+        for (unsigned row = 0; row < 3; ++row) {
+            assert(strcmp(g_display_ctx.lines[row], erased_lines[row]) == 0);
+        }
+        assert(speed == erased_speed && lamp == erased_lamp && g_action_count == erased_actions);
+    }
+    assert(speed == 3 && lamp && g_action_count == 1);
+
+    long value = 0;
+    static_runtime_t headless = static_runtime_t::make_headless(root_menu);
+    assert(headless.set_path("Speed", 7) == MENU_VALUE_OK && headless.get_path("Speed", &value) == MENU_VALUE_OK && value == 7);
+    return 0;
+}
+
+/* Contiguous, ascending and unordered choice values each take their own lookup path; all of
+   them must agree with a plain scan, through the RAM and the flash ops tables alike. */
+static int g_lookup_mode = 0;
+static const auto g_lookup_menu =
+    MENU("Lookup",
+        ITEM_SELECT("Channel", &g_lookup_mode, MENU_CHOICE("-1", -1), MENU_CHOICE("0", 0), MENU_CHOICE("1", 1), MENU_CHOICE("2", 2)),
+        ITEM_SELECT("Baud", &g_lookup_mode, MENU_CHOICE("1200", 1200), MENU_CHOICE("2400", 2400), MENU_CHOICE("9600", 9600),
+                    MENU_CHOICE("19200", 19200), MENU_CHOICE("31250", 31250)),
+        ITEM_SELECT("Mode", &g_lookup_mode, MENU_CHOICE("Eco", 5), MENU_CHOICE("Off", 0), MENU_CHOICE("Boost", 9), MENU_CHOICE("Again", 0)),
+        ITEM_SELECT("Empty", &g_lookup_mode)
+    );
+
+template<typename Menu> static menu_ops_t const *ram_ops_of(Menu const &) { return &ops_for<Menu>::ops; }
+template<typename Menu> static menu_ops_t const *flash_ops_of(Menu const &) { return &pgm_ops_for<Menu>::ops; }
+
+static int test_select_lookup_matches_scan_in_every_layout() {
+    assert(g_lookup_menu.items.head.lookup == (MENU_CHOICES_ASCENDING | MENU_CHOICES_CONTIGUOUS));
+    assert(g_lookup_menu.items.tail.head.lookup == MENU_CHOICES_ASCENDING);
+    assert(g_lookup_menu.items.tail.tail.head.lookup == 0);
+    assert(g_lookup_menu.items.tail.tail.tail.head.lookup == 0);
+
+    menu_ops_t const *const tables[] = { ram_ops_of(g_lookup_menu), flash_ops_of(g_lookup_menu) };
+    int const probes[] = { -2, -1, 0, 1, 2, 3, 5, 9, 1200, 2400, 9600, 9601, 19200, 31250, 31251 };
+    for (unsigned t = 0; t < array_count(tables); ++t) {
+        menu_ops_t const *ops = tables[t];
+        for (uint8_t idx = 0; idx < 4; ++idx) {
+            uint8_t const count = ops->value_count(&g_lookup_menu, idx);
+            for (unsigned p = 0; p < array_count(probes); ++p) {
+                uint8_t expected = 255;
+                for (uint8_t c = 0; c < count && expected == 255; ++c) {
+                    ops->value_select(&g_lookup_menu, idx, c);
+                    if (g_lookup_mode == probes[p]) { expected = c; }
+                }
+                g_lookup_mode = probes[p];
+                assert(ops->value_selected(&g_lookup_menu, idx) == expected);
+            }
+        }
+        g_lookup_mode = 0;
+        assert(ops->value_selected(&g_lookup_menu, 2) == 1);
+        assert(strcmp(static_cast<char const *>(ops->value_label_at(&g_lookup_menu, 1, 4).ptr), "31250") == 0);
+        assert(menu_text_char_at(ops->value_label_at(&g_lookup_menu, 1, 5), 0) == '\0');
+    }
+    return 0;
+}
+
+/* A thousand-entry list is paged through its callbacks; only rows on screen reach label_at. */
+struct list_probe_t { unsigned label_calls; uint16_t highest; uint16_t picked; };
+
+static uint16_t list_probe_count(void *) { return 1000; }
+static void list_probe_label(void *ctx, uint16_t index, char *out, uint8_t cap) {
+    list_probe_t *probe = static_cast<list_probe_t *>(ctx);
+    ++probe->label_calls;
+    if (index > probe->highest) { probe->highest = index; }
+    snprintf(out, cap, "File %u", static_cast<unsigned>(index));
+}
+static void list_probe_select(void *ctx, uint16_t index) { static_cast<list_probe_t *>(ctx)->picked = index; }
+
+static int test_list_item_pages_callback_rows() {
+    list_probe_t probe = { 0, 0, MENU_LIST_NONE };
+    menu_list_t files(&list_probe_count, &list_probe_label, &list_probe_select, &probe);
+    auto root_menu =
+        MENU("Root",
+            ITEM_LIST("Files", &files),
+            ITEM_FUNC("Other", test_action)
+        );
+    static_assert(menu_tree_depth<decltype(root_menu)>::value == 2, "a list opens one level");
+
+    choice_t choices[MENU_LIST_PAGE + 3];
+    unsigned n = 0;
+    choices[n++] = Choice_Select;
+    for (unsigned i = 0; i < MENU_LIST_PAGE; ++i) { choices[n++] = Choice_Down; }
+    choices[n++] = Choice_Select;
+    choices[n++] = Choice_Select;
+    script_ctx_t script = { choices, n, 0, Choice_Invalid };
+    typedef menu_runtime_for<decltype(root_menu)>::type runtime_t;
+    runtime_t runtime = runtime_t::make(root_menu, test_display(24, 4), script_input(script), false);
+
+    run_until_idle(runtime, script);
+
+    assert(runtime.depth == 1);
+    assert(files.first == MENU_LIST_PAGE);
+    assert(files.chosen == 2 * MENU_LIST_PAGE - 1);
+    assert(probe.picked == files.chosen);
+    assert(probe.highest < 2 * MENU_LIST_PAGE);
+    assert(probe.label_calls < 8u * (MENU_LIST_PAGE + 4));
+    char expected[24];
+    snprintf(expected, sizeof expected, ">File %u", static_cast<unsigned>(files.chosen));
+    assert(strcmp(g_display_ctx.lines[3], expected) == 0);
+
+    menu_cursor_t const page = runtime.top();
+    assert(runtime_t::menu_count(page) == MENU_LIST_PAGE + 2);
+    assert(runtime_t::menu_type_at(page, 0) == ENTRY_FUNC);
+    runtime_t::menu_call_func(page, 0);
+    assert(files.first == 0 && runtime_t::menu_count(page) == MENU_LIST_PAGE + 1);
+
+    void const *child = 0; menu_ops_t const *child_ops = 0;
+    assert(flash_ops_of(root_menu)->child_at(&root_menu, 0, &child, &child_ops));
+    assert(child == &files && child_ops == runtime.top().ops);
+    return 0;
+}
+
+/* List pages are not part of the item id space, so ids after a list survive its count changing. */
+static uint16_t g_list_devices = 0;
+static uint16_t list_devices_count(void *) { return g_list_devices; }
+static void list_devices_label(void *, uint16_t index, char *out, uint8_t cap) { snprintf(out, cap, "Dev %u", static_cast<unsigned>(index)); }
+
+/* Defined in host_tests_walk.cpp. */
+uint16_t host_walk_item_count(void const *root_ptr, menu_ops_t const *root_ops);
+
+static int test_list_item_keeps_tree_ids_stable() {
+    int trim = 3;
+    menu_list_t devices(&list_devices_count, &list_devices_label, 0, 0);
+    auto root_menu =
+        MENU("Root",
+            ITEM_LIST("Devices", &devices),
+            ITEM_INT("Trim", &trim, 0, 9)
+        );
+
+    g_list_devices = 0;
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, test_display(24, 4), make_input_source(0, 0), false);
+    int defaults[4] = { 0, 0, 0, 0 };
+    runtime.set_defaults(defaults, array_count(defaults));
+    runtime.capture_defaults();
+    assert(defaults[1] == 3);
+
+    g_list_devices = 3;
+    trim = 7;
+    assert(runtime.is_modified(1));
+    runtime.restore_defaults();
+    assert(trim == 3);
+    trim = 5;
+    assert(runtime.restore_defaults(1) && trim == 3);
+
+    /* A walk compiled in another file skips the list page too. */
+    g_list_devices = 5;
+    uint16_t count = 0;
+    menu_tree_iter_t it;
+    for (bool ok = menu_tree_begin(it, runtime.root().menu_ptr, runtime.root().ops); ok; ok = menu_tree_next(it)) { ++count; }
+    assert(count == 2);
+    assert(host_walk_item_count(runtime.root().menu_ptr, runtime.root().ops) == 2);
+    g_list_devices = 0;
+    return 0;
+}
+
+/* A tree-sized runtime deeper than MENU_MAX_STACK still reaches its deepest items by id and
+   through the byte-stream adapters. */
+static int test_sized_runtime_walks_below_max_stack() {
+    int deep = 8;
+    auto root_menu =
+        MENU("Root",
+            ITEM_MENU("A",
+                MENU("A",
+                    ITEM_MENU("B",
+                        MENU("B",
+                            ITEM_MENU("C",
+                                MENU("C",
+                                    ITEM_DEFAULT(ITEM_INT("Deep", &deep, 0, 9), 2)
+                                )
+                            )
+                        )
+                    )
+                )
+            )
+        );
+    typedef menu_runtime_for<decltype(root_menu)>::type runtime_t;
+    static_assert(runtime_t::levels == 4, "root plus three submenus");
+    runtime_t runtime = runtime_t::make(root_menu, test_display(24, 4), make_input_source(0, 0), false);
+
+    assert(runtime.is_modified(3));
+    runtime.restore_defaults();
+    assert(deep == 2);
+    deep = 6;
+    assert(runtime.restore_defaults(0) && deep == 2);
+
+    pipe_link_t link;
+    pipe_link_open(link);
+    char line[48];
+    char out[128];
+    basic_menu_cli_t<runtime_t> cli;
+    menu_cli_begin(cli, runtime, make_byte_io(&link.device, &PIPE_IO_OPS), line, sizeof(line));
+    assert(strcmp(cli_run(cli, link, out, sizeof(out)), "/> ") == 0);
+    cli_type(link, "set /A/B/C/Deep 7\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "\r\nDeep = 7\r\n") != 0);
+    assert(deep == 7);
+    cli_type(link, "cd A/B/C\r");
+    assert(strstr(cli_run(cli, link, out, sizeof(out)), "/A/B/C> ") != 0);
+    pipe_link_close(link);
+    return 0;
+}
+
+/* The modified marker covers windows longer than one 32-row mask. */
+static uint8_t g_marked_items[64];
+static void record_marked_line(void *, menu_render_line_t const *line) {
+    if (line && line->kind == MENU_RENDER_ITEM && line->item_index < array_count(g_marked_items)) {
+        g_marked_items[line->item_index] = (line->flags & MENU_RENDER_MODIFIED) ? 1 : 0;
+    }
+}
+static display_ops_t const MARKED_DISPLAY_OPS = { 0, 0, 0, &record_marked_line };
+
+static int test_modified_marker_spans_long_windows() {
+    int v[34];
+    for (unsigned i = 0; i < array_count(v); ++i) { v[i] = 1; }
+#define MARKED_INT(i) ITEM_DEFAULT(ITEM_INT("V", &v[i], 0, 9), 1)
+    auto root_menu =
+        MENU("Long",
+            MARKED_INT(0), MARKED_INT(1), MARKED_INT(2), MARKED_INT(3), MARKED_INT(4), MARKED_INT(5), MARKED_INT(6),
+            MARKED_INT(7), MARKED_INT(8), MARKED_INT(9), MARKED_INT(10), MARKED_INT(11), MARKED_INT(12), MARKED_INT(13),
+            MARKED_INT(14), MARKED_INT(15), MARKED_INT(16), MARKED_INT(17), MARKED_INT(18), MARKED_INT(19), MARKED_INT(20),
+            MARKED_INT(21), MARKED_INT(22), MARKED_INT(23), MARKED_INT(24), MARKED_INT(25), MARKED_INT(26), MARKED_INT(27),
+            MARKED_INT(28), MARKED_INT(29), MARKED_INT(30), MARKED_INT(31), MARKED_INT(32), MARKED_INT(33)
+        );
+#undef MARKED_INT
+    v[0] = 2;
+    v[32] = 3;
+    v[33] = 4;
+    memset(g_marked_items, 9, sizeof g_marked_items);
+    menu_runtime_t runtime = menu_runtime_t::make(root_menu, make_display(24, 0, 0, &MARKED_DISPLAY_OPS), make_input_source(0, 0), false);
+    runtime.set_show_modified(true);
+    runtime.service();
+    for (uint8_t i = 0; i < array_count(v); ++i) {
+        assert(g_marked_items[i] == ((i == 0 || i == 32 || i == 33) ? 1 : 0));
+    }
+    return 0;
+}
+
+static int test_long_to_str_formats_full_width() {
+    char buf[3 * sizeof(long) + 2];
+    char expect[sizeof(buf)];
+    snprintf(expect, sizeof(expect), "%ld", LONG_MIN);
+    assert(strcmp(menu_runtime_t::long_to_str(LONG_MIN, buf, sizeof(buf)), expect) == 0);
+    snprintf(expect, sizeof(expect), "%ld", LONG_MAX);
+    assert(strcmp(menu_runtime_t::long_to_str(LONG_MAX, buf, sizeof(buf)), expect) == 0);
+    assert(strcmp(menu_runtime_t::long_to_str(65535L, buf, sizeof(buf)), "65535") == 0);
+    assert(strcmp(menu_runtime_t::long_to_str(-40000L, buf, 4), "-40") == 0);
+    return 0;
+}
+
 int main(int argc, char **argv) {
     if (argc == 2) {
         if (strcmp(argv[1], "single") == 0) { return test_single_declaration_navigation(); }
+#if MENU_FEATURE_LEGACY_INPUT && MENU_FEATURE_LEGACY_DISPLAY
         if (strcmp(argv[1], "legacy") == 0) { return test_legacy_callbacks_still_work(); }
+#endif
+#if MENU_FEATURE_LEGACY_INPUT && MENU_FEATURE_LEGACY_DISPLAY
         if (strcmp(argv[1], "manual-display") == 0) { return test_manual_legacy_display_initialization_is_safe(); }
+#endif
         if (strcmp(argv[1], "null-int") == 0) { return test_null_int_item_is_safe(); }
         if (strcmp(argv[1], "empty") == 0) { return test_empty_menu_is_valid(); }
         if (strcmp(argv[1], "inverted-range") == 0) { return test_inverted_int_range_is_normalized_for_editing(); }
@@ -1970,7 +3683,9 @@ int main(int argc, char **argv) {
         if (strcmp(argv[1], "event-input") == 0) { return test_context_event_input_provider(); }
         if (strcmp(argv[1], "empty-input") == 0) { return test_empty_and_null_input_sources_are_inert(); }
         if (strcmp(argv[1], "adapter-construction") == 0) { return test_public_adapter_construction_is_stable(); }
+#if MENU_FEATURE_LEGACY_DISPLAY
         if (strcmp(argv[1], "display-fallback") == 0) { return test_partial_display_ops_fall_back_to_legacy_callbacks(); }
+#endif
         if (strcmp(argv[1], "stack-limit") == 0) { return test_stack_limit_prevents_overflow(); }
         if (strcmp(argv[1], "push-pop-edit") == 0) { return test_public_push_pop_clear_edit_state(); }
         if (strcmp(argv[1], "bool") == 0) { return test_bool_item_toggles_inline_value(); }
@@ -1980,17 +3695,39 @@ int main(int argc, char **argv) {
         if (strcmp(argv[1], "null-value") == 0) { return test_null_value_items_are_safe(); }
         if (strcmp(argv[1], "helpers") == 0) { return test_factory_helpers_define_menu_without_macros(); }
         if (strcmp(argv[1], "const-menu") == 0) { return test_static_const_menu_declaration_is_supported(); }
+#if MENU_FEATURE_FORMAT
         if (strcmp(argv[1], "value-hooks") == 0) { return test_step_generic_value_format_change_and_persistence_hooks(); }
+#endif
+#if MENU_FEATURE_FORMAT
         if (strcmp(argv[1], "formatter-empty-value") == 0) { return test_custom_formatters_render_without_backing_value_or_choices(); }
+#endif
+#if MENU_FEATURE_VISIBILITY
         if (strcmp(argv[1], "visibility") == 0) { return test_hidden_disabled_items_and_rich_render_flags(); }
+#endif
+#if MENU_FEATURE_VISIBILITY && MENU_FEATURE_NUMBERING
         if (strcmp(argv[1], "hidden-numbering") == 0) { return test_hidden_items_do_not_leave_numbering_gaps(); }
+#endif
+#if MENU_FEATURE_VISIBILITY
         if (strcmp(argv[1], "dynamic-hidden-edit") == 0) { return test_editing_is_cleared_when_selected_item_becomes_hidden(); }
+#endif
+#if MENU_FEATURE_VISIBILITY
         if (strcmp(argv[1], "dynamic-visibility-redraw") == 0) { return test_dynamic_visibility_redraws_when_selection_is_clamped(); }
+#endif
+#if MENU_FEATURE_VISIBILITY
         if (strcmp(argv[1], "predicate-redraw") == 0) { return test_request_redraw_updates_predicate_driven_rows(); }
+#endif
+#if MENU_FEATURE_VISIBILITY
         if (strcmp(argv[1], "interrupted-edit") == 0) { return test_interrupted_edit_restores_original_value(); }
+#endif
+#if MENU_FEATURE_VISIBILITY
         if (strcmp(argv[1], "interrupted-disabled-edit") == 0) { return test_interrupted_edit_on_disabled_item_restores_original_value(); }
+#endif
+#if MENU_FEATURE_POINTER_EVENTS
         if (strcmp(argv[1], "row-encoder") == 0) { return test_row_and_encoder_events_drive_menu_without_button_polling(); }
+#endif
+#if MENU_FEATURE_BREADCRUMBS
         if (strcmp(argv[1], "breadcrumbs") == 0) { return test_breadcrumb_title_and_affordance_rendering(); }
+#endif
         if (strcmp(argv[1], "context-func") == 0) { return test_context_function_item_keeps_action_state_inline(); }
         if (strcmp(argv[1], "title") == 0) { return test_title_rendering_is_optional_and_tracks_current_menu(); }
         if (strcmp(argv[1], "one-row-title") == 0) { return test_title_does_not_hide_only_row_display(); }
@@ -2000,13 +3737,43 @@ int main(int argc, char **argv) {
         if (strcmp(argv[1], "reset-nav") == 0) { return test_reset_navigation_returns_to_root_and_clears_editing(); }
         if (strcmp(argv[1], "bad-depth") == 0) { return test_service_recovers_invalid_navigation_depth(); }
         if (strcmp(argv[1], "default-runtime") == 0) { return test_default_runtime_is_inert(); }
+        if (strcmp(argv[1], "provision") == 0) { return test_provisioning_applies_validated_batch_over_pipe(); }
+        if (strcmp(argv[1], "provision-bulk") == 0) { return test_provisioning_configures_hundreds_of_values_in_one_transfer(); }
+        if (strcmp(argv[1], "defaults") == 0) { return test_factory_defaults_capture_restore_and_modified_flags(); }
+        if (strcmp(argv[1], "remote") == 0) { return test_remote_protocol_browses_and_edits_over_pty(); }
+#if MENU_FEATURE_VISIBILITY
+        if (strcmp(argv[1], "json") == 0) { return test_json_stream_sends_snapshot_then_diffs_in_chunks(); }
+#endif
+        if (strcmp(argv[1], "headless") == 0) { return test_headless_path_api_reads_writes_and_lists_without_rendering(); }
+        if (strcmp(argv[1], "cli") == 0) { return test_cli_lists_navigates_and_edits_by_label_path(); }
+        if (strcmp(argv[1], "display_stream") == 0) { return test_display_stream_mirrors_frames_as_row_diffs(); }
+#if MENU_FEATURE_VISIBILITY && MENU_FEATURE_FORMAT
+        if (strcmp(argv[1], "progmem") == 0) { return test_progmem_tree_matches_ram_tree(); }
+        if (strcmp(argv[1], "progmem_sizes") == 0) { return test_progmem_size_report(); }
+        if (strcmp(argv[1], "dispatch") == 0) { return test_item_dispatch_paths_agree(); }
+        if (strcmp(argv[1], "constexpr") == 0) { return test_constexpr_tree_runs(); }
+#endif
+        if (strcmp(argv[1], "cursor_stack") == 0) { return test_cursor_stack_restores_parent_levels(); }
+        if (strcmp(argv[1], "footprint") == 0) { return test_menu_footprint_matches_tree_walk(); }
+        if (strcmp(argv[1], "sized-stack") == 0) { return test_sized_runtime_matches_tree_depth(); }
+        if (strcmp(argv[1], "static-adapters") == 0) { return test_static_adapters_match_type_erased_runtime(); }
+        if (strcmp(argv[1], "select-lookup") == 0) { return test_select_lookup_matches_scan_in_every_layout(); }
+        if (strcmp(argv[1], "list-item") == 0) { return test_list_item_pages_callback_rows(); }
+        if (strcmp(argv[1], "list-ids") == 0) { return test_list_item_keeps_tree_ids_stable(); }
+        if (strcmp(argv[1], "sized-walk") == 0) { return test_sized_runtime_walks_below_max_stack(); }
+        if (strcmp(argv[1], "modified-long") == 0) { return test_modified_marker_spans_long_windows(); }
+        if (strcmp(argv[1], "long-to-str") == 0) { return test_long_to_str_formats_full_width(); }
         fprintf(stderr, "unknown test: %s\n", argv[1]);
         return 2;
     }
 
     test_single_declaration_navigation();
+#if MENU_FEATURE_LEGACY_INPUT && MENU_FEATURE_LEGACY_DISPLAY
     test_legacy_callbacks_still_work();
+#endif
+#if MENU_FEATURE_LEGACY_INPUT && MENU_FEATURE_LEGACY_DISPLAY
     test_manual_legacy_display_initialization_is_safe();
+#endif
     test_null_int_item_is_safe();
     test_empty_menu_is_valid();
     test_inverted_int_range_is_normalized_for_editing();
@@ -2029,7 +3796,9 @@ int main(int argc, char **argv) {
     test_context_event_input_provider();
     test_empty_and_null_input_sources_are_inert();
     test_public_adapter_construction_is_stable();
+#if MENU_FEATURE_LEGACY_DISPLAY
     test_partial_display_ops_fall_back_to_legacy_callbacks();
+#endif
     test_stack_limit_prevents_overflow();
     test_public_push_pop_clear_edit_state();
     test_bool_item_toggles_inline_value();
@@ -2039,17 +3808,39 @@ int main(int argc, char **argv) {
     test_null_value_items_are_safe();
     test_factory_helpers_define_menu_without_macros();
     test_static_const_menu_declaration_is_supported();
+#if MENU_FEATURE_FORMAT
     test_step_generic_value_format_change_and_persistence_hooks();
+#endif
+#if MENU_FEATURE_FORMAT
     test_custom_formatters_render_without_backing_value_or_choices();
+#endif
+#if MENU_FEATURE_VISIBILITY
     test_hidden_disabled_items_and_rich_render_flags();
+#endif
+#if MENU_FEATURE_VISIBILITY && MENU_FEATURE_NUMBERING
     test_hidden_items_do_not_leave_numbering_gaps();
+#endif
+#if MENU_FEATURE_VISIBILITY
     test_editing_is_cleared_when_selected_item_becomes_hidden();
+#endif
+#if MENU_FEATURE_VISIBILITY
     test_dynamic_visibility_redraws_when_selection_is_clamped();
+#endif
+#if MENU_FEATURE_VISIBILITY
     test_request_redraw_updates_predicate_driven_rows();
+#endif
+#if MENU_FEATURE_VISIBILITY
     test_interrupted_edit_restores_original_value();
+#endif
+#if MENU_FEATURE_VISIBILITY
     test_interrupted_edit_on_disabled_item_restores_original_value();
+#endif
+#if MENU_FEATURE_POINTER_EVENTS
     test_row_and_encoder_events_drive_menu_without_button_polling();
+#endif
+#if MENU_FEATURE_BREADCRUMBS
     test_breadcrumb_title_and_affordance_rendering();
+#endif
     test_context_function_item_keeps_action_state_inline();
     test_title_rendering_is_optional_and_tracks_current_menu();
     test_title_does_not_hide_only_row_display();
@@ -2059,5 +3850,30 @@ int main(int argc, char **argv) {
     test_reset_navigation_returns_to_root_and_clears_editing();
     test_service_recovers_invalid_navigation_depth();
     test_default_runtime_is_inert();
+    test_provisioning_applies_validated_batch_over_pipe();
+    test_provisioning_configures_hundreds_of_values_in_one_transfer();
+    test_factory_defaults_capture_restore_and_modified_flags();
+    test_remote_protocol_browses_and_edits_over_pty();
+#if MENU_FEATURE_VISIBILITY
+    test_json_stream_sends_snapshot_then_diffs_in_chunks();
+#endif
+    test_headless_path_api_reads_writes_and_lists_without_rendering();
+    test_cli_lists_navigates_and_edits_by_label_path();
+    test_display_stream_mirrors_frames_as_row_diffs();
+#if MENU_FEATURE_VISIBILITY && MENU_FEATURE_FORMAT
+    test_progmem_tree_matches_ram_tree();
+    test_item_dispatch_paths_agree();
+    test_constexpr_tree_runs();
+#endif
+    test_cursor_stack_restores_parent_levels();
+    test_menu_footprint_matches_tree_walk();
+    test_sized_runtime_matches_tree_depth();
+    test_static_adapters_match_type_erased_runtime();
+    test_select_lookup_matches_scan_in_every_layout();
+    test_list_item_pages_callback_rows();
+    test_list_item_keeps_tree_ids_stable();
+    test_sized_runtime_walks_below_max_stack();
+    test_modified_marker_spans_long_windows();
+    test_long_to_str_formats_full_width();
     return 0;
 }
@@ -0,0 +1,11 @@
+/* Second translation unit of the host tests. It walks trees declared in host_tests.cpp, so
+   anything the walk compares by address must be the same object in both files. Build it
+   together with host_tests.cpp. */
+#include "../BetterMenu.h"
+
+uint16_t host_walk_item_count(void const *root_ptr, menu_ops_t const *root_ops) {
+    menu_tree_iter_t it;
+    uint16_t count = 0;
+    for (bool ok = menu_tree_begin(it, root_ptr, root_ops); ok; ok = menu_tree_next(it)) { ++count; }
+    return count;
+}
@@ -0,0 +1,449 @@
+import assert from "node:assert/strict";
+
+// Minimal DOM and wasm stand-ins that count every DOM write the adapter makes.
+let mutations = 0;
+let created = 0;
+
+class FakeClassList {
+  constructor(element) {
+    this.element = element;
+    this.names = new Set();
+  }
+  add(...names) {
+    names.forEach((name) => this.toggle(name, true));
+  }
+  remove(...names) {
+    names.forEach((name) => this.toggle(name, false));
+  }
+  toggle(name, force = !this.names.has(name)) {
+    mutations += 1;
+    if (force) this.names.add(name);
+    else this.names.delete(name);
+    return force;
+  }
+  contains(name) {
+    return this.names.has(name);
+  }
+}
+
+class FakeElement {
+  constructor(tag) {
+    created += 1;
+    this.tag = tag;
+    this.children = [];
+    this.parentNode = null;
+    this.attributes = {};
+    this.listeners = {};
+    this.dataset = {};
+    this.classList = new FakeClassList(this);
+    this.text = "";
+    const styles = {};
+    this.style = new Proxy(styles, {
+      set(target, key, value) {
+        mutations += 1;
+        target[key] = value;
+        return true;
+      }
+    });
+    styles.setProperty = (key, value) => {
+      mutations += 1;
+      styles[key] = value;
+    };
+  }
+  get className() {
+    return [...this.classList.names].join(" ");
+  }
+  set className(value) {
+    mutations += 1;
+    this.classList.names = new Set(value.split(/\s+/).filter(Boolean));
+  }
+  get textContent() {
+    return this.text + this.children.map((child) => child.textContent).join("");
+  }
+  set textContent(value) {
+    mutations += 1;
+    this.children.forEach((child) => (child.parentNode = null));
+    this.children = [];
+    this.text = value;
+  }
+  set innerHTML(value) {
+    mutations += 1;
+    this.text = value.replace(/<[^>]*>/g, "");
+  }
+  get firstElementChild() {
+    return this.children[0] || null;
+  }
+  get lastElementChild() {
+    return this.children[this.children.length - 1] || null;
+  }
+  setAttribute(key, value) {
+    mutations += 1;
+    this.attributes[key] = value;
+  }
+  addEventListener(type, handler) {
+    this.listeners[type] = handler;
+  }
+  detach() {
+    if (!this.parentNode) return;
+    const siblings = this.parentNode.children;
+    siblings.splice(siblings.indexOf(this), 1);
+    this.parentNode = null;
+  }
+  append(...nodes) {
+    nodes.forEach((node) => this.insertBefore(node, null));
+  }
+  insertBefore(node, ref) {
+    mutations += 1;
+    node.detach();
+    const index = ref ? this.children.indexOf(ref) : this.children.length;
+    this.children.splice(index, 0, node);
+    node.parentNode = this;
+    return node;
+  }
+  remove() {
+    mutations += 1;
+    this.detach();
+  }
+  replaceWith(node) {
+    mutations += 1;
+    const parent = this.parentNode;
+    const index = parent.children.indexOf(this);
+    node.detach();
+    parent.children[index] = node;
+    node.parentNode = parent;
+    this.parentNode = null;
+  }
+  querySelector(selector) {
+    const name = selector.replace(/^\./, "");
+    for (const child of this.children) {
+      if (child.classList.contains(name)) return child;
+      const found = child.querySelector(selector);
+      if (found) return found;
+    }
+    return null;
+  }
+  getBoundingClientRect() {
+    return { width: 0, height: 0 };
+  }
+}
+
+const menu = new FakeElement("div");
+const contentPanel = new FakeElement("section");
+const title = new FakeElement("h2");
+const body = new FakeElement("p");
+const keyHandlers = {};
+let frames = [];
+
+globalThis.document = {
+  body: new FakeElement("body"),
+  createElement: (tag) => new FakeElement(tag),
+  querySelector: (selector) => ({ "#menu": menu, ".content-panel": contentPanel, "#content-title": title, "#content-body": body })[selector] || null,
+  querySelectorAll: () => []
+};
+globalThis.window = { addEventListener: (type, handler) => (keyHandlers[type] = handler) };
+globalThis.requestAnimationFrame = (callback) => {
+  frames.push(callback);
+  return frames.length;
+};
+globalThis.cancelAnimationFrame = () => {};
+
+function runFrames() {
+  const pending = frames;
+  frames = [];
+  pending.forEach((callback) => callback());
+}
+
+// Fake wasm module: a seven-item menu behind a title row, shown five rows at a time.
+const memory = { buffer: new ArrayBuffer(4096) };
+const TABLE = 256;
+const EVENTS = 2048;
+const labels = ["Drive mode", "Max speed", "Headlights", "Pitch trim", "PID tuning", "Sensors", "E-STOP"];
+let selected = 0;
+let top = 0;
+let frameCounter = 0;
+let batches = 0;
+const lastText = [];
+
+function writeTable() {
+  const view = new DataView(memory.buffer, TABLE);
+  const bytes = new Uint8Array(memory.buffer);
+  const rows = [{ kind: 1, item: 255, flags: 0, text: "Rover" }];
+  for (let i = top; i < top + 5; i += 1) {
+    const flags = i === selected ? 1 : 0;
+    rows.push({ kind: 2, item: i, type: 2, flags, text: `${flags ? ">" : " "}${labels[i]}: ${i * 10}` });
+  }
+  view.setUint16(0, 2, true);
+  view.setUint16(2, 16, true);
+  view.setUint16(4, 108, true);
+  view.setUint8(6, rows.length);
+  frameCounter += 1;
+  view.setUint32(8, frameCounter, true);
+  view.setUint8(12, top);
+  view.setUint8(13, labels.length);
+  view.setUint8(14, 5);
+  rows.forEach((row, i) => {
+    const record = TABLE + 16 + i * 108;
+    const key = `${row.item}|${row.flags}|${row.text}`;
+    if (lastText[i] !== key) {
+      lastText[i] = key;
+      view.setUint32(record - TABLE + 8, frameCounter, true);
+    }
+    bytes[record + 1] = row.item;
+    bytes[record + 2] = row.kind;
+    bytes[record + 3] = row.type || 0;
+    bytes[record + 4] = row.flags;
+    bytes[record + 5] = 1;
+    bytes.set(new TextEncoder().encode(`${row.text}\0`), record + 12);
+  });
+}
+
+const exports = {
+  memory,
+  bm_init: writeTable,
+  bm_row_table: () => TABLE,
+  bm_event_buffer: () => EVENTS,
+  bm_event_capacity: () => 32,
+  bm_send_events(ptr, count) {
+    batches += 1;
+    const view = new DataView(memory.buffer, ptr);
+    for (let i = 0; i < count; i += 1) {
+      const choice = view.getUint32(i * 8, true);
+      if (choice === 4) selected = Math.min(labels.length - 1, selected + 1);
+      if (choice === 3) selected = Math.max(0, selected - 1);
+      if (choice === 7) selected = top + view.getUint8(i * 8 + 4) - 1;
+    }
+    top = Math.min(Math.max(top, selected - 4), selected);
+    writeTable();
+  },
+  bm_armed: () => 0,
+  bm_battery_percent: () => 80
+};
+globalThis.fetch = async () => ({ ok: true, clone() { return this; }, arrayBuffer: async () => new ArrayBuffer(0) });
+WebAssembly.instantiateStreaming = async () => ({ instance: { exports } });
+
+const { initWebMenuDomAdapter } = await import("../docs/web-adapter/web_menu_dom_adapter.js");
+initWebMenuDomAdapter({ content: {}, icons: {} });
+await new Promise((resolve) => setTimeout(resolve, 0));
+runFrames();
+
+const rowLabels = () => menu.children.filter((node) => node.classList.contains("row")).map((node) => node.children[1].textContent);
+assert.deepEqual(rowLabels(), labels.slice(0, 5));
+assert.equal(menu.children[0].classList.contains("menu-header"), true);
+assert.equal(menu.lastElementChild.classList.contains("menu-scrollbar"), true);
+const firstRows = [...menu.children];
+
+function press(key) {
+  keyHandlers.keydown({ key, preventDefault() {} });
+}
+
+// Moving the highlight only flips two classes and the content pane text.
+mutations = 0;
+created = 0;
+press("ArrowDown");
+assert.equal(mutations, 0, "input is queued until the next animation frame");
+runFrames();
+assert.equal(created, 0);
+assert.equal(mutations, 4);
+assert.deepEqual([...menu.children], firstRows);
+assert.equal(firstRows[2].classList.contains("selected"), true);
+assert.equal(firstRows[1].classList.contains("selected"), false);
+assert.equal(title.textContent, "Max speed");
+
+// Key repeat within one frame is sent as one batch and painted once.
+const before = batches;
+press("ArrowDown");
+press("ArrowDown");
+press("ArrowDown");
+runFrames();
+assert.equal(batches, before + 1);
+assert.equal(selected, 4);
+
+// Scrolling by one row reuses the four rows that stay visible and builds only the new one.
+mutations = 0;
+created = 0;
+press("ArrowDown");
+runFrames();
+assert.deepEqual(rowLabels(), labels.slice(1, 6));
+assert.equal(created, 4);
+assert.equal(menu.children[1], firstRows[2]);
+assert.ok(mutations <= 20, `scroll step made ${mutations} DOM writes`);
+
+// A click queued behind a key press lands on the item that was clicked, not on whatever
+// the key press moved into its display row; a click on a row that scrolled away is dropped.
+const rowNode = (label) => menu.children.find((node) => node.classList.contains("row") && node.children[1].textContent === label);
+press("ArrowUp");
+press("ArrowUp");
+runFrames();
+assert.deepEqual(rowLabels(), labels.slice(1, 6));
+press("ArrowDown");
+press("ArrowDown");
+press("ArrowDown");
+rowNode("Headlights").listeners.click();
+runFrames();
+assert.deepEqual(rowLabels(), labels.slice(2, 7));
+assert.equal(selected, 2);
+press("ArrowUp");
+press("ArrowUp");
+rowNode("E-STOP").listeners.click();
+runFrames();
+assert.deepEqual(rowLabels(), labels.slice(0, 5));
+assert.equal(selected, 0, "the click on a row scrolled out of view was dropped");
+
+// An unchanged frame counter skips the frame entirely.
+mutations = 0;
+exports.bm_send_events = () => {};
+press("ArrowDown");
+runFrames();
+assert.equal(mutations, 0);
+
+// Modules that export their tree are navigated in JS: moving the highlight, scrolling, and
+// entering or leaving a submenu make no wasm calls once each menu's state has been read.
+const TREE = 512;
+const STATE = 1536;
+const treeItems = [
+  { parent: 0xffff, type: 4, flags: 4, count: 3, label: "Drive mode" },
+  { parent: 0xffff, type: 2, flags: 6, label: "Max speed", min: 0, max: 100, step: 5 },
+  { parent: 0xffff, type: 1, flags: 1, label: "Sensors", title: "Sensor Bay" },
+  { parent: 2, type: 5, flags: 4, label: "IMU" },
+  { parent: 0xffff, type: 0, flags: 0, label: "Calibrate" },
+  { parent: 0xffff, type: 0, flags: 0, label: "E-STOP" }
+];
+const values = [1, 40, 0, 7, 0, 0];
+const choiceText = ["Eco", "Normal", "Sport"];
+let treeCalls = 0;
+let commits = 0;
+
+function writeTree() {
+  const view = new DataView(memory.buffer, TREE);
+  const bytes = new Uint8Array(memory.buffer);
+  let strings = 16 + treeItems.length * 24;
+  const string = (text) => {
+    if (!text) return 0;
+    const offset = strings;
+    bytes.set(new TextEncoder().encode(`${text}\0`), TREE + offset);
+    strings += text.length + 1;
+    return offset;
+  };
+  view.setUint16(0, 1, true);
+  view.setUint16(2, 16, true);
+  view.setUint16(4, 24, true);
+  view.setUint16(6, treeItems.length, true);
+  view.setUint16(8, string("Rover"), true);
+  view.setUint8(10, 2);
+  treeItems.forEach((item, id) => {
+    const record = 16 + id * 24;
+    view.setUint16(record, item.parent, true);
+    view.setUint8(record + 2, item.type);
+    view.setUint8(record + 3, item.flags);
+    view.setUint8(record + 4, item.count || 0);
+    view.setUint16(record + 6, string(item.label), true);
+    view.setInt32(record + 8, item.min || 0, true);
+    view.setInt32(record + 12, item.max || 0, true);
+    view.setInt32(record + 16, item.step || 0, true);
+    view.setUint16(record + 20, string(item.title), true);
+  });
+}
+
+const treeExports = {
+  memory,
+  bm_init: writeTree,
+  bm_tree_table: () => TREE,
+  bm_menu_state(menu) {
+    const view = new DataView(memory.buffer, STATE);
+    const ids = treeItems.map((item, id) => (item.parent === menu ? id : -1)).filter((id) => id >= 0);
+    view.setUint16(0, 1, true);
+    view.setUint16(2, 104, true);
+    view.setUint16(4, ids.length, true);
+    ids.forEach((id, i) => {
+      const record = 8 + i * 104;
+      view.setUint16(record, id, true);
+      view.setUint8(record + 2, id === 4 ? 2 : 0);
+      view.setInt32(record + 4, values[id], true);
+      const text = treeItems[id].flags & 4 ? (id === 0 ? choiceText[values[id]] : String(values[id])) : "";
+      new Uint8Array(memory.buffer).set(new TextEncoder().encode(`${text}\0`), STATE + record + 8);
+    });
+    return STATE;
+  },
+  bm_item_set: (id, value) => ((values[id] = value), 0),
+  bm_item_edit: (id, value) => ((values[id] = value), 1),
+  bm_item_commit: () => ((commits += 1), 1),
+  bm_item_activate: () => 1,
+  bm_armed: () => 0,
+  bm_battery_percent: () => 80
+};
+const countingExports = new Proxy(treeExports, {
+  get(target, key) {
+    const value = target[key];
+    if (typeof value !== "function") return value;
+    return (...args) => {
+      treeCalls += 1;
+      return value(...args);
+    };
+  }
+});
+WebAssembly.instantiateStreaming = async () => ({ instance: { exports: countingExports } });
+
+const local = await import("../docs/web-adapter/web_menu_dom_adapter.js?local");
+local.initWebMenuDomAdapter({ content: {}, icons: {} });
+await new Promise((resolve) => setTimeout(resolve, 0));
+runFrames();
+assert.deepEqual(rowLabels(), ["Drive mode", "Max speed"]);
+assert.equal(menu.children[1].children[2].textContent, "Normal");
+
+treeCalls = 0;
+press("ArrowDown");
+press("ArrowDown");
+runFrames();
+assert.deepEqual(rowLabels(), ["Max speed", "Sensors"]);
+press("Enter");
+runFrames();
+assert.deepEqual(rowLabels(), ["IMU"]);
+assert.equal(menu.children[0].textContent.includes("Sensor Bay"), true);
+const entered = treeCalls;
+press("Escape");
+press("ArrowDown");
+press("ArrowDown");
+runFrames();
+assert.deepEqual(rowLabels(), ["Calibrate", "E-STOP"]);
+assert.equal(treeCalls - entered, 0, "navigation made wasm calls");
+assert.equal(menu.children[2].classList.contains("selected"), true, "disabled rows are skipped");
+
+// Edits and choice cycling are the only calls that cross into wasm.
+press("ArrowUp");
+press("ArrowUp");
+press("Enter");
+press("ArrowUp");
+press("Enter");
+runFrames();
+assert.equal(values[1], 45);
+assert.equal(commits, 1);
+press("ArrowUp");
+press("Enter");
+runFrames();
+assert.equal(values[0], 2);
+assert.equal(menu.children[1].children[2].textContent, "Sport");
+
+// An empty tree table, which modules built from older sources export for an oversized
+// tree, is ignored and input keeps going to the runtime by rows.
+const EMPTY_TREE = 3072;
+let stateReads = 0;
+const emptyTreeExports = {
+  ...exports,
+  bm_init() {
+    const view = new DataView(memory.buffer, EMPTY_TREE);
+    view.setUint16(0, 1, true);
+    view.setUint16(2, 16, true);
+    view.setUint16(4, 24, true);
+    view.setUint16(6, 0, true);
+    writeTable();
+  },
+  bm_tree_table: () => EMPTY_TREE,
+  bm_menu_state: () => ((stateReads += 1), 0)
+};
+WebAssembly.instantiateStreaming = async () => ({ instance: { exports: emptyTreeExports } });
+const fallback = await import("../docs/web-adapter/web_menu_dom_adapter.js?empty-tree");
+fallback.initWebMenuDomAdapter({ content: {}, icons: {} });
+await new Promise((resolve) => setTimeout(resolve, 0));
+runFrames();
+assert.deepEqual(rowLabels(), labels.slice(top, top + 5));
+assert.equal(stateReads, 0);